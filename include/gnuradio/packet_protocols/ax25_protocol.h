@@ -23,6 +23,41 @@ extern "C" {
 #define AX25_MAX_ADDRS 9  // Maximum addresses
 #define AX25_MAX_INFO 2048 // Maximum information field length (AX.25 v2.2)
 
+// Sequence numbering
+#define AX25_MODULO 8                 // SABM links: 3-bit N(S)/N(R)
+#define AX25_MODULO_EXTENDED 128      // SABME links: 7-bit N(S)/N(R), two-byte control
+#define AX25_WINDOW_MAX 7             // Largest window (k) on a modulo-8 link
+#define AX25_WINDOW_MAX_EXTENDED 127  // Largest window (k) on a modulo-128 link
+#define AX25_CTRL_PF 0x10             // Poll/Final bit of a one-byte control field
+
+// TX queue
+#define AX25_MAX_FRAME_BYTES (AX25_MAX_ADDRS * AX25_ADDR_LEN + 4 + AX25_MAX_INFO + 2)
+#define AX25_TX_CONTROL_BYTES 2048 // Ring for S and U frames (drained first)
+#define AX25_TX_DATA_BYTES 16384   // Ring for I and UI frames
+
+// Connection table
+#define AX25_DEFAULT_MAX_CONNECTIONS 256 // Default for config.max_connections
+#define AX25_MAX_CONNECTIONS 16384       // Largest table the 16-bit index supports
+#define AX25_NO_CONNECTION 0xFFFF        // Empty hash slot / end of the free list
+
+// Timers: T1, T2 and T3 of every connection share one hierarchical timing wheel
+#define AX25_TIMER_T1 0       // Acknowledgement: resend or poll, give up after N2 tries
+#define AX25_TIMER_T2 1       // Response delay: acknowledge received I-frames
+#define AX25_TIMER_T3 2       // Inactive link: poll the peer of an idle link
+#define AX25_TIMER_REASSEMBLY 3 // Segmented message: discard it if no segment follows
+#define AX25_TIMER_COUNT 4    // Timers per connection
+#define AX25_WHEEL_LEVELS 4   // Slot widths 1, 64, 4096 and 262144 ms
+#define AX25_WHEEL_SLOTS 64   // Slots per level
+#define AX25_NO_TIMER 0xFFFFFFFF // End of a slot list
+
+// Segmentation: a message longer than N1 is carried by up to 128 I-frames with PID 0x08.
+// The first octet of each I-field is a header; the first segment also repeats the PID.
+#define AX25_SEGMENT_FIRST 0x80     // Header: first segment of a message
+#define AX25_SEGMENT_REMAINING 0x7F // Header: segments that follow this one
+#define AX25_MAX_SEGMENTS 128       // Segments per message
+#define AX25_MAX_MESSAGE (AX25_MAX_SEGMENTS * (AX25_MAX_INFO - 1) - 1) // Longest message
+#define AX25_REASSEMBLY_SLOTS 8     // Messages a TNC reassembles or holds at once
+
 // AX.25 Frame Types
 #define AX25_FRAME_I 0x00 // Information frame
 #define AX25_FRAME_S 0x01 // Supervisory frame
@@ -45,6 +80,7 @@ extern "C" {
 #define AX25_CTRL_XID_PF 0xBF // eXchange IDentification (P/F=1)
 
 // AX.25 PID Types
+#define AX25_PID_SEGMENT 0x08 // Segment of a longer message
 #define AX25_PID_NONE 0xF0   // No layer 3 protocol
 #define AX25_PID_IP 0xCC     // Internet Protocol
 #define AX25_PID_ARP 0xCD    // Address Resolution Protocol
@@ -64,13 +100,28 @@ typedef struct {
     ax25_address_t addresses[AX25_MAX_ADDRS]; // Address fields
     uint8_t num_addresses;                    // Number of addresses
     uint8_t control;                          // Control field
+    uint8_t control_ext;                      // Second control byte (modulo-128 I/S)
+    bool extended;                            // control_ext is present
     uint8_t pid;                              // Protocol ID
-    uint8_t info[AX25_MAX_INFO];              // Information field
+    uint8_t info[AX25_MAX_INFO + 1];          // Information field (+ modulo-128 PID)
     uint16_t info_length;                     // Information length
     uint16_t fcs;                             // Frame Check Sequence
     bool valid;                               // Frame validity
 } ax25_frame_t;
 
+// Received frame parsed in place: addresses and info point into the caller's buffer,
+// which must outlive the view. Nothing is copied, so a digipeater or monitor can inspect
+// every frame on the channel at the cost of reading its header.
+typedef struct {
+    const uint8_t* addresses; // num_addresses encoded 7-byte address fields
+    uint8_t num_addresses;    // 2 to AX25_MAX_ADDRS, the last one with the E bit set
+    uint8_t control;          // Control field (first byte)
+    uint8_t pid;              // Protocol ID (0 when the frame has none)
+    const uint8_t* info;      // Information field (NULL when empty)
+    uint16_t info_length;     // Information length
+    uint16_t fcs;             // Frame Check Sequence as received (not verified)
+} ax25_frame_view_t;
+
 // AX.25 Connection State
 typedef enum {
     AX25_STATE_DISCONNECTED,
@@ -79,34 +130,99 @@ typedef enum {
     AX25_STATE_DISCONNECTING
 } ax25_state_t;
 
+// I-frame buffer entry: a sent payload kept until acknowledged, or a payload received
+// out of sequence kept until the frames before it arrive
+typedef struct {
+    uint8_t* data;   // Heap copy of the information field (NULL when free)
+    uint16_t length; // Information field length
+    uint8_t pid;     // Protocol ID of the frame
+    uint8_t transmissions; // Times a buffered I-frame has been sent
+} ax25_slot_t;
+
+// Message being reassembled from segments; a TNC keeps AX25_REASSEMBLY_SLOTS of them
+typedef struct {
+    uint8_t* data;       // Heap buffer of the message so far (kept for reuse)
+    uint32_t length;     // Octets collected
+    uint32_t capacity;   // Octets allocated
+    uint8_t remaining;   // Segments still expected
+    uint8_t pid;         // PID carried by the first segment
+    bool active;         // A first segment has been received
+    bool complete;       // The last segment has been received; data holds the message
+    uint16_t connection; // Connection entry in a TNC pool (AX25_NO_CONNECTION: free)
+} ax25_reassembly_t;
+
+// Timer of a connection; its id is connection entry * AX25_TIMER_COUNT + timer
+typedef struct {
+    uint64_t expires; // Clock time it fires at (ms)
+    uint32_t next;    // Next timer in the same wheel slot
+    uint32_t prev;    // Previous timer in the slot (AX25_NO_TIMER at the head)
+    uint8_t level;    // Wheel level and slot it is linked into
+    uint8_t slot;
+    bool armed;
+} ax25_timer_t;
+
 // AX.25 Connection
 typedef struct {
     ax25_address_t local_addr;
     ax25_address_t remote_addr;
     ax25_state_t state;
-    uint8_t send_seq;     // Send sequence number
-    uint8_t recv_seq;     // Receive sequence number
-    uint8_t window_size;  // Window size
-    uint32_t timeout;     // Connection timeout
+    uint8_t send_seq;     // V(S): N(S) of the next I-frame to transmit
+    uint8_t recv_seq;     // V(R): N(S) expected in the next I-frame received
+    uint8_t ack_seq;      // V(A): oldest unacknowledged N(S)
+    uint8_t queue_seq;    // N(S) the next ax25_send_data() payload is buffered under
+    uint8_t window_size;  // Window size (k): most I-frames buffered or unacknowledged
+    uint16_t max_info;    // N1: largest I-field the peer accepts (octets)
+    uint8_t max_retries;  // N2: T1 expiries before the link is dropped
+    uint32_t t1_initial;  // T1 (ms) until a round trip has been measured
+    uint32_t timeout;     // T1 duration (ms) the timer was last armed with
     uint32_t retry_count; // Retry counter
     bool extended_mode;   // true for modulo 128 (SABME), false for modulo 8 (SABM)
+    bool peer_busy;       // RNR received; I-frames are held until RR or REJ
+    bool reject_sent;     // REJ sent for the current sequence gap
+    bool poll_pending;    // Next I-frame carries P=1 (after T1 expiry)
+    bool t1_running;      // Frames (or SABM) outstanding; T1 expiry retransmits
+    bool srej_enabled;    // Selective reject in use on this link
+    bool xid_pending;     // XID command sent after UA, response awaited
+    bool rtt_valid;       // srtt holds a measurement
+    bool rtt_timing;      // I-frame rtt_seq is being timed
+    uint8_t rtt_seq;      // N(S) of the timed frame
+    uint8_t backoff;      // T1 doublings since the last valid measurement (Karn)
+    uint8_t ack_pending;  // I-frames accepted since N(R) was last sent
+    uint32_t srtt;        // Smoothed round-trip time (ms) excluding the frame's airtime
+    uint32_t rttvar;      // Round-trip time variation (ms)
+    uint64_t rtt_start;   // Clock time the timed frame was queued
+    uint64_t srej_requested[2]; // N(S) values we sent SREJ for (bit per sequence number)
+    uint64_t srej_resend[2];    // N(S) values the peer SREJed, resent before new frames
+    ax25_slot_t* tx_slots; // Retransmit buffer indexed by N(S); NULL until first send
+    uint8_t* tx_message;       // ax25_send_message() copy with segments left; else NULL
+    uint32_t tx_message_length;
+    uint16_t tx_segment_info;  // N1 the message is segmented with
+    uint8_t tx_segment;        // Next segment to buffer once the window has room
+    uint8_t tx_segments;       // Segments in the message
+    ax25_slot_t* rx_slots; // Out-of-sequence frames indexed by N(S); NULL until needed
+    ax25_timer_t timers[AX25_TIMER_COUNT]; // T1, T2, T3, reassembly
+    uint32_t hash;         // Hash of (local_addr, remote_addr), the table key
+    uint16_t next_free;    // Free-list link while the entry is unused
 } ax25_connection_t;
 
-// AX.25 XID Format Identifiers (v2.2)
+// AX.25 XID Format Identifiers (v2.2): the information field is FI, GI, a two-octet
+// group length (GL) and the parameters as PI, PL and a big-endian value
 #define AX25_XID_FMT_BASIC 0x81      // Basic format identifier
-#define AX25_XID_FMT_EXTENDED 0x82   // Extended format identifier
+#define AX25_XID_FMT_EXTENDED 0x82   // General purpose format identifier (AX.25 v2.2)
 
 // AX.25 XID Group Identifiers
 #define AX25_XID_GROUP_DEFAULT 0x00   // Default group
-#define AX25_XID_GROUP_LINK 0x01      // Link layer parameters
+#define AX25_XID_GROUP_PARAMS 0x80    // Parameter negotiation (AX.25 v2.2)
 
-// AX.25 XID Parameter Types
-#define AX25_XID_PARAM_WINDOW_SIZE 0x01    // Window size parameter
-#define AX25_XID_PARAM_MAX_FRAME 0x02      // Maximum frame size parameter
-#define AX25_XID_PARAM_RETRY_COUNT 0x03    // Retry count parameter
-#define AX25_XID_PARAM_T1_TIMEOUT 0x04      // T1 timeout parameter
-#define AX25_XID_PARAM_T2_TIMEOUT 0x05     // T2 timeout parameter
-#define AX25_XID_PARAM_T3_TIMEOUT 0x06     // T3 timeout parameter
+// AX.25 XID Parameter Identifiers (v2.2)
+#define AX25_XID_PARAM_CLASSES 0x02        // Classes of procedures
+#define AX25_XID_PARAM_HDLC_OPTIONS 0x03   // HDLC optional functions
+#define AX25_XID_PARAM_IFIELD_TX 0x05      // I-field length transmit (bits)
+#define AX25_XID_PARAM_IFIELD_RX 0x06      // I-field length receive (bits)
+#define AX25_XID_PARAM_WINDOW_TX 0x07      // Window size transmit
+#define AX25_XID_PARAM_WINDOW_RX 0x08      // Window size receive
+#define AX25_XID_PARAM_T1_TIMEOUT 0x09     // Acknowledge timer T1 (ms)
+#define AX25_XID_PARAM_RETRY_COUNT 0x0A    // Retries N2
 
 // AX.25 XID Parameter Structure
 typedef struct {
@@ -132,22 +248,63 @@ typedef struct {
     uint16_t slot_time;        // Slot time (10ms units)
     uint8_t tx_tail;           // TX tail (10ms units)
     bool full_duplex;          // Full duplex mode
-    uint8_t max_frame_length;  // Maximum frame length
-    uint8_t window_size;       // Window size
-    uint32_t t1_timeout;       // T1 timeout (ms)
+    uint16_t max_frame_length; // Largest I-field accepted (octets, at most AX25_MAX_INFO)
+    uint8_t window_size;       // Window size (k) offered; clamped to the link's modulus
+    uint32_t t1_timeout;       // T1 (ms) until a round trip has been measured
+    uint32_t t1_min;           // Lower bound of the adaptive T1 (ms)
+    uint32_t t1_max;           // Upper bound of the adaptive T1 (ms)
+    uint32_t bit_rate;         // Modem bit rate for the airtime in T1 (0: no airtime)
     uint32_t t2_timeout;       // T2 timeout (ms)
     uint32_t t3_timeout;       // T3 timeout (ms)
     uint8_t max_retries;       // Maximum retries
+    bool selective_reject;     // Use SREJ instead of REJ on v2.2 (SABME) links
+    bool xid_negotiation;      // Exchange XID after SABME/UA to agree on k, N1, T1, N2
+    uint16_t max_connections;  // Connection table limit (at most AX25_MAX_CONNECTIONS)
+    uint32_t reassembly_timeout; // Partial message dropped this long after a segment
+                                 // (ms); 0: kept until the link is released
 } ax25_config_t;
 
+// Ring of encoded frames, each stored as a 2-byte little-endian length and the frame
+typedef struct {
+    uint16_t head;    // Offset of the oldest entry
+    uint16_t used;    // Bytes in use, length prefixes included
+    uint16_t frames;  // Entries queued
+    uint32_t dropped; // Frames refused because the ring was full
+} ax25_tx_ring_t;
+
+// Timing wheel: level L slot s holds the timers due when the wheel reaches s at 64^L ms
+// resolution; reaching a slot above level 0 moves its timers down a level
+typedef struct {
+    uint64_t now;  // Time of the last ax25_tick()
+    uint64_t time; // Next millisecond the wheel has not processed
+    uint32_t slots[AX25_WHEEL_LEVELS][AX25_WHEEL_SLOTS]; // First timer id of each slot
+    uint64_t occupied[AX25_WHEEL_LEVELS];                // Bit per non-empty slot
+    uint32_t armed;                                      // Timers in the wheel
+} ax25_timer_wheel_t;
+
+// Monotonic clock in milliseconds
+typedef uint64_t (*ax25_clock_t)(void* context);
+
 // AX.25 TNC Interface
 typedef struct {
     ax25_config_t config;
-    ax25_connection_t connections[16]; // Multiple connections
-    uint8_t num_connections;
+    ax25_connection_t* connections;    // Table grown on demand up to max_connections
+    uint16_t connection_capacity;      // Entries allocated in connections
+    uint16_t num_connections;          // Entries in use
+    uint16_t free_connection;          // Head of the free list of unused entries
+    uint16_t* connection_index;        // Open-addressing hash of keys to entries
+    uint16_t index_size;               // Slots in connection_index (a power of two)
+    uint16_t service_index;            // Next connection ax25_transmit_pending() visits
     ax25_frame_t rx_frame;
-    ax25_frame_t tx_frame;
-    bool frame_ready;
+    bool frame_ready;                  // rx_frame holds a frame not yet consumed
+    uint8_t tx_control[AX25_TX_CONTROL_BYTES]; // Storage of tx_control_ring
+    uint8_t tx_data[AX25_TX_DATA_BYTES];       // Storage of tx_data_ring
+    ax25_tx_ring_t tx_control_ring;
+    ax25_tx_ring_t tx_data_ring;
+    ax25_timer_wheel_t timers;
+    ax25_reassembly_t reassembly[AX25_REASSEMBLY_SLOTS]; // Segmented messages received
+    ax25_clock_t clock;   // Time timers are armed from; NULL: the last ax25_tick() time
+    void* clock_context;
 } ax25_tnc_t;
 
 // AX.25 Protocol Functions
@@ -168,6 +325,19 @@ int ax25_parse_frame(const uint8_t* data, uint16_t length, ax25_frame_t* frame);
 int ax25_encode_frame(const ax25_frame_t* frame, uint8_t* data, uint16_t* length);
 int ax25_validate_frame(const ax25_frame_t* frame);
 
+// Frame views: ax25_parse_frame_view() checks the address E-bit chain and that control,
+// PID and FCS fit in length without copying anything; ax25_parse_frame() is the same
+// parse copied into an ax25_frame_t. Address index 0 is the destination, 1 the source
+// and 2 onwards the digipeaters. The parse cannot know a link's modulus: on a modulo-128
+// link the second control byte is read as the PID and the PID starts the information
+// field, which may therefore be one byte longer than AX25_MAX_INFO.
+int ax25_parse_frame_view(const uint8_t* data, uint16_t length, ax25_frame_view_t* view);
+int ax25_view_address(const ax25_frame_view_t* view, uint8_t index, ax25_address_t* addr);
+int ax25_view_address_equal(const ax25_frame_view_t* view, uint8_t index,
+                            const ax25_address_t* addr); // 1: same station
+int ax25_view_next_digipeater(const ax25_frame_view_t* view); // H clear, -1: none
+int ax25_frame_from_view(const ax25_frame_view_t* view, ax25_frame_t* frame);
+
 // Connection Functions
 int ax25_connect(ax25_tnc_t* tnc, const ax25_address_t* remote_addr);
 int ax25_connect_extended(ax25_tnc_t* tnc, const ax25_address_t* remote_addr, bool use_extended);
@@ -180,6 +350,78 @@ int ax25_process_frame(ax25_tnc_t* tnc, const ax25_frame_t* frame);
 int ax25_send_supervisory(ax25_tnc_t* tnc, const ax25_address_t* remote_addr, uint8_t ctrl_type);
 int ax25_send_frmr(ax25_tnc_t* tnc, const ax25_address_t* remote_addr, uint8_t reason);
 
+// TX queue: every frame the TNC sends is encoded (with FCS, without flags) into a ring.
+// S and U frames are dequeued before I and UI frames. ax25_tx_drain() packs up to
+// max_frames back to back into buffer for one transmit opportunity and returns the count.
+int ax25_tx_dequeue(ax25_tnc_t* tnc, uint8_t* data, uint16_t* length);
+int ax25_tx_drain(ax25_tnc_t* tnc, uint8_t* buffer, uint32_t size, uint16_t* lengths,
+                  int max_frames);
+int ax25_tx_queued(const ax25_tnc_t* tnc);
+
+// Sliding window: ax25_send_data() buffers the payload in the connection's retransmit
+// buffer and fails once window_size frames are unacknowledged. I-frames that do not fit
+// in the TX queue wait there; dequeuing refills the queue, visiting connections in turn.
+int ax25_transmit_pending(ax25_tnc_t* tnc); // Number of I-frames moved to the TX queue
+int ax25_window_space(ax25_tnc_t* tnc, const ax25_address_t* remote_addr);
+int ax25_t1_expired(ax25_tnc_t* tnc, const ax25_address_t* remote_addr); // 1: link lost
+
+// Adaptive T1: each link times one never-retransmitted I-frame at a time (Karn) and keeps
+// SRTT/RTTVAR of the round trip without that frame's airtime. T1 is SRTT + 4 * RTTVAR
+// (t1_timeout before the first sample) plus the airtime of the unacknowledged frames at
+// bit_rate, doubled on every expiry until the next sample, within [t1_min, t1_max].
+int ax25_t1_duration(ax25_tnc_t* tnc, const ax25_address_t* remote_addr); // ms, -1: none
+
+// Timers: ax25_tick() fires every T1 (retransmit, or poll and give up after N2 tries), T2
+// (acknowledge received I-frames) and T3 (poll an idle link, 0 disables) due by now, in
+// time proportional to the timers that fire. Returns their number. Pass the same clock
+// to ax25_set_clock() so timers armed between ticks start from the current time.
+int ax25_set_clock(ax25_tnc_t* tnc, ax25_clock_t clock, void* context);
+int ax25_tick(ax25_tnc_t* tnc, uint64_t now);
+
+// Delayed acknowledgement: accepted I-frames are acknowledged when T2 expires or half the
+// window is waiting, whichever comes first, by the next I-frame to the peer if one can go
+// and by one RR otherwise. Any I or S frame sent in between carries N(R) and cancels it;
+// an I-frame with P set is answered at once.
+
+// Selective reject: frames received beyond a gap are buffered and only the missing ones
+// are requested. Once ax25_receive_data() fills a gap, the frames buffered behind it are
+// returned by ax25_receive_pending() (-1 when none is ready).
+int ax25_receive_pending(ax25_tnc_t* tnc, ax25_address_t* remote_addr, uint8_t* data,
+                         uint16_t* length);
+
+// XID negotiation: once UA answers its SABME, the connecting station sends an XID command
+// with its receive window (PI 8), largest receive I-field in bits (PI 6), T1 (PI 9) and
+// N2 (PI 10). The peer applies the smaller window and I-field and the larger T1 and N2
+// to the link and returns them in the XID response, which the connecting station
+// applies in turn. SABM (v2.0) links, a disabled xid_negotiation, a lost exchange and
+// a peer that answers FRMR keep the configured values.
+int ax25_max_info(ax25_tnc_t* tnc, const ax25_address_t* remote_addr); // N1, -1: no link
+
+// Segmentation: ax25_send_message() sends a message longer than the link's N1 as I-frames
+// with PID AX25_PID_SEGMENT, each as full as N1 allows. Segments beyond the window wait
+// in the connection and enter the retransmit buffer as N(R) opens it; until the last one
+// has, the link takes no other message or ax25_send_data() payload and
+// ax25_window_space() is 0. Received segments are collected in a pool slot:
+// ax25_receive_data() returns 0 with *length 0 for each, and the whole message comes from
+// ax25_receive_message(). A partial message is dropped when reassembly_timeout passes
+// without a segment or another frame arrives before its next segment; a released link
+// drops its messages. Without a free slot a message is not received.
+int ax25_send_message(ax25_tnc_t* tnc, const ax25_address_t* remote_addr,
+                      const uint8_t* data, uint32_t length);
+int ax25_receive_message(ax25_tnc_t* tnc, ax25_address_t* remote_addr, uint8_t* data,
+                         uint32_t* length);
+
+// Segmenter and reassembler without a TNC. ax25_segment() builds the I-field of segment
+// index of count (header, PID in the first, then data). ax25_reassembly_add() returns 1
+// once the message is complete, 0 while segments are missing and -1 when the segment
+// does not continue the message, which is then discarded.
+int ax25_segment_count(uint32_t length, uint16_t max_info); // -1: over AX25_MAX_SEGMENTS
+int ax25_segment(const uint8_t* data, uint32_t length, uint8_t pid, uint16_t max_info,
+                 int index, uint8_t* info, uint16_t* info_length);
+int ax25_reassembly_add(ax25_reassembly_t* reassembly, const uint8_t* info,
+                        uint16_t length);
+void ax25_reassembly_reset(ax25_reassembly_t* reassembly); // Frees the buffer
+
 // UI Frame Functions (for APRS)
 int ax25_send_ui_frame(ax25_tnc_t* tnc, const ax25_address_t* src, const ax25_address_t* dst,
                        const ax25_address_t* digipeaters, uint8_t num_digipeaters, uint8_t pid,
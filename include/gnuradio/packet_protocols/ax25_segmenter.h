@@ -0,0 +1,71 @@
+/*
+ * Copyright 2024 gr-packet-protocols
+ *
+ * This file is part of gr-packet-protocols
+ *
+ * gr-packet-protocols is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-packet-protocols is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-packet-protocols; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_PACKET_PROTOCOLS_AX25_SEGMENTER_H
+#define INCLUDED_PACKET_PROTOCOLS_AX25_SEGMENTER_H
+
+#include <gnuradio/packet_protocols/api.h>
+#include <gnuradio/block.h>
+#include <cstdint>
+
+namespace gr {
+namespace packet_protocols {
+
+/*!
+ * \brief AX.25 segmenter and reassembler for PDUs longer than N1
+ * \ingroup packet_protocols
+ *
+ * A PDU on "pdus_in" longer than max_info is split into the information fields of
+ * segment I-frames (AX.25 2.2 section 6.6), each published on "segments_out" with meta
+ * "pid" set to 0x08; shorter PDUs pass through unchanged. PDUs on "segments_in" whose
+ * meta "pid" is 0x08 are collected per meta "src" and the reassembled message is
+ * published on "pdus_out" with "pid" set to the PID the first segment carried; other
+ * PDUs pass through. At most max_messages messages are collected at once, and one is
+ * dropped when timeout_ms passes between its segments, also while no segments arrive.
+ */
+class PACKET_PROTOCOLS_API ax25_segmenter : virtual public gr::block {
+  public:
+    typedef std::shared_ptr<ax25_segmenter> sptr;
+
+    /*!
+     * \brief Return a shared_ptr to a new instance of packet_protocols::ax25_segmenter.
+     *
+     * \param max_info N1: longest information field of a segment (3 to 2048 octets)
+     * \param max_messages Messages reassembled at the same time
+     * \param timeout_ms Longest gap between segments of a message; 0 waits forever
+     */
+    static sptr make(int max_info = 256, int max_messages = 8, int timeout_ms = 60000);
+
+    /*!
+     * \brief Messages published on "pdus_out" after reassembly
+     */
+    virtual uint64_t messages_reassembled() const = 0;
+
+    /*!
+     * \brief Partial messages dropped (out-of-order segment, timeout or no free slot)
+     */
+    virtual uint64_t messages_dropped() const = 0;
+};
+
+} // namespace packet_protocols
+} // namespace gr
+
+#endif /* INCLUDED_PACKET_PROTOCOLS_AX25_SEGMENTER_H */
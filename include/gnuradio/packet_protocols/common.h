@@ -165,6 +165,7 @@ class ReedSolomonEncoder {
     int d_n;  // Code length (255)
     int d_k;  // Data length
     int d_t;  // Error correction capability = (n-k)/2
+    unsigned d_fcr; // First consecutive root of the generator (log form)
     GaloisField256 d_gf;
     std::vector<uint8_t> d_generator_poly;
     /** init_rs / encode_rs: generator coefficients in index form (log), A0=255 for zero poly coeff */
@@ -172,7 +173,7 @@ class ReedSolomonEncoder {
 
     void build_generator_poly() {
         /* Same recurrence as Phil Karn init_rs.c (genpoly), roots alpha^{FCR*PRIM + i*PRIM}. */
-        const unsigned FCR = 1;
+        const unsigned FCR = d_fcr;
         const unsigned PRIM = 1;
         const int nroots = 2 * d_t;
 
@@ -205,7 +206,9 @@ class ReedSolomonEncoder {
     }
 
   public:
-    ReedSolomonEncoder(int n, int k) : d_n(n), d_k(k), d_t((n - k) / 2) {
+    //! fcr: first consecutive root, 1 for FX.25 and 0 for IL2P
+    ReedSolomonEncoder(int n, int k, unsigned fcr = 1)
+        : d_n(n), d_k(k), d_t((n - k) / 2), d_fcr(fcr) {
         if (n != 255) {
             // Only support RS(255,k) codes
             d_n = 255;
@@ -277,6 +280,7 @@ class ReedSolomonDecoder {
     int d_n;  // Code length (255)
     int d_k;  // Data length
     int d_t;  // Error correction capability = (n-k)/2
+    unsigned d_fcr; // First consecutive root of the generator (log form)
     GaloisField256 d_gf;
 
     // Calculate syndromes
@@ -284,13 +288,13 @@ class ReedSolomonDecoder {
         syndromes.resize(2 * d_t);
         bool has_errors = false;
         
-        // Syndrome S_i = R(alpha^(i+1)) for i = 0 to 2t-1
+        // Syndrome S_i = R(alpha^(fcr+i)) for i = 0 to 2t-1
         // where R(x) is the received polynomial
         for (int i = 0; i < 2 * d_t; i++) {
-            uint8_t alpha_power = d_gf.power(2, i + 1); // alpha^(i+1)
+            uint8_t alpha_power = d_gf.power(2, static_cast<int>(d_fcr) + i);
             syndromes[i] = 0;
             
-            // Evaluate at alpha^(i+1); coefficient order matches decode_rs Horner (byte j -> x^{n-1-j})
+            // Evaluate at alpha^(fcr+i); coefficient order matches decode_rs Horner (byte j -> x^{n-1-j})
             for (int j = 0; j < d_n && j < (int)received.size(); j++) {
                 if (received[j] != 0) {
                     const int deg = d_n - 1 - j;
@@ -308,13 +312,13 @@ class ReedSolomonDecoder {
         return has_errors;
     }
 
-    /** Phil Karn decode_rs.h (gr-fec): NN=255, PAD=0, FCR=1, PRIM=1, IPRIM=1, no erasures. */
+    /** Phil Karn decode_rs.h (gr-fec): NN=255, PAD=0, PRIM=1, IPRIM=1, no erasures. */
     bool decode_rs_inplace(std::vector<uint8_t>& data)
     {
         const unsigned NROOTS = static_cast<unsigned>(2 * d_t);
         const unsigned NN = static_cast<unsigned>(d_n);
         const unsigned A0 = NN;
-        const unsigned FCR = 1;
+        const unsigned FCR = d_fcr;
         const unsigned PRIM = 1;
         const unsigned IPRIM = 1;
         const int no_eras = 0;
@@ -467,7 +471,8 @@ class ReedSolomonDecoder {
                 }
             }
             uint8_t num2 =
-                d_gf.gf_alpha_to(GaloisField256::gf_modnn(root[(unsigned)j] * (FCR - 1u) + NN));
+                d_gf.gf_alpha_to(GaloisField256::gf_modnn(root[(unsigned)j] * FCR + NN -
+                                                          root[(unsigned)j]));
             uint8_t den = 0;
             unsigned lim = std::min(static_cast<unsigned>(deg_lambda), NROOTS - 1u) & ~1u;
             for (i = static_cast<int>(lim); i >= 0; i -= 2) {
@@ -493,8 +498,10 @@ class ReedSolomonDecoder {
     }
 
   public:
-    ReedSolomonDecoder(int n, int k)
-        : d_n(n != 255 ? 255 : n), d_k(k), d_t(((n != 255 ? 255 : n) - k) / 2) {}
+    //! fcr: first consecutive root, 1 for FX.25 and 0 for IL2P
+    ReedSolomonDecoder(int n, int k, unsigned fcr = 1)
+        : d_n(n != 255 ? 255 : n), d_k(k), d_t(((n != 255 ? 255 : n) - k) / 2),
+          d_fcr(fcr) {}
 
     ~ReedSolomonDecoder() = default;
 
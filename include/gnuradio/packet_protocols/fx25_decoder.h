@@ -40,6 +40,23 @@ class PACKET_PROTOCOLS_API fx25_decoder : virtual public gr::block {
      * \brief Return a shared_ptr to a new instance of packet_protocols::fx25_decoder.
      */
     static sptr make();
+
+    /*!
+     * \brief Number of HDLC flags, each at most 16 bits after the previous one, that
+     *        assert DCD (default 4)
+     */
+    virtual void set_dcd_flags(int flags) = 0;
+
+    /*!
+     * \brief Bits a suspected loss of signal must persist before DCD drops (default 64)
+     *
+     * The hold-off starts at the first run of seven ones and is cancelled by a flag or
+     * by valid bit stuffing; see the "dcd" message port and the optional second output.
+     */
+    virtual void set_dcd_hold_off(int bits) = 0;
+
+    //! Current data carrier detect state
+    virtual bool dcd() const = 0;
 };
 
 } // namespace packet_protocols
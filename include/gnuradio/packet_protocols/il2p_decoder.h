@@ -38,8 +38,23 @@ class PACKET_PROTOCOLS_API il2p_decoder : virtual public gr::block {
 
     /*!
      * \brief Return a shared_ptr to a new instance of packet_protocols::il2p_decoder.
+     *
+     * \param check_crc Expect the IL2P+CRC trailer (il2p_encoder's add_checksum) after
+     *        every frame and drop frames whose rebuilt AX.25 frame does not match it
      */
-    static sptr make();
+    static sptr make(bool check_crc = true);
+
+    //! Expect and check the IL2P+CRC trailer from the next frame on
+    virtual void set_check_crc(bool check_crc) = 0;
+
+    /*!
+     * \brief Bits after the end of a frame (or a failed header) before DCD drops,
+     *        unless another sync word arrives first (default 64)
+     */
+    virtual void set_dcd_hold_off(int bits) = 0;
+
+    //! Current data carrier detect state
+    virtual bool dcd() const = 0;
 };
 
 } // namespace packet_protocols
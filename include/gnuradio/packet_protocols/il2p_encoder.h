@@ -32,6 +32,9 @@ namespace packet_protocols {
 /*!
  * \brief IL2P (Improved Layer 2 Protocol) Encoder
  * \ingroup packet_protocols
+ *
+ * The input byte stream carries AX.25 frames (without FCS) as KISS data frames; each
+ * becomes one IL2P frame whose header is translated from the AX.25 header.
  */
 class PACKET_PROTOCOLS_API il2p_encoder : virtual public gr::block {
   public:
@@ -39,6 +42,11 @@ class PACKET_PROTOCOLS_API il2p_encoder : virtual public gr::block {
 
     /*!
      * \brief Return a shared_ptr to a new instance of packet_protocols::il2p_encoder.
+     *
+     * The callsigns and SSIDs are no longer used, since every frame carries its own
+     * addresses; they are kept so existing flowgraphs still construct the block.
+     * \param add_checksum End each frame in the IL2P+CRC trailer (the AX.25 FCS as four
+     *        Hamming-coded bytes); the il2p_decoder must be set to check it
      */
     static sptr make(const std::string& dest_callsign, const std::string& dest_ssid,
                      const std::string& src_callsign, const std::string& src_ssid,
@@ -50,7 +58,7 @@ class PACKET_PROTOCOLS_API il2p_encoder : virtual public gr::block {
     virtual void set_fec_type(int fec_type) = 0;
 
     /*!
-     * \brief Set add checksum
+     * \brief Enable or disable the IL2P+CRC trailer
      */
     virtual void set_add_checksum(bool add_checksum) = 0;
 };
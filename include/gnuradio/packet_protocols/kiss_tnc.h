@@ -23,7 +23,10 @@
 #define INCLUDED_PACKET_PROTOCOLS_KISS_TNC_H
 
 #include <gnuradio/packet_protocols/api.h>
-#include <gnuradio/sync_block.h>
+#include <gnuradio/block.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
 namespace gr {
 namespace packet_protocols {
@@ -32,15 +35,27 @@ namespace packet_protocols {
  * \brief KISS TNC Interface
  * \ingroup packet_protocols
  */
-class PACKET_PROTOCOLS_API kiss_tnc : virtual public gr::sync_block {
+class PACKET_PROTOCOLS_API kiss_tnc : virtual public gr::block {
   public:
     typedef std::shared_ptr<kiss_tnc> sptr;
 
     /*!
      * \brief Return a shared_ptr to a new instance of packet_protocols::kiss_tnc.
+     *
+     * \param device Serial device path, or "pty" for a virtual TNC on a newly
+     *        allocated pseudo-terminal whose slave end is reported by pty_path()
+     * \param baud_rate Baud rate: any standard rate up to 4000000, or an arbitrary
+     *        rate the driver supports (termios2/BOTHER); throws if it cannot be set
+     * \param hardware_flow_control Enable RTS/CTS flow control
+     * \param tcp_port If non-zero, also serve KISS over TCP on this port (8001 by
+     *        convention): frames from the device are sent to every client and data
+     *        frames from clients are transmitted
+     * \param tcp_bind_address IPv4 address the TCP server listens on; the default
+     *        accepts local clients only, "0.0.0.0" accepts them from any interface
      */
     static sptr make(const std::string& device, int baud_rate = 9600,
-                     bool hardware_flow_control = false);
+                     bool hardware_flow_control = false, int tcp_port = 0,
+                     const std::string& tcp_bind_address = "127.0.0.1");
 
     /*!
      * \brief Set TX delay
@@ -67,6 +82,17 @@ class PACKET_PROTOCOLS_API kiss_tnc : virtual public gr::sync_block {
      */
     virtual void set_full_duplex(bool full_duplex) = 0;
 
+    /*!
+     * \brief Set carrier detect (channel busy)
+     *
+     * On-air frames are sent by p-persistent CSMA: while carrier is detected they
+     * wait; once the channel is clear each SLOTTIME a random 0..255 is drawn and the
+     * frame goes when it is <= persistence. Full duplex skips channel access. The
+     * "dcd" message port accepts a boolean, a (key . boolean) pair or a dict with a
+     * "dcd" entry.
+     */
+    virtual void set_dcd(bool busy) = 0;
+
     /*!
      * \brief Set PTT state
      * \param ptt_state PTT state (true = keyed, false = unkeyed)
@@ -90,6 +116,120 @@ class PACKET_PROTOCOLS_API kiss_tnc : virtual public gr::sync_block {
      * \param use_dtr Use DTR for PTT (false = use RTS)
      */
     virtual void set_ptt_use_dtr(bool use_dtr) = 0;
+
+    /*!
+     * \brief Baud rate the serial driver reports after configuration
+     */
+    virtual int actual_baud_rate() const = 0;
+
+    /*!
+     * \brief Request ASYNC_LOW_LATENCY on the serial port (on by default)
+     *
+     * Drivers without the flag (USB CDC, pseudo-terminals) ignore the request.
+     */
+    virtual void set_low_latency(bool low_latency) = 0;
+
+    /*!
+     * \brief Set the serial VMIN/VTIME read thresholds
+     * \param vmin Bytes buffered before the RX thread is woken (0 or 1: every byte)
+     * \param vtime Inter-byte timeout in 100 ms units; non-zero wakes on every byte
+     */
+    virtual void set_read_thresholds(int vmin, int vtime) = 0;
+
+    /*!
+     * \brief Number of logical KISS ports routed by the type byte's high nibble
+     *
+     * Data frames for port N are published as PDUs on message port "portN" (port 0 is
+     * also transmitted on the serial device); parameter commands (TXDELAY, P, SLOTTIME,
+     * TXTAIL, FULLDUPLEX, SETHARDWARE) update that port's state and are published there
+     * as a dict. PDUs on "port_in" (meta "port") are KISS-framed back to the host.
+     * Frames for ports >= num_ports are ignored. With a single port (the default) type
+     * bytes 0x10-0x14 carry the negotiation extension; routing port 1 disables it.
+     * \param num_ports 1..16
+     */
+    virtual void set_num_ports(int num_ports) = 0;
+
+    /*!
+     * \brief Number of routed logical KISS ports
+     */
+    virtual int num_ports() const = 0;
+
+    /*!
+     * \brief Number of complete KISS frames read from the device
+     */
+    virtual uint64_t rx_frames() const = 0;
+
+    /*!
+     * \brief Number of times the serial RX ring was full and bytes were dropped
+     */
+    virtual uint64_t rx_overruns() const = 0;
+
+    /*!
+     * \brief Total bytes dropped because the serial RX ring was full
+     */
+    virtual uint64_t rx_overrun_bytes() const = 0;
+
+    /*!
+     * \brief Device-to-output latency histogram for received KISS frames
+     * \return Bucket i counts frames delivered within [2^i, 2^(i+1)) microseconds
+     */
+    virtual std::vector<uint64_t> rx_latency_histogram() const = 0;
+
+    /*!
+     * \brief Bytes accepted for transmission but not yet written to the device
+     */
+    virtual size_t tx_bytes_in_flight() const = 0;
+
+    /*!
+     * \brief Frames dropped by the TX path (queue or byte bound reached, write error)
+     */
+    virtual uint64_t tx_frames_dropped() const = 0;
+
+    /*!
+     * \brief Slave path of the virtual TNC's pseudo-terminal (device "pty")
+     *
+     * Host software opens this path as if it were the TNC's serial port. The path is
+     * empty when the block drives a real serial device.
+     */
+    virtual std::string pty_path() const = 0;
+
+    /*!
+     * \brief Number of times the PTT line (RTS or DTR) was asserted
+     *
+     * A pseudo-terminal has no modem control lines, so in "pty" mode the line changes
+     * are emulated and only counted.
+     */
+    virtual uint64_t ptt_key_count() const = 0;
+
+    /*!
+     * \brief Number of times the PTT line was released
+     */
+    virtual uint64_t ptt_unkey_count() const = 0;
+
+    /*!
+     * \brief Bound the TX queue (defaults 64 frames, 65536 bytes)
+     *
+     * Frames for the air are queued in three classes, sent highest first: link control
+     * (AX.25 S frames and U frames other than UI), interactive (I/UI frames with up to
+     * 64 information bytes) and bulk. At a bound an arriving frame evicts frames of a
+     * lower class; within its own class the drop policy applies.
+     */
+    virtual void set_tx_queue_limits(int max_frames, int max_bytes) = 0;
+
+    /*!
+     * \brief Drop policy within a class: evict the oldest queued frame (true) or
+     *        refuse the arriving one (false, the default)
+     */
+    virtual void set_tx_drop_oldest(bool drop_oldest) = 0;
+
+    /*!
+     * \brief Period of the "tx_stats" report (0 = off, the default)
+     *
+     * The report is a dict with an entry per class ("control", "interactive", "bulk")
+     * holding frames and bytes queued, frames sent and dropped, and the smoothed and
+     * maximum sojourn time (enqueue to written) in milliseconds, plus bytes_in_flight.
+     */
+    virtual void set_tx_stats_interval(int interval_ms) = 0;
 };
 
 } // namespace packet_protocols
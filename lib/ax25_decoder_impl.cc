@@ -36,10 +36,11 @@ ax25_decoder::sptr ax25_decoder::make() {
 
 ax25_decoder_impl::ax25_decoder_impl()
     : gr::block("ax25_decoder", gr::io_signature::make(1, 1, sizeof(char)),
-                gr::io_signature::make(1, 1, sizeof(char))),
+                gr::io_signature::make(1, 2, sizeof(char))),
       d_state(STATE_IDLE), d_bit_buffer(0), d_bit_count(0), d_frame_buffer(2048), d_frame_length(0),
       d_ones_count(0), d_escaped(false) {
     d_frame_length = 0;
+    message_port_register_out(pmt::mp("dcd"));
 }
 
 ax25_decoder_impl::~ax25_decoder_impl() {
@@ -63,6 +64,8 @@ int ax25_decoder_impl::general_work(int noutput_items,
 {
     const char* in = (const char*)input_items[0];
     char* out = (char*)output_items[0];
+    // Optional second output: the DCD state for every consumed input bit
+    char* dcd_out = output_items.size() > 1 ? (char*)output_items[1] : nullptr;
     int produced = 0;
     int consumed = 0;
     const int nin = ninput_items[0];
@@ -72,8 +75,15 @@ int ax25_decoder_impl::general_work(int noutput_items,
         d_out_queue.pop_front();
     }
 
-    while (produced < noutput_items && consumed < nin) {
+    while (produced < noutput_items && consumed < nin &&
+           (!dcd_out || consumed < noutput_items)) {
         bool bit = in[consumed] != 0;
+        if (d_dcd.process(bit)) {
+            message_port_pub(pmt::mp("dcd"),
+                             pmt::cons(pmt::mp("dcd"), pmt::from_bool(d_dcd.dcd())));
+        }
+        if (dcd_out)
+            dcd_out[consumed] = d_dcd.dcd() ? 1 : 0;
         consumed++;
         process_bit(bit);
 
@@ -97,6 +107,11 @@ int ax25_decoder_impl::general_work(int noutput_items,
     }
 
     consume_each(consumed);
+    if (dcd_out) {
+        produce(0, produced);
+        produce(1, consumed);
+        return WORK_CALLED_PRODUCE;
+    }
     return produced;
 }
 
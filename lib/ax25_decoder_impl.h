@@ -23,6 +23,7 @@
 #define INCLUDED_PACKET_PROTOCOLS_AX25_DECODER_IMPL_H
 
 #include <deque>
+#include "hdlc_dcd.h"
 #include <gnuradio/packet_protocols/ax25_decoder.h>
 #include <gnuradio/packet_protocols/ax25_protocol.h>
 #include <vector>
@@ -51,6 +52,7 @@ class ax25_decoder_impl : public ax25_decoder {
     bool d_escaped;                      //!< Escape flag for bit stuffing
 
     std::deque<uint8_t> d_out_queue; //!< Pending PDU bytes (handles output buffer smaller than PDU)
+    hdlc_dcd d_dcd;                  //!< Carrier detect on the raw bit stream
 
   public:
     /*!
@@ -76,6 +78,10 @@ class ax25_decoder_impl : public ax25_decoder {
                      gr_vector_const_void_star& input_items,
                      gr_vector_void_star& output_items) override;
 
+    void set_dcd_flags(int flags) override { d_dcd.set_flags_to_assert(flags); }
+    void set_dcd_hold_off(int bits) override { d_dcd.set_hold_off(bits); }
+    bool dcd() const override { return d_dcd.dcd(); }
+
   private:
     /*!
      * \brief Process a single bit through the state machine
@@ -43,6 +43,11 @@ static uint16_t calculate_fcs_internal(const uint8_t* data, uint16_t length) {
     return fcs ^ 0xFFFF;
 }
 
+// I-frames and UI frames carry a PID; supervisory and other unnumbered frames do not
+static bool frame_has_pid(uint8_t control) {
+    return (control & 0x01) == 0x00 || (control & 0xEF) == AX25_CTRL_UI;
+}
+
 // Initialize AX.25 TNC
 AX25_EXPORT int ax25_init(ax25_tnc_t* tnc) {
     if (!tnc) {
@@ -57,14 +62,26 @@ AX25_EXPORT int ax25_init(ax25_tnc_t* tnc) {
     tnc->config.slot_time = 10;     // 100ms
     tnc->config.tx_tail = 10;       // 100ms
     tnc->config.full_duplex = false;
-    tnc->config.max_frame_length = 2048; // AX.25 v2.2 supports up to 2048 bytes
+    tnc->config.max_frame_length = AX25_MAX_INFO; // AX.25 v2.2 supports up to 2048 bytes
     tnc->config.window_size = 4;
     tnc->config.t1_timeout = 3000;  // 3 seconds
+    tnc->config.t1_min = 500;
+    tnc->config.t1_max = 60000;
+    tnc->config.bit_rate = 1200;
     tnc->config.t2_timeout = 1000;  // 1 second
     tnc->config.t3_timeout = 30000; // 30 seconds
     tnc->config.max_retries = 3;
+    tnc->config.selective_reject = true;
+    tnc->config.xid_negotiation = true;
+    tnc->config.max_connections = AX25_DEFAULT_MAX_CONNECTIONS;
+    tnc->config.reassembly_timeout = 60000; // 1 minute
     
     tnc->num_connections = 0;
+    tnc->free_connection = AX25_NO_CONNECTION; // Table allocated on the first connection
+    memset(tnc->timers.slots, 0xFF, sizeof(tnc->timers.slots)); // Empty timing wheel
+    for (int i = 0; i < AX25_REASSEMBLY_SLOTS; i++) {
+        tnc->reassembly[i].connection = AX25_NO_CONNECTION;
+    }
     tnc->frame_ready = false;
     
     return 0;
@@ -76,12 +93,37 @@ AX25_EXPORT int ax25_cleanup(ax25_tnc_t* tnc) {
         return -1;
     }
     
-    // Reset all connections
-    for (int i = 0; i < 16; i++) {
-        tnc->connections[i].state = AX25_STATE_DISCONNECTED;
-    }
+    // Release all connections with their retransmit buffers and messages, then the table
+    for (uint16_t i = 0; i < tnc->connection_capacity; i++) {
+        ax25_connection_t* conn = &tnc->connections[i];
+        for (int seq = 0; conn->tx_slots && seq < AX25_MODULO_EXTENDED; seq++) {
+            free(conn->tx_slots[seq].data);
+        }
+        for (int seq = 0; conn->rx_slots && seq < AX25_MODULO_EXTENDED; seq++) {
+            free(conn->rx_slots[seq].data);
+        }
+        free(conn->tx_slots);
+        free(conn->rx_slots);
+        free(conn->tx_message);
+    }
+    free(tnc->connections);
+    free(tnc->connection_index);
+    tnc->connections = NULL;
+    tnc->connection_index = NULL;
+    tnc->connection_capacity = 0;
+    tnc->index_size = 0;
+    tnc->free_connection = AX25_NO_CONNECTION;
+    tnc->service_index = 0;
     tnc->num_connections = 0;
+    memset(&tnc->timers, 0, sizeof(ax25_timer_wheel_t));
+    memset(tnc->timers.slots, 0xFF, sizeof(tnc->timers.slots));
+    for (int i = 0; i < AX25_REASSEMBLY_SLOTS; i++) {
+        ax25_reassembly_reset(&tnc->reassembly[i]);
+        tnc->reassembly[i].connection = AX25_NO_CONNECTION;
+    }
     tnc->frame_ready = false;
+    memset(&tnc->tx_control_ring, 0, sizeof(ax25_tx_ring_t));
+    memset(&tnc->tx_data_ring, 0, sizeof(ax25_tx_ring_t));
     
     return 0;
 }
@@ -110,7 +152,7 @@ AX25_EXPORT int ax25_set_address(ax25_address_t* addr, const char* callsign, uin
         return -1;
     }
     
-    memset(addr->callsign, 0x20, 6); // Space fill
+    memset(addr->callsign, 0x20 << 1, 6); // Space fill (shifted like the characters)
     int len = strlen(callsign);
     if (len > 6) len = 6;
     
@@ -125,7 +167,7 @@ AX25_EXPORT int ax25_set_address(ax25_address_t* addr, const char* callsign, uin
     if (command) {
         addr->ssid |= 0x80; // Set C bit
     }
-    addr->ssid |= 0x01; // Set reserved bit
+    addr->ssid |= 0x60; // Reserved bits; the E bit is set by ax25_encode_frame
     addr->command = command;
     addr->has_been_repeated = false;
     
@@ -158,8 +200,9 @@ int ax25_address_equal(const ax25_address_t* addr1, const ax25_address_t* addr2)
     if (!addr1 || !addr2) {
         return 0;
     }
+    // Station identity is callsign + SSID; the C/H, reserved and E bits do not count
     return (memcmp(addr1->callsign, addr2->callsign, 6) == 0) &&
-           (addr1->ssid == addr2->ssid);
+           (((addr1->ssid ^ addr2->ssid) & 0x1E) == 0);
 }
 
 // Create frame
@@ -193,72 +236,128 @@ AX25_EXPORT int ax25_create_frame(ax25_frame_t* frame, const ax25_address_t* src
     return 0;
 }
 
-// Parse frame (simplified - full implementation would be more complex)
-int ax25_parse_frame(const uint8_t* data, uint16_t length, ax25_frame_t* frame) {
-    if (!data || !frame || length < 14) {
+// Parse a frame in place: walk the address E-bit chain, then control, PID and the
+// information field up to the two FCS bytes
+AX25_EXPORT int ax25_parse_frame_view(const uint8_t* data, uint16_t length,
+                                      ax25_frame_view_t* view) {
+    if (!data || !view) {
         return -1;
     }
     
-    memset(frame, 0, sizeof(ax25_frame_t));
-    
-    // Parse addresses (minimum 2 addresses = 14 bytes)
-    int pos = 0;
-    frame->num_addresses = 0;
-    
-    while (pos < length - 2 && frame->num_addresses < AX25_MAX_ADDRS) {
-        if (pos + 7 > length) break;
-        
-        memcpy(frame->addresses[frame->num_addresses].callsign, &data[pos], 6);
-        frame->addresses[frame->num_addresses].ssid = data[pos + 6];
-        frame->addresses[frame->num_addresses].command = (data[pos + 6] & 0x80) != 0;
-        frame->addresses[frame->num_addresses].has_been_repeated = (data[pos + 6] & 0x01) != 0;
-        
-        pos += 7;
-        frame->num_addresses++;
-        
-        // Check if last address (E bit set)
-        if ((frame->addresses[frame->num_addresses - 1].ssid & 0x01) == 0) {
+    // Addresses end at the first one with the E bit set
+    uint16_t pos = 0;
+    uint8_t num_addresses = 0;
+    for (;;) {
+        if (num_addresses == AX25_MAX_ADDRS || pos + AX25_ADDR_LEN > length) {
+            return -1; // No E bit within the frame or after the last digipeater
+        }
+        pos += AX25_ADDR_LEN;
+        num_addresses++;
+        if ((data[pos - 1] & 0x01) != 0) {
             break;
         }
     }
-    
-    if (pos >= length) {
+    if (num_addresses < 2) {
         return -1;
     }
     
-    // Parse control field
-    frame->control = data[pos++];
-    
-    // Parse PID if UI frame
-    if ((frame->control & 0x03) == 0x03) {
-        if (pos >= length) {
+    // Control, PID if the frame type has one, and the FCS must all be present
+    if (pos + 1 + 2 > length) {
+        return -1;
+    }
+    view->addresses = data;
+    view->num_addresses = num_addresses;
+    view->control = data[pos++];
+    view->pid = 0;
+    if (frame_has_pid(view->control)) {
+        if (pos + 1 + 2 > length) {
             return -1;
         }
-        frame->pid = data[pos++];
-    } else {
-        frame->pid = 0;
+        view->pid = data[pos++];
     }
     
-    // Parse information field
-    if (pos + 2 < length) {
-        uint16_t info_len = length - pos - 2; // -2 for FCS
-        if (info_len > AX25_MAX_INFO) {
-            info_len = AX25_MAX_INFO;
-        }
-        memcpy(frame->info, &data[pos], info_len);
-        frame->info_length = info_len;
-        pos += info_len;
+    uint16_t info_length = length - pos - 2;
+    if (info_length > AX25_MAX_INFO + 1) { // + the PID of a modulo-128 I-frame
+        return -1;
     }
+    view->info = info_length > 0 ? &data[pos] : NULL;
+    view->info_length = info_length;
+    pos += info_length;
+    view->fcs = data[pos] | (data[pos + 1] << 8);
     
-    // Parse FCS
-    if (pos + 2 <= length) {
-        frame->fcs = data[pos] | (data[pos + 1] << 8);
+    return 0;
+}
+
+// Decode one address of a view; C on the destination and source, H on a digipeater
+AX25_EXPORT int ax25_view_address(const ax25_frame_view_t* view, uint8_t index,
+                                  ax25_address_t* addr) {
+    if (!view || !addr || index >= view->num_addresses) {
+        return -1;
+    }
+    const uint8_t* field = &view->addresses[index * AX25_ADDR_LEN];
+    memcpy(addr->callsign, field, 6);
+    addr->ssid = field[6];
+    addr->command = index < 2 && (field[6] & 0x80) != 0;
+    addr->has_been_repeated = index >= 2 && (field[6] & 0x80) != 0;
+    return 0;
+}
+
+// Compare one address of a view with a station without decoding it
+AX25_EXPORT int ax25_view_address_equal(const ax25_frame_view_t* view, uint8_t index,
+                                        const ax25_address_t* addr) {
+    if (!view || !addr || index >= view->num_addresses) {
+        return 0;
+    }
+    const uint8_t* field = &view->addresses[index * AX25_ADDR_LEN];
+    return memcmp(field, addr->callsign, 6) == 0 && ((field[6] ^ addr->ssid) & 0x1E) == 0;
+}
+
+// The digipeater that has to repeat the frame next
+AX25_EXPORT int ax25_view_next_digipeater(const ax25_frame_view_t* view) {
+    if (!view) {
+        return -1;
+    }
+    for (uint8_t i = 2; i < view->num_addresses; i++) {
+        if ((view->addresses[i * AX25_ADDR_LEN + 6] & 0x80) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Copy a view into a self-contained frame
+AX25_EXPORT int ax25_frame_from_view(const ax25_frame_view_t* view, ax25_frame_t* frame) {
+    if (!view || !frame) {
+        return -1;
     }
     
+    for (uint8_t i = 0; i < view->num_addresses; i++) {
+        ax25_view_address(view, i, &frame->addresses[i]);
+    }
+    frame->num_addresses = view->num_addresses;
+    frame->control = view->control;
+    frame->control_ext = 0;
+    frame->extended = false; // Modulo-128 frames are re-split by the connection
+    frame->pid = view->pid;
+    if (view->info_length > 0) {
+        memcpy(frame->info, view->info, view->info_length);
+    }
+    frame->info_length = view->info_length;
+    frame->fcs = view->fcs;
     frame->valid = true;
+    
     return 0;
 }
 
+// Parse frame into a copy that does not refer to data
+int ax25_parse_frame(const uint8_t* data, uint16_t length, ax25_frame_t* frame) {
+    ax25_frame_view_t view;
+    if (!frame || ax25_parse_frame_view(data, length, &view) != 0) {
+        return -1;
+    }
+    return ax25_frame_from_view(&view, frame);
+}
+
 // Encode frame
 AX25_EXPORT int ax25_encode_frame(const ax25_frame_t* frame, uint8_t* data, uint16_t* length) {
     if (!frame || !data || !length) {
@@ -277,7 +376,7 @@ AX25_EXPORT int ax25_encode_frame(const ax25_frame_t* frame, uint8_t* data, uint
             return -1;
         }
         memcpy(&data[pos], frame->addresses[i].callsign, 6);
-        data[pos + 6] = frame->addresses[i].ssid;
+        data[pos + 6] = frame->addresses[i].ssid & 0xFE;
         if (i == frame->num_addresses - 1) {
             data[pos + 6] |= 0x01; // Set E bit on last address
         }
@@ -289,9 +388,15 @@ AX25_EXPORT int ax25_encode_frame(const ax25_frame_t* frame, uint8_t* data, uint
         return -1;
     }
     data[pos++] = frame->control;
+    if (frame->extended && (frame->control & 0x03) != 0x03) {
+        if (pos >= *length) {
+            return -1;
+        }
+        data[pos++] = frame->control_ext;
+    }
     
-    // Encode PID if UI frame
-    if ((frame->control & 0x03) == 0x03) {
+    // Encode PID if I or UI frame
+    if (frame_has_pid(frame->control)) {
         if (pos >= *length) {
             return -1;
         }
@@ -340,34 +445,904 @@ int ax25_validate_frame(const ax25_frame_t* frame) {
     return 0;
 }
 
+// Connection table: entries live in one array that doubles up to max_connections, unused
+// entries are chained into a free list, and an open-addressing (linear probing) hash of
+// the packed local and remote addresses maps a frame to its entry in O(1). The index is
+// kept at most half full, so a probe always ends on an empty slot.
+static uint32_t connection_hash(const ax25_address_t* local,
+                                const ax25_address_t* remote) {
+    uint32_t hash = 2166136261u; // FNV-1a
+    const ax25_address_t* addrs[2] = { local, remote };
+    for (int a = 0; a < 2; a++) {
+        for (int i = 0; i < 6; i++) {
+            hash = (hash ^ addrs[a]->callsign[i]) * 16777619u;
+        }
+        hash = (hash ^ (addrs[a]->ssid & 0x1E)) * 16777619u;
+    }
+    return hash;
+}
+
+static void index_insert(ax25_tnc_t* tnc, uint16_t entry) {
+    uint16_t mask = (uint16_t)(tnc->index_size - 1);
+    uint16_t pos = (uint16_t)(tnc->connections[entry].hash & mask);
+    while (tnc->connection_index[pos] != AX25_NO_CONNECTION) {
+        pos = (uint16_t)((pos + 1) & mask);
+    }
+    tnc->connection_index[pos] = entry;
+}
+
+// Remove an entry, shifting later entries of the probe run back so no lookup stops early
+static void index_remove(ax25_tnc_t* tnc, uint16_t entry) {
+    uint16_t mask = (uint16_t)(tnc->index_size - 1);
+    uint16_t pos = (uint16_t)(tnc->connections[entry].hash & mask);
+    while (tnc->connection_index[pos] != entry) {
+        pos = (uint16_t)((pos + 1) & mask);
+    }
+    
+    uint16_t next = pos;
+    for (;;) {
+        next = (uint16_t)((next + 1) & mask);
+        uint16_t moved = tnc->connection_index[next];
+        if (moved == AX25_NO_CONNECTION) {
+            break;
+        }
+        uint16_t home = (uint16_t)(tnc->connections[moved].hash & mask);
+        // The entry may fill the hole only if its home slot is not between hole and it
+        if (((next - home) & mask) >= ((next - pos) & mask)) {
+            tnc->connection_index[pos] = moved;
+            pos = next;
+        }
+    }
+    tnc->connection_index[pos] = AX25_NO_CONNECTION;
+}
+
+// Double the table (up to max_connections) and rebuild the index; -1 at the limit
+static int grow_connections(ax25_tnc_t* tnc) {
+    uint32_t limit = tnc->config.max_connections;
+    if (limit > AX25_MAX_CONNECTIONS) {
+        limit = AX25_MAX_CONNECTIONS;
+    }
+    uint32_t capacity = tnc->connection_capacity ? tnc->connection_capacity * 2u : 16u;
+    if (capacity > limit) {
+        capacity = limit;
+    }
+    if (capacity <= tnc->connection_capacity) {
+        return -1;
+    }
+    uint32_t index_size = 1;
+    while (index_size < capacity * 2) {
+        index_size <<= 1;
+    }
+    
+    // The index is rebuilt from scratch, so allocate it fresh before touching the table:
+    // on failure nothing has changed
+    uint16_t* index = malloc(index_size * sizeof(uint16_t));
+    if (!index) {
+        return -1;
+    }
+    ax25_connection_t* connections =
+        realloc(tnc->connections, capacity * sizeof(ax25_connection_t));
+    if (!connections) {
+        free(index);
+        return -1;
+    }
+    tnc->connections = connections;
+    free(tnc->connection_index);
+    tnc->connection_index = index;
+    
+    // New entries go on the free list in order
+    uint16_t first = tnc->connection_capacity;
+    memset(&connections[first], 0, (capacity - first) * sizeof(ax25_connection_t));
+    for (uint32_t i = first; i < capacity; i++) {
+        connections[i].next_free =
+            (uint16_t)(i + 1 < capacity ? i + 1 : AX25_NO_CONNECTION);
+    }
+    tnc->free_connection = first;
+    tnc->connection_capacity = (uint16_t)capacity;
+    
+    tnc->index_size = (uint16_t)index_size;
+    memset(index, 0xFF, index_size * sizeof(uint16_t));
+    for (uint16_t i = 0; i < first; i++) {
+        if (connections[i].state != AX25_STATE_DISCONNECTED) {
+            index_insert(tnc, i);
+        }
+    }
+    return 0;
+}
+
 // Helper function to find a connection by remote address
 static ax25_connection_t* find_connection(ax25_tnc_t* tnc, const ax25_address_t* remote_addr) {
-    if (!tnc || !remote_addr) {
+    if (!tnc || !remote_addr || tnc->index_size == 0) {
         return NULL;
     }
     
-    for (int i = 0; i < 16; i++) {
-        if (tnc->connections[i].state != AX25_STATE_DISCONNECTED) {
-            if (ax25_address_equal(&tnc->connections[i].remote_addr, remote_addr)) {
-                return &tnc->connections[i];
-            }
+    const ax25_address_t* local = &tnc->config.my_address;
+    uint32_t hash = connection_hash(local, remote_addr);
+    uint16_t mask = (uint16_t)(tnc->index_size - 1);
+    for (uint16_t pos = (uint16_t)(hash & mask);; pos = (uint16_t)((pos + 1) & mask)) {
+        uint16_t entry = tnc->connection_index[pos];
+        if (entry == AX25_NO_CONNECTION) {
+            return NULL;
+        }
+        ax25_connection_t* conn = &tnc->connections[entry];
+        if (conn->hash == hash && ax25_address_equal(&conn->remote_addr, remote_addr) &&
+            ax25_address_equal(&conn->local_addr, local)) {
+            return conn;
+        }
+    }
+}
+
+// Take an entry from the free list (growing the table if needed) and index it under
+// (my_address, remote_addr). Pointers to other entries are invalid afterwards.
+static ax25_connection_t* alloc_connection(ax25_tnc_t* tnc,
+                                           const ax25_address_t* remote_addr,
+                                           ax25_state_t state) {
+    if (tnc->free_connection == AX25_NO_CONNECTION && grow_connections(tnc) != 0) {
+        return NULL; // Table full
+    }
+    
+    uint16_t entry = tnc->free_connection;
+    ax25_connection_t* conn = &tnc->connections[entry];
+    tnc->free_connection = conn->next_free;
+    memset(conn, 0, sizeof(ax25_connection_t));
+    conn->local_addr = tnc->config.my_address;
+    conn->remote_addr = *remote_addr;
+    conn->state = state;
+    conn->hash = connection_hash(&conn->local_addr, &conn->remote_addr);
+    conn->next_free = AX25_NO_CONNECTION;
+    conn->timeout = tnc->config.t1_timeout;
+    index_insert(tnc, entry);
+    tnc->num_connections++;
+    return conn;
+}
+
+// Timing wheel. A timer is linked into the level its remaining time falls in, at the slot
+// its expiry maps to; when the wheel reaches a slot above level 0 the timers move down a
+// level, and reaching a level-0 slot fires them. Arming and stopping are O(1), and
+// ax25_tick() jumps straight to the next occupied slot instead of stepping through time.
+#define WHEEL_BITS 6
+#define WHEEL_MASK (AX25_WHEEL_SLOTS - 1)
+#define WHEEL_SPAN(level) (1ull << (WHEEL_BITS * (level)))
+
+static ax25_timer_t* timer_at(ax25_tnc_t* tnc, uint32_t id) {
+    return &tnc->connections[id / AX25_TIMER_COUNT].timers[id % AX25_TIMER_COUNT];
+}
+
+static uint32_t timer_id(const ax25_tnc_t* tnc, const ax25_connection_t* conn,
+                         int timer) {
+    return (uint32_t)(conn - tnc->connections) * AX25_TIMER_COUNT + (uint32_t)timer;
+}
+
+static void wheel_link(ax25_tnc_t* tnc, uint32_t id) {
+    ax25_timer_wheel_t* wheel = &tnc->timers;
+    ax25_timer_t* timer = timer_at(tnc, id);
+    uint64_t expires = timer->expires < wheel->time ? wheel->time : timer->expires;
+    uint64_t delta = expires - wheel->time;
+    int level = 0;
+    while (level < AX25_WHEEL_LEVELS - 1 && delta >= WHEEL_SPAN(level + 1)) {
+        level++;
+    }
+    if (delta >= WHEEL_SPAN(AX25_WHEEL_LEVELS)) {
+        expires = wheel->time + WHEEL_SPAN(AX25_WHEEL_LEVELS) - 1; // Placed again later
+    }
+    
+    timer->level = (uint8_t)level;
+    timer->slot = (uint8_t)((expires >> (WHEEL_BITS * level)) & WHEEL_MASK);
+    uint32_t* head = &wheel->slots[level][timer->slot];
+    timer->prev = AX25_NO_TIMER;
+    timer->next = *head;
+    if (*head != AX25_NO_TIMER) {
+        timer_at(tnc, *head)->prev = id;
+    }
+    *head = id;
+    wheel->occupied[level] |= 1ull << timer->slot;
+}
+
+static void timer_stop(ax25_tnc_t* tnc, uint32_t id) {
+    ax25_timer_wheel_t* wheel = &tnc->timers;
+    ax25_timer_t* timer = timer_at(tnc, id);
+    if (!timer->armed) {
+        return;
+    }
+    if (timer->prev != AX25_NO_TIMER) {
+        timer_at(tnc, timer->prev)->next = timer->next;
+    } else {
+        wheel->slots[timer->level][timer->slot] = timer->next;
+        if (timer->next == AX25_NO_TIMER) {
+            wheel->occupied[timer->level] &= ~(1ull << timer->slot);
+        }
+    }
+    if (timer->next != AX25_NO_TIMER) {
+        timer_at(tnc, timer->next)->prev = timer->prev;
+    }
+    timer->armed = false;
+    wheel->armed--;
+}
+
+static uint64_t clock_now(const ax25_tnc_t* tnc) {
+    return tnc->clock ? tnc->clock(tnc->clock_context) : tnc->timers.now;
+}
+
+// (Re)arm a timer to fire delay ms from now
+static void timer_start(ax25_tnc_t* tnc, uint32_t id, uint32_t delay) {
+    ax25_timer_wheel_t* wheel = &tnc->timers;
+    timer_stop(tnc, id);
+    uint64_t now = clock_now(tnc);
+    if (wheel->armed == 0 && now > wheel->time) {
+        wheel->time = now; // Nothing to process in between
+    }
+    ax25_timer_t* timer = timer_at(tnc, id);
+    timer->expires = now + delay;
+    timer->armed = true;
+    wheel->armed++;
+    wheel_link(tnc, id);
+}
+
+static bool timer_armed(ax25_tnc_t* tnc, const ax25_connection_t* conn, int timer) {
+    return timer_at(tnc, timer_id(tnc, conn, timer))->armed;
+}
+
+// Earliest time at which the wheel reaches an occupied slot (the wheel is not empty)
+static uint64_t wheel_next_event(const ax25_timer_wheel_t* wheel) {
+    uint64_t next = UINT64_MAX;
+    for (int level = 0; level < AX25_WHEEL_LEVELS; level++) {
+        uint64_t bits = wheel->occupied[level];
+        if (!bits) {
+            continue;
+        }
+        // First slot boundary of this level at or after time, and its slot index
+        uint64_t span = WHEEL_SPAN(level);
+        uint64_t base = (wheel->time + span - 1) & ~(span - 1);
+        unsigned index = (unsigned)((base >> (WHEEL_BITS * level)) & WHEEL_MASK);
+        uint64_t rotated = index ? (bits >> index) | (bits << (AX25_WHEEL_SLOTS - index))
+                                 : bits;
+        unsigned distance = 0;
+        while (!(rotated & 1)) {
+            rotated >>= 1;
+            distance++;
+        }
+        uint64_t t = base + distance * span;
+        if (t < next) {
+            next = t;
+        }
+    }
+    return next;
+}
+
+// Move the timers of each level whose slot boundary t is down to where they now belong
+static void wheel_cascade(ax25_tnc_t* tnc, uint64_t t) {
+    ax25_timer_wheel_t* wheel = &tnc->timers;
+    for (int level = 1; level < AX25_WHEEL_LEVELS; level++) {
+        if (t & (WHEEL_SPAN(level) - 1)) {
+            break;
+        }
+        unsigned slot = (unsigned)((t >> (WHEEL_BITS * level)) & WHEEL_MASK);
+        uint32_t id = wheel->slots[level][slot];
+        wheel->slots[level][slot] = AX25_NO_TIMER;
+        wheel->occupied[level] &= ~(1ull << slot);
+        while (id != AX25_NO_TIMER) {
+            uint32_t next = timer_at(tnc, id)->next;
+            wheel_link(tnc, id);
+            id = next;
+        }
+    }
+}
+
+// TX rings. Entries wrap at the end of the storage.
+static void ring_write(uint8_t* storage, uint16_t capacity, uint32_t offset,
+                       const uint8_t* src, uint16_t n) {
+    offset %= capacity;
+    uint16_t first = n < capacity - offset ? n : (uint16_t)(capacity - offset);
+    memcpy(&storage[offset], src, first);
+    memcpy(storage, src + first, n - first);
+}
+
+static void ring_read(const uint8_t* storage, uint16_t capacity, uint32_t offset,
+                      uint8_t* dst, uint16_t n) {
+    offset %= capacity;
+    uint16_t first = n < capacity - offset ? n : (uint16_t)(capacity - offset);
+    memcpy(dst, &storage[offset], first);
+    memcpy(dst + first, storage, n - first);
+}
+
+static bool ring_push(uint8_t* storage, uint16_t capacity, ax25_tx_ring_t* ring,
+                      const uint8_t* frame, uint16_t length) {
+    if ((uint32_t)ring->used + 2 + length > capacity) {
+        return false;
+    }
+    uint8_t prefix[2] = { (uint8_t)(length & 0xFF), (uint8_t)(length >> 8) };
+    uint32_t tail = (uint32_t)ring->head + ring->used;
+    ring_write(storage, capacity, tail, prefix, 2);
+    ring_write(storage, capacity, tail + 2, frame, length);
+    ring->used += 2 + length;
+    ring->frames++;
+    return true;
+}
+
+static uint16_t ring_front_length(const uint8_t* storage, uint16_t capacity,
+                                  const ax25_tx_ring_t* ring) {
+    uint8_t prefix[2];
+    ring_read(storage, capacity, ring->head, prefix, 2);
+    return (uint16_t)(prefix[0] | (prefix[1] << 8));
+}
+
+static void ring_pop(const uint8_t* storage, uint16_t capacity, ax25_tx_ring_t* ring,
+                     uint8_t* dst) {
+    uint16_t length = ring_front_length(storage, capacity, ring);
+    ring_read(storage, capacity, (uint32_t)ring->head + 2, dst, length);
+    ring->head = (uint16_t)(((uint32_t)ring->head + 2 + length) % capacity);
+    ring->used -= 2 + length;
+    ring->frames--;
+}
+
+// Queue an encoded frame: S and U frames (except UI) on the control ring, which is
+// drained first, so acknowledgements never wait behind bulk data. -1 if it is full.
+static int queue_encoded(ax25_tnc_t* tnc, uint8_t control, const uint8_t* frame,
+                         uint16_t length) {
+    bool priority = (control & 0x01) != 0 && (control & 0xEF) != AX25_CTRL_UI;
+    ax25_tx_ring_t* ring = priority ? &tnc->tx_control_ring : &tnc->tx_data_ring;
+    uint8_t* storage = priority ? tnc->tx_control : tnc->tx_data;
+    uint16_t capacity = priority ? AX25_TX_CONTROL_BYTES : AX25_TX_DATA_BYTES;
+    if (!ring_push(storage, capacity, ring, frame, length)) {
+        ring->dropped++;
+        return -1;
+    }
+    return 0;
+}
+
+static int queue_frame(ax25_tnc_t* tnc, const ax25_frame_t* frame) {
+    uint8_t encoded[AX25_MAX_FRAME_BYTES];
+    uint16_t length = sizeof(encoded);
+    if (ax25_encode_frame(frame, encoded, &length) != 0) {
+        return -1;
+    }
+    return queue_encoded(tnc, frame->control, encoded, length);
+}
+
+// Sequence number modulus of a connection
+static uint8_t link_modulus(const ax25_connection_t* conn) {
+    return conn->extended_mode ? AX25_MODULO_EXTENDED : AX25_MODULO;
+}
+
+// (a - b) in the connection's sequence space
+static uint8_t seq_distance(const ax25_connection_t* conn, uint8_t a, uint8_t b) {
+    return (uint8_t)((a - b) & (link_modulus(conn) - 1));
+}
+
+static uint8_t seq_next(const ax25_connection_t* conn, uint8_t seq) {
+    return (uint8_t)((seq + 1) & (link_modulus(conn) - 1));
+}
+
+// Window for a new link: the configured k, clamped to what the modulus allows
+static uint8_t link_window(const ax25_tnc_t* tnc, bool extended) {
+    uint8_t max = extended ? AX25_WINDOW_MAX_EXTENDED : AX25_WINDOW_MAX;
+    uint8_t k = tnc->config.window_size;
+    if (k == 0) {
+        return 1;
+    }
+    return k > max ? max : k;
+}
+
+// Largest I-field this station accepts (N1)
+static uint16_t link_max_info(const ax25_tnc_t* tnc) {
+    uint16_t n1 = tnc->config.max_frame_length;
+    return n1 == 0 || n1 > AX25_MAX_INFO ? AX25_MAX_INFO : n1;
+}
+
+// Per-sequence-number bit sets (SREJ bookkeeping)
+static bool seq_bit(const uint64_t* bits, uint8_t seq) {
+    return (bits[seq >> 6] >> (seq & 63)) & 1;
+}
+
+static void set_seq_bit(uint64_t* bits, uint8_t seq, bool value) {
+    if (value) {
+        bits[seq >> 6] |= (uint64_t)1 << (seq & 63);
+    } else {
+        bits[seq >> 6] &= ~((uint64_t)1 << (seq & 63));
+    }
+}
+
+// Store a payload in an I-frame buffer, allocating the buffer on first use
+static int store_slot(ax25_slot_t** slots, uint8_t seq, const uint8_t* data,
+                      uint16_t length, uint8_t pid) {
+    if (!*slots) {
+        *slots = calloc(AX25_MODULO_EXTENDED, sizeof(ax25_slot_t));
+        if (!*slots) {
+            return -1;
+        }
+    }
+    ax25_slot_t* slot = &(*slots)[seq];
+    slot->data = malloc(length > 0 ? length : 1);
+    if (!slot->data) {
+        return -1;
+    }
+    memcpy(slot->data, data, length);
+    slot->length = length;
+    slot->pid = pid;
+    slot->transmissions = 0;
+    return 0;
+}
+
+static void clear_slot(ax25_slot_t* slots, uint8_t seq) {
+    free(slots[seq].data);
+    slots[seq].data = NULL;
+    slots[seq].length = 0;
+}
+
+// Drop every buffered I-frame
+static void flush_slots(ax25_slot_t* slots) {
+    if (!slots) {
+        return;
+    }
+    for (int seq = 0; seq < AX25_MODULO_EXTENDED; seq++) {
+        clear_slot(slots, (uint8_t)seq);
+    }
+}
+
+// Move segments of the message being sent into the retransmit buffer while the window
+// has room. A segment that cannot be buffered drops the rest of the message; the peer
+// discards the partial message.
+static void buffer_segments(ax25_connection_t* conn) {
+    uint8_t info[AX25_MAX_INFO];
+    while (conn->tx_message &&
+           seq_distance(conn, conn->queue_seq, conn->ack_seq) < conn->window_size) {
+        uint16_t info_length = sizeof(info);
+        if (ax25_segment(conn->tx_message, conn->tx_message_length, AX25_PID_NONE,
+                         conn->tx_segment_info, conn->tx_segment, info,
+                         &info_length) != 0 ||
+            store_slot(&conn->tx_slots, conn->queue_seq, info, info_length,
+                       AX25_PID_SEGMENT) != 0) {
+            conn->tx_segment = conn->tx_segments;
+        } else {
+            conn->queue_seq = seq_next(conn, conn->queue_seq);
+            conn->tx_segment++;
+        }
+        if (conn->tx_segment == conn->tx_segments) {
+            free(conn->tx_message);
+            conn->tx_message = NULL;
+        }
+    }
+}
+
+// Reassembly pool: a link has at most one message in progress, and complete messages wait
+// in their slot for ax25_receive_message()
+static ax25_reassembly_t* link_reassembly(ax25_tnc_t* tnc,
+                                          const ax25_connection_t* conn) {
+    uint16_t entry = (uint16_t)(conn - tnc->connections);
+    for (int i = 0; i < AX25_REASSEMBLY_SLOTS; i++) {
+        if (tnc->reassembly[i].connection == entry && !tnc->reassembly[i].complete) {
+            return &tnc->reassembly[i];
         }
     }
     return NULL;
 }
 
-// Helper function to find an available connection slot
-static ax25_connection_t* find_free_connection(ax25_tnc_t* tnc) {
-    if (!tnc) {
-        return NULL;
+// Drop the message a link is reassembling and, with all, the ones waiting to be collected
+static void drop_reassembly(ax25_tnc_t* tnc, ax25_connection_t* conn, bool all) {
+    uint16_t entry = (uint16_t)(conn - tnc->connections);
+    for (int i = 0; i < AX25_REASSEMBLY_SLOTS; i++) {
+        ax25_reassembly_t* r = &tnc->reassembly[i];
+        if (r->connection == entry && (all || !r->complete)) {
+            ax25_reassembly_reset(r);
+            r->connection = AX25_NO_CONNECTION;
+        }
+    }
+    timer_stop(tnc, timer_id(tnc, conn, AX25_TIMER_REASSEMBLY));
+}
+
+// An in-sequence I-field: a segment goes to the link's message, anything else ends the
+// message in progress. Returns true if the I-field was a segment.
+static bool receive_segment(ax25_tnc_t* tnc, ax25_connection_t* conn, uint8_t pid,
+                            const uint8_t* info, uint16_t length) {
+    ax25_reassembly_t* r = link_reassembly(tnc, conn);
+    if (pid != AX25_PID_SEGMENT) {
+        if (r) {
+            drop_reassembly(tnc, conn, false);
+        }
+        return false;
     }
     
-    for (int i = 0; i < 16; i++) {
-        if (tnc->connections[i].state == AX25_STATE_DISCONNECTED) {
-            return &tnc->connections[i];
+    // A first segment takes a free slot; without one the message is lost
+    for (int i = 0; !r && length > 0 && (info[0] & AX25_SEGMENT_FIRST) &&
+                    i < AX25_REASSEMBLY_SLOTS; i++) {
+        if (tnc->reassembly[i].connection == AX25_NO_CONNECTION) {
+            r = &tnc->reassembly[i];
+            r->connection = (uint16_t)(conn - tnc->connections);
         }
     }
-    return NULL;
+    if (!r) {
+        return true;
+    }
+    
+    int result = ax25_reassembly_add(r, info, length);
+    if (result < 0) {
+        drop_reassembly(tnc, conn, false);
+    } else if (result > 0) {
+        timer_stop(tnc, timer_id(tnc, conn, AX25_TIMER_REASSEMBLY));
+    } else if (tnc->config.reassembly_timeout > 0) {
+        timer_start(tnc, timer_id(tnc, conn, AX25_TIMER_REASSEMBLY),
+                    tnc->config.reassembly_timeout);
+    }
+    return true;
+}
+
+// Bytes an I-frame adds to its information field on the air: two addresses, control,
+// PID, FCS and two flags
+#define IFRAME_OVERHEAD (2 * AX25_ADDR_LEN + 2 + 1 + 2 + 2)
+
+static uint32_t airtime_ms(const ax25_tnc_t* tnc, uint32_t bytes) {
+    if (tnc->config.bit_rate == 0) {
+        return 0;
+    }
+    return (uint32_t)(((uint64_t)bytes * 8 * 1000 + tnc->config.bit_rate - 1) /
+                      tnc->config.bit_rate);
+}
+
+// T1 for the frames now outstanding: the retransmission timeout of the measured round
+// trip plus the time the outstanding frames take to send, backed off after expiries
+static uint32_t t1_duration(const ax25_tnc_t* tnc, const ax25_connection_t* conn) {
+    uint64_t t1 = conn->rtt_valid ? (uint64_t)conn->srtt + 4 * (uint64_t)conn->rttvar
+                                  : conn->t1_initial;
+    uint32_t bytes = 0;
+    for (uint8_t seq = conn->ack_seq; conn->tx_slots && seq != conn->send_seq;
+         seq = seq_next(conn, seq)) {
+        bytes += conn->tx_slots[seq].length + IFRAME_OVERHEAD;
+    }
+    t1 = (t1 + airtime_ms(tnc, bytes)) << conn->backoff;
+    if (t1 > tnc->config.t1_max) {
+        t1 = tnc->config.t1_max;
+    }
+    if (t1 < tnc->config.t1_min) {
+        t1 = tnc->config.t1_min;
+    }
+    return (uint32_t)t1;
+}
+
+// Round-trip sample of a frame sent once (RFC 6298 smoothing, gains 1/8 and 1/4)
+static void rtt_sample(ax25_connection_t* conn, uint32_t rtt) {
+    if (!conn->rtt_valid) {
+        conn->srtt = rtt;
+        conn->rttvar = rtt / 2;
+        conn->rtt_valid = true;
+    } else {
+        uint32_t error = rtt > conn->srtt ? rtt - conn->srtt : conn->srtt - rtt;
+        conn->rttvar = (3 * conn->rttvar + error + 2) / 4;
+        conn->srtt = (7 * conn->srtt + rtt + 4) / 8;
+    }
+    conn->backoff = 0;
+}
+
+// T3 runs on a connected link while T1 does not, and restarts on every frame received
+static void start_t3(ax25_tnc_t* tnc, ax25_connection_t* conn) {
+    if (conn->state == AX25_STATE_CONNECTED && !conn->t1_running &&
+        tnc->config.t3_timeout > 0) {
+        timer_start(tnc, timer_id(tnc, conn, AX25_TIMER_T3), tnc->config.t3_timeout);
+    }
+}
+
+static void link_activity(ax25_tnc_t* tnc, ax25_connection_t* conn) {
+    if (timer_armed(tnc, conn, AX25_TIMER_T3)) {
+        start_t3(tnc, conn);
+    }
+}
+
+// T1 runs from the first unacknowledged frame (or poll) until everything is acknowledged
+static void start_t1(ax25_tnc_t* tnc, ax25_connection_t* conn) {
+    conn->t1_running = true;
+    if (!timer_armed(tnc, conn, AX25_TIMER_T1)) {
+        conn->timeout = t1_duration(tnc, conn);
+        timer_start(tnc, timer_id(tnc, conn, AX25_TIMER_T1), conn->timeout);
+    }
+    timer_stop(tnc, timer_id(tnc, conn, AX25_TIMER_T3));
+}
+
+// A frame queued behind the others delays their acknowledgement by its airtime
+static void extend_t1(ax25_tnc_t* tnc, ax25_connection_t* conn, uint32_t ms) {
+    const ax25_timer_t* t1 = &conn->timers[AX25_TIMER_T1];
+    uint64_t now = clock_now(tnc);
+    uint64_t remaining = t1->expires > now ? t1->expires - now : 0;
+    uint64_t delay = remaining + ms;
+    if (delay > tnc->config.t1_max) {
+        delay = remaining > tnc->config.t1_max ? remaining : tnc->config.t1_max;
+    }
+    timer_start(tnc, timer_id(tnc, conn, AX25_TIMER_T1), (uint32_t)delay);
+}
+
+static void stop_t1(ax25_tnc_t* tnc, ax25_connection_t* conn) {
+    conn->t1_running = false;
+    timer_stop(tnc, timer_id(tnc, conn, AX25_TIMER_T1));
+    start_t3(tnc, conn);
+}
+
+// (Re)start a link: sequence variables zero, buffers empty (SABM/SABME semantics)
+static void reset_link(ax25_tnc_t* tnc, ax25_connection_t* conn, bool extended) {
+    flush_slots(conn->tx_slots);
+    flush_slots(conn->rx_slots);
+    free(conn->tx_message);
+    conn->tx_message = NULL;
+    conn->send_seq = 0;
+    conn->recv_seq = 0;
+    conn->ack_seq = 0;
+    conn->queue_seq = 0;
+    conn->extended_mode = extended;
+    conn->window_size = link_window(tnc, extended);
+    conn->max_info = link_max_info(tnc);
+    conn->max_retries = tnc->config.max_retries;
+    conn->t1_initial = tnc->config.t1_timeout;
+    conn->xid_pending = false;
+    conn->retry_count = 0;
+    conn->peer_busy = false;
+    conn->reject_sent = false;
+    conn->poll_pending = false;
+    conn->rtt_timing = false;
+    conn->ack_pending = 0;
+    timer_stop(tnc, timer_id(tnc, conn, AX25_TIMER_T2));
+    stop_t1(tnc, conn);
+    drop_reassembly(tnc, conn, false);
+    // SREJ is an AX.25 v2.2 feature, and SABME is what identifies a v2.2 peer
+    conn->srej_enabled = extended && tnc->config.selective_reject;
+    memset(conn->srej_requested, 0, sizeof(conn->srej_requested));
+    memset(conn->srej_resend, 0, sizeof(conn->srej_resend));
+}
+
+// Return a connection entry to the free list together with its I-frame buffers
+static void release_connection(ax25_tnc_t* tnc, ax25_connection_t* conn) {
+    uint16_t entry = (uint16_t)(conn - tnc->connections);
+    for (int timer = 0; timer < AX25_TIMER_COUNT; timer++) {
+        timer_stop(tnc, timer_id(tnc, conn, timer));
+    }
+    index_remove(tnc, entry);
+    drop_reassembly(tnc, conn, true);
+    flush_slots(conn->tx_slots);
+    flush_slots(conn->rx_slots);
+    free(conn->tx_slots);
+    free(conn->rx_slots);
+    free(conn->tx_message);
+    memset(conn, 0, sizeof(ax25_connection_t));
+    conn->next_free = tnc->free_connection;
+    tnc->free_connection = entry;
+    tnc->num_connections--;
+}
+
+// Control field of an I or S frame. base is N(S) << 1 for an I-frame or the supervisory
+// type bits for an S frame; nr is V(R) except in SREJ.
+static void set_numbered_control(ax25_frame_t* frame, const ax25_connection_t* conn,
+                                 uint8_t base, uint8_t nr, bool pf) {
+    if (conn->extended_mode) {
+        frame->control = base;
+        frame->control_ext = (uint8_t)((nr << 1) | (pf ? 0x01 : 0x00));
+        frame->extended = true;
+    } else {
+        frame->control =
+            (uint8_t)(base | ((nr & 0x07) << 5) | (pf ? AX25_CTRL_PF : 0x00));
+    }
+}
+
+// Sequence fields and payload of a received I or S frame
+typedef struct {
+    uint8_t ns;
+    uint8_t nr;
+    bool pf;
+    uint8_t pid;
+    const uint8_t* info;
+    uint16_t info_length;
+} numbered_fields_t;
+
+// ax25_parse_frame() cannot know a link's modulus, so on a modulo-128 link the second
+// control byte of a frame it parsed is in pid (I-frame) or info[0] (S frame).
+static int decode_numbered(const ax25_connection_t* conn, const ax25_frame_t* frame,
+                           numbered_fields_t* fields) {
+    fields->pid = frame->pid;
+    fields->info = frame->info;
+    fields->info_length = frame->info_length;
+    if (!conn->extended_mode) {
+        fields->ns = (frame->control >> 1) & 0x07;
+        fields->nr = (frame->control >> 5) & 0x07;
+        fields->pf = (frame->control & AX25_CTRL_PF) != 0;
+        return 0;
+    }
+
+    uint8_t ext;
+    if (frame->extended) {
+        ext = frame->control_ext;
+    } else if ((frame->control & 0x01) == 0x00) {
+        if (frame->info_length < 1) {
+            return -1;
+        }
+        ext = frame->pid;
+        fields->pid = frame->info[0];
+        fields->info = frame->info + 1;
+        fields->info_length = frame->info_length - 1;
+    } else {
+        if (frame->info_length < 1) {
+            return -1;
+        }
+        ext = frame->info[0];
+        fields->info_length = 0;
+    }
+    fields->ns = (frame->control >> 1) & 0x7F;
+    fields->nr = (ext >> 1) & 0x7F;
+    fields->pf = (ext & 0x01) != 0;
+    return 0;
+}
+
+// Process a received N(R): free the acknowledged frames and advance V(A). T1 stops once
+// nothing is outstanding (which also answers a poll) and restarts on progress. Returns
+// -1 if N(R) acknowledges a frame that was never buffered.
+static int acknowledge(ax25_tnc_t* tnc, ax25_connection_t* conn, uint8_t nr) {
+    uint8_t acked = seq_distance(conn, nr, conn->ack_seq);
+    if (acked > seq_distance(conn, conn->queue_seq, conn->ack_seq)) {
+        return -1;
+    }
+    if (acked == 0) {
+        if (conn->t1_running && conn->ack_seq == conn->queue_seq) {
+            conn->retry_count = 0;
+            stop_t1(tnc, conn);
+        }
+        return 0;
+    }
+
+    // Frames queued for retransmission that the peer turns out to have need not go again
+    if (seq_distance(conn, conn->send_seq, conn->ack_seq) < acked) {
+        conn->send_seq = nr;
+    }
+    while (conn->ack_seq != nr) {
+        const ax25_slot_t* slot = &conn->tx_slots[conn->ack_seq];
+        if (conn->rtt_timing && conn->rtt_seq == conn->ack_seq) {
+            // Karn: the round trip of a retransmitted frame is ambiguous
+            conn->rtt_timing = false;
+            uint64_t elapsed = clock_now(tnc) - conn->rtt_start;
+            uint32_t airtime = airtime_ms(tnc, slot->length + IFRAME_OVERHEAD);
+            if (slot->transmissions == 1) {
+                rtt_sample(conn, elapsed > airtime ? (uint32_t)(elapsed - airtime) : 0);
+            }
+        }
+        clear_slot(conn->tx_slots, conn->ack_seq);
+        set_seq_bit(conn->srej_resend, conn->ack_seq, false);
+        conn->ack_seq = seq_next(conn, conn->ack_seq);
+    }
+    buffer_segments(conn); // The window opened
+    conn->retry_count = 0;
+    if (conn->ack_seq == conn->queue_seq) {
+        stop_t1(tnc, conn);
+    } else if (conn->t1_running) {
+        conn->timeout = t1_duration(tnc, conn);
+        timer_start(tnc, timer_id(tnc, conn, AX25_TIMER_T1), conn->timeout);
+    }
+    return 0;
+}
+
+// Queue I-frame seq from the retransmit buffer. 1 if the TX queue has no room for it.
+static int send_iframe(ax25_tnc_t* tnc, ax25_connection_t* conn, uint8_t seq) {
+    const ax25_slot_t* slot = &conn->tx_slots[seq];
+    ax25_frame_t frame;
+    if (ax25_create_frame(&frame, &conn->local_addr, &conn->remote_addr, 0, slot->pid,
+                          slot->data, slot->length) != 0) {
+        return -1;
+    }
+    set_numbered_control(&frame, conn, (uint8_t)(seq << 1), conn->recv_seq,
+                         conn->poll_pending);
+
+    uint8_t encoded[AX25_MAX_FRAME_BYTES];
+    uint16_t length = sizeof(encoded);
+    if (ax25_encode_frame(&frame, encoded, &length) != 0) {
+        return -1;
+    }
+    if (!ring_push(tnc->tx_data, AX25_TX_DATA_BYTES, &tnc->tx_data_ring, encoded,
+                   length)) {
+        return 1; // Stays in the retransmit buffer until the queue drains
+    }
+    conn->poll_pending = false;
+    if (conn->tx_slots[seq].transmissions < UINT8_MAX) {
+        conn->tx_slots[seq].transmissions++;
+    }
+    if (!conn->rtt_timing && conn->tx_slots[seq].transmissions == 1) {
+        conn->rtt_timing = true;
+        conn->rtt_seq = seq;
+        conn->rtt_start = clock_now(tnc);
+    }
+    timer_stop(tnc, timer_id(tnc, conn, AX25_TIMER_T2)); // N(R) goes with the frame
+    conn->ack_pending = 0;
+    if (timer_armed(tnc, conn, AX25_TIMER_T1)) {
+        extend_t1(tnc, conn, airtime_ms(tnc, slot->length + IFRAME_OVERHEAD));
+    }
+    start_t1(tnc, conn); // A new T1 already counts this frame as outstanding
+    return 0;
+}
+
+// Next frame due on a connection: SREJed frames first (oldest first), then V(S)
+static int send_next_iframe(ax25_tnc_t* tnc, ax25_connection_t* conn) {
+    for (uint8_t seq = conn->ack_seq; seq != conn->send_seq; seq = seq_next(conn, seq)) {
+        if (seq_bit(conn->srej_resend, seq)) {
+            int result = send_iframe(tnc, conn, seq);
+            if (result == 0) {
+                set_seq_bit(conn->srej_resend, seq, false);
+            }
+            return result;
+        }
+    }
+    // V(S) moves first so that T1, if it starts now, includes the frame's airtime
+    uint8_t seq = conn->send_seq;
+    conn->send_seq = seq_next(conn, seq);
+    int result = send_iframe(tnc, conn, seq);
+    if (result != 0) {
+        conn->send_seq = seq;
+    }
+    return result;
+}
+
+// AX.25 v2 command/response: the C bit is set in the destination SSID of a command and
+// in the source SSID of a response
+static void set_command(ax25_frame_t* frame, bool command) {
+    frame->addresses[0].ssid = (uint8_t)((frame->addresses[0].ssid & 0x7F) |
+                                         (command ? 0x80 : 0x00));
+    frame->addresses[1].ssid = (uint8_t)((frame->addresses[1].ssid & 0x7F) |
+                                         (command ? 0x00 : 0x80));
+}
+
+static bool is_command(const ax25_frame_t* frame) {
+    return (frame->addresses[0].ssid & 0x80) && !(frame->addresses[1].ssid & 0x80);
+}
+
+// Queue an S frame; every type but SREJ carries V(R) and so acknowledges received frames
+static int send_supervisory(ax25_tnc_t* tnc, ax25_connection_t* conn, uint8_t s_type,
+                            uint8_t nr, bool pf, bool command) {
+    ax25_frame_t frame;
+    if (ax25_create_frame(&frame, &conn->local_addr, &conn->remote_addr, s_type, 0, NULL,
+                          0) != 0) {
+        return -1;
+    }
+    set_numbered_control(&frame, conn, s_type, nr, pf);
+    set_command(&frame, command);
+    if (queue_frame(tnc, &frame) != 0) {
+        return -1;
+    }
+    if (s_type != AX25_CTRL_SREJ) {
+        timer_stop(tnc, timer_id(tnc, conn, AX25_TIMER_T2));
+        conn->ack_pending = 0;
+    }
+    return 0;
+}
+
+static bool has_srej_resend(const ax25_connection_t* conn) {
+    return conn->srej_resend[0] != 0 || conn->srej_resend[1] != 0;
+}
+
+// Send N(R) now: on the next I-frame if the window lets one go, else in an RR
+static int send_acknowledgement(ax25_tnc_t* tnc, ax25_connection_t* conn) {
+    const bool pending = conn->send_seq != conn->queue_seq || has_srej_resend(conn);
+    if (!conn->peer_busy && pending && send_next_iframe(tnc, conn) == 0) {
+        return 0;
+    }
+    return send_supervisory(tnc, conn, AX25_CTRL_RR, conn->recv_seq, false, false);
+}
+
+// V(R) advanced past an accepted frame: answer a poll at once, acknowledge once half the
+// window is waiting, otherwise within T2
+static int frame_accepted(ax25_tnc_t* tnc, ax25_connection_t* conn, bool poll) {
+    if (poll) {
+        return send_supervisory(tnc, conn, AX25_CTRL_RR, conn->recv_seq, true, false);
+    }
+    if (++conn->ack_pending >= (conn->window_size + 1) / 2) {
+        return send_acknowledgement(tnc, conn);
+    }
+    if (!timer_armed(tnc, conn, AX25_TIMER_T2)) {
+        timer_start(tnc, timer_id(tnc, conn, AX25_TIMER_T2), tnc->config.t2_timeout);
+    }
+    return 0;
+}
+
+// Send SREJ for every missing frame behind ns that has not been requested yet
+static void request_missing(ax25_tnc_t* tnc, ax25_connection_t* conn, uint8_t ns) {
+    for (uint8_t seq = conn->recv_seq; seq != ns; seq = seq_next(conn, seq)) {
+        if (conn->rx_slots[seq].data || seq_bit(conn->srej_requested, seq)) {
+            continue;
+        }
+        if (send_supervisory(tnc, conn, AX25_CTRL_SREJ, seq, false, false) != 0) {
+            return;
+        }
+        set_seq_bit(conn->srej_requested, seq, true);
+    }
 }
 
 // Connection functions
@@ -391,25 +1366,12 @@ int ax25_connect_extended(ax25_tnc_t* tnc, const ax25_address_t* remote_addr, bo
             return 0; // Already connecting
         }
     } else {
-        // Find free connection slot
-        conn = find_free_connection(tnc);
+        // Allocate a connection table entry
+        conn = alloc_connection(tnc, remote_addr, AX25_STATE_CONNECTING);
         if (!conn) {
-            return -1; // No free connection slots
+            return -1; // Connection table full
         }
-        
-        // Initialize connection
-        memset(conn, 0, sizeof(ax25_connection_t));
-        conn->local_addr = tnc->config.my_address;
-        conn->remote_addr = *remote_addr;
-        conn->state = AX25_STATE_CONNECTING;
-        conn->send_seq = 0;
-        conn->recv_seq = 0;
-        conn->window_size = tnc->config.window_size;
-        conn->timeout = tnc->config.t1_timeout;
-        conn->retry_count = 0;
-        conn->extended_mode = use_extended;
-        
-        tnc->num_connections++;
+        reset_link(tnc, conn, use_extended);
     }
     
     // Create SABM or SABME frame to initiate connection
@@ -420,9 +1382,11 @@ int ax25_connect_extended(ax25_tnc_t* tnc, const ax25_address_t* remote_addr, bo
         return -1;
     }
     
-    // Store frame for transmission
-    tnc->tx_frame = frame;
-    tnc->frame_ready = true;
+    // Store frame for transmission; T1 repeats it until UA arrives
+    if (queue_frame(tnc, &frame) != 0) {
+        return -1;
+    }
+    start_t1(tnc, conn);
     
     // Connection state will transition to CONNECTED when UA is received
     // This is handled by the caller or higher-level protocol
@@ -456,13 +1420,12 @@ int ax25_disconnect(ax25_tnc_t* tnc, const ax25_address_t* remote_addr) {
     }
     
     // Store frame for transmission
-    tnc->tx_frame = frame;
-    tnc->frame_ready = true;
+    if (queue_frame(tnc, &frame) != 0) {
+        return -1;
+    }
     
     // Clean up connection
-    conn->state = AX25_STATE_DISCONNECTED;
-    memset(conn, 0, sizeof(ax25_connection_t));
-    tnc->num_connections--;
+    release_connection(tnc, conn);
     
     return 0;
 }
@@ -488,36 +1451,93 @@ int ax25_send_data(ax25_tnc_t* tnc, const ax25_address_t* remote_addr, const uin
         return -1; // Connection not established
     }
     
-    // Create I-frame (Information frame) with sequence numbers
-    uint8_t control;
-    if (conn->extended_mode) {
-        // Modulo 128: 7-bit sequence numbers
-        control = AX25_CTRL_I | (conn->send_seq << 1) | ((conn->recv_seq & 0x07) << 5);
-    } else {
-        // Modulo 8: 3-bit sequence numbers
-        control = AX25_CTRL_I | ((conn->send_seq & 0x07) << 1) | ((conn->recv_seq & 0x07) << 5);
+    // Longer than the peer accepts (N1)
+    if (length > conn->max_info) {
+        return -1;
     }
     
-    ax25_frame_t frame;
-    if (ax25_create_frame(&frame, &conn->local_addr, &conn->remote_addr, 
-                          control, AX25_PID_NONE, data, length) != 0) {
+    // Window closed: window_size frames are buffered or awaiting acknowledgement, or a
+    // message still has segments to send
+    if (seq_distance(conn, conn->queue_seq, conn->ack_seq) >= conn->window_size ||
+        conn->tx_message) {
         return -1;
     }
     
-    // Store frame for transmission
-    tnc->tx_frame = frame;
-    tnc->frame_ready = true;
+    // Keep a copy in the retransmit buffer until N(R) acknowledges it
+    if (store_slot(&conn->tx_slots, conn->queue_seq, data, length, AX25_PID_NONE) != 0) {
+        return -1;
+    }
+    conn->queue_seq = seq_next(conn, conn->queue_seq);
     
-    // Update send sequence number (modulo 8 or 128)
-    if (conn->extended_mode) {
-        conn->send_seq = (conn->send_seq + 1) % 128;
-    } else {
-        conn->send_seq = (conn->send_seq + 1) % 8;
+    // Queue now if the TX queue has room; otherwise it waits in the retransmit buffer
+    if (ax25_transmit_pending(tnc) < 0) {
+        return -1;
+    }
+    
+    return 0;
+}
+
+int ax25_send_message(ax25_tnc_t* tnc, const ax25_address_t* remote_addr,
+                      const uint8_t* data, uint32_t length) {
+    if (!tnc || !remote_addr || !data) {
+        return -1;
+    }
+    
+    ax25_connection_t* conn = find_connection(tnc, remote_addr);
+    if (!conn || conn->state != AX25_STATE_CONNECTED) {
+        return -1;
+    }
+    if (length <= conn->max_info) {
+        return ax25_send_data(tnc, remote_addr, data, (uint16_t)length);
+    }
+    
+    // One message at a time; the segments the window cannot take yet wait in the copy
+    int count = ax25_segment_count(length, conn->max_info);
+    if (count < 0 || conn->tx_message) {
+        return -1;
+    }
+    conn->tx_message = malloc(length);
+    if (!conn->tx_message) {
+        return -1;
+    }
+    memcpy(conn->tx_message, data, length);
+    conn->tx_message_length = length;
+    conn->tx_segment_info = conn->max_info;
+    conn->tx_segment = 0;
+    conn->tx_segments = (uint8_t)count;
+    buffer_segments(conn);
+    
+    if (ax25_transmit_pending(tnc) < 0) {
+        return -1;
     }
     
     return 0;
 }
 
+int ax25_receive_message(ax25_tnc_t* tnc, ax25_address_t* remote_addr, uint8_t* data,
+                         uint32_t* length) {
+    if (!tnc || !remote_addr || !data || !length) {
+        return -1;
+    }
+    
+    for (int i = 0; i < AX25_REASSEMBLY_SLOTS; i++) {
+        ax25_reassembly_t* r = &tnc->reassembly[i];
+        if (r->connection == AX25_NO_CONNECTION || !r->complete) {
+            continue;
+        }
+        if (r->length > *length) {
+            return -1; // Buffer too small
+        }
+        memcpy(data, r->data, r->length);
+        *length = r->length;
+        *remote_addr = tnc->connections[r->connection].remote_addr;
+        ax25_reassembly_reset(r);
+        r->connection = AX25_NO_CONNECTION;
+        return 0;
+    }
+    return -1;
+}
+
 int ax25_receive_data(ax25_tnc_t* tnc, ax25_address_t* remote_addr, uint8_t* data,
                       uint16_t* length) {
     if (!tnc || !remote_addr || !data || !length) {
@@ -546,48 +1566,69 @@ int ax25_receive_data(ax25_tnc_t* tnc, ax25_address_t* remote_addr, uint8_t* dat
     ax25_connection_t* conn = find_connection(tnc, remote_addr);
     if (!conn) {
         // Auto-create connection if not found (for incoming connections)
-        conn = find_free_connection(tnc);
-        if (conn) {
-            memset(conn, 0, sizeof(ax25_connection_t));
-            conn->local_addr = tnc->config.my_address;
-            conn->remote_addr = *remote_addr;
-            conn->state = AX25_STATE_CONNECTED;
-            conn->window_size = tnc->config.window_size;
-            conn->extended_mode = false; // Default to modulo 8 for auto-created connections
-            tnc->num_connections++;
-        } else {
-            return -1; // No free connection slots
+        conn = alloc_connection(tnc, remote_addr, AX25_STATE_CONNECTED);
+        if (!conn) {
+            return -1; // Connection table full
         }
+        reset_link(tnc, conn, false); // Default to modulo 8 for auto-created connections
     }
     
-    // Extract sequence numbers from control field
-    uint8_t recv_seq;
-    if (conn->extended_mode) {
-        recv_seq = (frame->control >> 5) & 0x7F; // 7 bits for modulo 128
-    } else {
-        recv_seq = (frame->control >> 5) & 0x07; // 3 bits for modulo 8
+    numbered_fields_t fields;
+    if (decode_numbered(conn, frame, &fields) != 0) {
+        return -1;
     }
-    // send_seq is in the frame but we don't need to use it for receive
-    // (it's the remote station's send sequence number)
+    link_activity(tnc, conn);
     
-    // Update receive sequence number
-    if (conn->extended_mode) {
-        if (recv_seq == ((conn->recv_seq + 1) % 128)) {
-            conn->recv_seq = recv_seq;
+    // N(R) acknowledges our own I-frames
+    if (acknowledge(tnc, conn, fields.nr) != 0) {
+        return -1;
+    }
+    
+    // Out of sequence with SREJ: keep frames inside the window and request only the
+    // missing ones; duplicates and frames beyond the window are dropped
+    if (fields.ns != conn->recv_seq && conn->srej_enabled) {
+        tnc->frame_ready = false;
+        if (seq_distance(conn, fields.ns, conn->recv_seq) >= conn->window_size) {
+            if (fields.pf) {
+                // Tell a poller V(R)
+                ax25_send_supervisory(tnc, remote_addr, AX25_CTRL_RR);
+            }
+            return -1;
         }
-    } else {
-        if (recv_seq == ((conn->recv_seq + 1) % 8)) {
-            conn->recv_seq = recv_seq;
+        if ((!conn->rx_slots || !conn->rx_slots[fields.ns].data) &&
+            store_slot(&conn->rx_slots, fields.ns, fields.info, fields.info_length,
+                       fields.pid) != 0) {
+            return -1;
+        }
+        request_missing(tnc, conn, fields.ns);
+        return -1;
+    }
+    
+    // Out of sequence: discard and ask for a retransmission from V(R), once per gap
+    // unless the peer polls
+    if (fields.ns != conn->recv_seq) {
+        tnc->frame_ready = false;
+        if (!conn->reject_sent || fields.pf) {
+            conn->reject_sent = true;
+            ax25_send_supervisory(tnc, remote_addr, AX25_CTRL_REJ);
         }
+        return -1;
     }
     
-    // Copy data
-    if (frame->info_length > *length) {
+    // Copy data; a segment goes to its message instead
+    if (receive_segment(tnc, conn, fields.pid, fields.info, fields.info_length)) {
+        *length = 0;
+    } else if (fields.info_length > *length) {
         return -1; // Buffer too small
+    } else {
+        memcpy(data, fields.info, fields.info_length);
+        *length = fields.info_length;
     }
+    set_seq_bit(conn->srej_requested, conn->recv_seq, false);
+    conn->recv_seq = seq_next(conn, conn->recv_seq);
+    conn->reject_sent = false;
     
-    memcpy(data, frame->info, frame->info_length);
-    *length = frame->info_length;
+    frame_accepted(tnc, conn, fields.pf);
     
     // Mark frame as processed
     tnc->frame_ready = false;
@@ -618,8 +1659,9 @@ int ax25_send_ui_frame(ax25_tnc_t* tnc, const ax25_address_t* src, const ax25_ad
         }
     }
     
-    tnc->tx_frame = frame;
-    tnc->frame_ready = true;
+    if (queue_frame(tnc, &frame) != 0) {
+        return -1;
+    }
     
     return 0;
 }
@@ -667,6 +1709,116 @@ int ax25_receive_ui_frame(ax25_tnc_t* tnc, ax25_address_t* src, ax25_address_t*
     return 0;
 }
 
+// Segmenter: the first segment holds N1 - 2 octets of the message after its header and
+// PID, every later one N1 - 1 after its header
+AX25_EXPORT int ax25_segment_count(uint32_t length, uint16_t max_info) {
+    if (max_info > AX25_MAX_INFO) {
+        max_info = AX25_MAX_INFO;
+    }
+    if (length == 0 || max_info < 3) {
+        return -1;
+    }
+    uint32_t first = max_info - 2u;
+    uint32_t rest = max_info - 1u;
+    uint32_t count = length <= first ? 1 : 1 + (length - first + rest - 1) / rest;
+    return count > AX25_MAX_SEGMENTS ? -1 : (int)count;
+}
+
+AX25_EXPORT int ax25_segment(const uint8_t* data, uint32_t length, uint8_t pid,
+                             uint16_t max_info, int index, uint8_t* info,
+                             uint16_t* info_length) {
+    int count = ax25_segment_count(length, max_info);
+    if (!data || !info || !info_length || count < 0 || index < 0 || index >= count) {
+        return -1;
+    }
+    if (max_info > AX25_MAX_INFO) {
+        max_info = AX25_MAX_INFO;
+    }
+    
+    uint32_t first = max_info - 2u;
+    uint32_t rest = max_info - 1u;
+    uint32_t offset = index == 0 ? 0 : first + (uint32_t)(index - 1) * rest;
+    uint32_t chunk = index == 0 ? first : rest;
+    if (chunk > length - offset) {
+        chunk = length - offset;
+    }
+    uint16_t header = index == 0 ? 2 : 1;
+    if (header + chunk > *info_length) {
+        return -1;
+    }
+    
+    info[0] = (uint8_t)((index == 0 ? AX25_SEGMENT_FIRST : 0) | (count - 1 - index));
+    if (index == 0) {
+        info[1] = pid;
+    }
+    memcpy(&info[header], &data[offset], chunk);
+    *info_length = (uint16_t)(header + chunk);
+    return 0;
+}
+
+// Reassembler: a first segment starts a message over, any other must be the next one
+AX25_EXPORT int ax25_reassembly_add(ax25_reassembly_t* reassembly, const uint8_t* info,
+                                    uint16_t length) {
+    if (!reassembly || !info) {
+        return -1;
+    }
+    
+    uint8_t remaining = length > 0 ? info[0] & AX25_SEGMENT_REMAINING : 0;
+    uint16_t header = length > 0 && (info[0] & AX25_SEGMENT_FIRST) ? 2 : 1;
+    if (length < header || (header == 1 && (!reassembly->active || reassembly->complete ||
+                                            remaining + 1 != reassembly->remaining))) {
+        reassembly->active = false;
+        reassembly->complete = false;
+        reassembly->length = 0;
+        return -1;
+    }
+    if (header == 2) {
+        reassembly->pid = info[1];
+        reassembly->active = true;
+        reassembly->complete = false;
+        reassembly->length = 0;
+    }
+    reassembly->remaining = remaining;
+    
+    // Room for the rest of the message at this segment's size, allocated once
+    uint32_t needed = reassembly->length + (length - header);
+    if (needed > reassembly->capacity) {
+        uint32_t capacity = reassembly->length + (uint32_t)(remaining + 1) * length;
+        if (capacity > AX25_MAX_MESSAGE) {
+            capacity = AX25_MAX_MESSAGE;
+        }
+        uint8_t* data = needed <= capacity ? realloc(reassembly->data, capacity) : NULL;
+        if (!data) {
+            reassembly->active = false;
+            reassembly->length = 0;
+            return -1;
+        }
+        reassembly->data = data;
+        reassembly->capacity = capacity;
+    }
+    memcpy(&reassembly->data[reassembly->length], &info[header], length - header);
+    reassembly->length = needed;
+    
+    if (remaining == 0) {
+        reassembly->complete = true;
+        return 1;
+    }
+    return 0;
+}
+
+AX25_EXPORT void ax25_reassembly_reset(ax25_reassembly_t* reassembly) {
+    if (!reassembly) {
+        return;
+    }
+    free(reassembly->data);
+    reassembly->data = NULL;
+    reassembly->length = 0;
+    reassembly->capacity = 0;
+    reassembly->remaining = 0;
+    reassembly->active = false;
+    reassembly->complete = false;
+}
+
 // FCS Functions
 uint16_t ax25_calculate_fcs(const uint8_t* data, uint16_t length) {
     if (!data) {
@@ -808,11 +1960,12 @@ AX25_EXPORT int ax25_encode_xid_params(const ax25_xid_frame_t* xid_data, uint8_t
     }
     buffer[pos++] = xid_data->format_id;
     
-    // Group identifier
-    if (pos >= *length) {
+    // Group identifier and group length, filled in once the parameters are encoded
+    if (pos + 3 > *length) {
         return -1;
     }
     buffer[pos++] = xid_data->group_id;
+    pos += 2;
     
     // Encode parameters
     for (uint8_t i = 0; i < xid_data->num_params && i < 8; i++) {
@@ -840,6 +1993,8 @@ AX25_EXPORT int ax25_encode_xid_params(const ax25_xid_frame_t* xid_data, uint8_t
         }
     }
     
+    buffer[2] = (uint8_t)((pos - 4) >> 8);
+    buffer[3] = (uint8_t)(pos - 4);
     *length = pos;
     return 0;
 }
@@ -858,8 +2013,19 @@ AX25_EXPORT int ax25_decode_xid_params(const uint8_t* buffer, uint16_t length, a
     // Group identifier
     xid_data->group_id = buffer[pos++];
     
-    // Decode parameters
+    // Group length: the parameters end there
     xid_data->num_params = 0;
+    if (length < 4) {
+        return 0; // No parameters
+    }
+    uint16_t group_length = (uint16_t)((buffer[2] << 8) | buffer[3]);
+    pos += 2;
+    if (group_length > length - pos) {
+        return -1;
+    }
+    length = (uint16_t)(pos + group_length);
+    
+    // Decode parameters
     while (pos < length && xid_data->num_params < 8) {
         if (pos + 2 > length) {
             break; // Need at least type and length
@@ -902,15 +2068,12 @@ AX25_EXPORT int ax25_create_xid_frame(ax25_frame_t* frame, const ax25_address_t*
         return -1;
     }
     
-    // Create frame with XID control field
+    // Create frame with XID control field; command and response differ in the C bits
     uint8_t control = poll ? AX25_CTRL_XID_PF : AX25_CTRL_XID;
-    if (xid_data->is_response) {
-        control |= 0x01; // Set response bit
-    }
-    
     if (ax25_create_frame(frame, src, dst, control, AX25_PID_NONE, xid_buffer, xid_length) != 0) {
         return -1;
     }
+    set_command(frame, !xid_data->is_response);
     
     return 0;
 }
@@ -928,7 +2091,7 @@ AX25_EXPORT int ax25_parse_xid_frame(const ax25_frame_t* frame, ax25_xid_frame_t
     }
     
     // Check if it's a response
-    xid_data->is_response = (frame->control & 0x01) != 0;
+    xid_data->is_response = !is_command(frame);
     
     // Decode XID parameters
     if (ax25_decode_xid_params(frame->info, frame->info_length, xid_data) != 0) {
@@ -990,8 +2153,9 @@ AX25_EXPORT int ax25_send_xid(ax25_tnc_t* tnc, const ax25_address_t* remote_addr
     }
     
     // Store frame for transmission
-    tnc->tx_frame = frame;
-    tnc->frame_ready = true;
+    if (queue_frame(tnc, &frame) != 0) {
+        return -1;
+    }
     
     return 0;
 }
@@ -1032,6 +2196,101 @@ AX25_EXPORT int ax25_receive_xid(ax25_tnc_t* tnc, ax25_address_t* remote_addr, a
     return 0;
 }
 
+// XID negotiation of a link: parameters are big-endian integers in as few octets as
+// the value needs, up to 4
+static void xid_put(ax25_xid_frame_t* xid, uint8_t type, uint32_t value) {
+    uint8_t bytes[4];
+    uint8_t length = 1;
+    while (length < 4 && (value >> (8 * length)) != 0) {
+        length++;
+    }
+    for (uint8_t i = 0; i < length; i++) {
+        bytes[i] = (uint8_t)(value >> (8 * (length - 1 - i)));
+    }
+    ax25_add_xid_param(xid, type, bytes, length);
+}
+
+static bool xid_value(const ax25_xid_frame_t* xid, uint8_t type, uint32_t* value) {
+    uint8_t bytes[16];
+    uint8_t length = sizeof(bytes);
+    if (ax25_get_xid_param(xid, type, bytes, &length) != 0 || length < 1 || length > 4) {
+        return false;
+    }
+    *value = 0;
+    for (uint8_t i = 0; i < length; i++) {
+        *value = (*value << 8) | bytes[i];
+    }
+    return true;
+}
+
+// Send the link's k, N1 (in bits), T1 and N2: offered in a command, agreed in a response
+static int send_link_xid(ax25_tnc_t* tnc, ax25_connection_t* conn, bool response,
+                         bool pf) {
+    ax25_xid_frame_t xid;
+    memset(&xid, 0, sizeof(xid));
+    xid.format_id = AX25_XID_FMT_EXTENDED;
+    xid.group_id = AX25_XID_GROUP_PARAMS;
+    xid.is_response = response;
+    xid_put(&xid, AX25_XID_PARAM_IFIELD_RX, (uint32_t)conn->max_info * 8);
+    xid_put(&xid, AX25_XID_PARAM_WINDOW_RX, conn->window_size);
+    xid_put(&xid, AX25_XID_PARAM_T1_TIMEOUT, conn->t1_initial);
+    xid_put(&xid, AX25_XID_PARAM_RETRY_COUNT, conn->max_retries);
+    
+    ax25_frame_t frame;
+    if (ax25_create_xid_frame(&frame, &conn->local_addr, &conn->remote_addr, &xid,
+                              pf) != 0) {
+        return -1;
+    }
+    return queue_frame(tnc, &frame);
+}
+
+// Settle on what both ends support: the smaller k and N1, the larger T1 and N2.
+// Parameters the peer leaves out keep their values, as do all of them in an XID that is
+// not a v2.2 parameter negotiation.
+static void apply_link_xid(ax25_connection_t* conn, const ax25_xid_frame_t* xid) {
+    uint32_t value;
+    if (xid->format_id != AX25_XID_FMT_EXTENDED ||
+        xid->group_id != AX25_XID_GROUP_PARAMS) {
+        return;
+    }
+    if (xid_value(xid, AX25_XID_PARAM_WINDOW_RX, &value) && value >= 1 &&
+        value < conn->window_size) {
+        conn->window_size = (uint8_t)value;
+    }
+    if (xid_value(xid, AX25_XID_PARAM_IFIELD_RX, &value) && value >= 8 &&
+        value / 8 < conn->max_info) {
+        conn->max_info = (uint16_t)(value / 8);
+    }
+    if (xid_value(xid, AX25_XID_PARAM_T1_TIMEOUT, &value) && value > conn->t1_initial) {
+        conn->t1_initial = value;
+    }
+    if (xid_value(xid, AX25_XID_PARAM_RETRY_COUNT, &value) && value > conn->max_retries &&
+        value <= 0xFF) {
+        conn->max_retries = (uint8_t)value;
+    }
+}
+
+// XID on a link: a command is answered with the agreed values, the response to our own
+// command settles them
+static int link_xid_received(ax25_tnc_t* tnc, ax25_connection_t* conn,
+                             const ax25_frame_t* frame) {
+    ax25_xid_frame_t xid;
+    if (!conn || conn->state != AX25_STATE_CONNECTED ||
+        ax25_parse_xid_frame(frame, &xid) != 0) {
+        return -1;
+    }
+    if (!xid.is_response) {
+        apply_link_xid(conn, &xid);
+        return send_link_xid(tnc, conn, true, (frame->control & AX25_CTRL_PF) != 0);
+    }
+    if (!conn->xid_pending) {
+        return 0; // Unsolicited
+    }
+    conn->xid_pending = false;
+    apply_link_xid(conn, &xid);
+    return 0;
+}
+
 // Process received frame (handles all frame types including supervisory)
 int ax25_process_frame(ax25_tnc_t* tnc, const ax25_frame_t* frame) {
     if (!tnc || !frame || !frame->valid) {
@@ -1049,116 +2308,133 @@ int ax25_process_frame(ax25_tnc_t* tnc, const ax25_frame_t* frame) {
     
     // Find or create connection
     ax25_connection_t* conn = find_connection(tnc, &remote_addr);
+    if (conn) {
+        link_activity(tnc, conn);
+    }
     
     // Handle unnumbered frames
     if (frame_type == 0x03) {
         uint8_t u_type = control & 0xEF; // Mask P/F bit
         
         if (u_type == AX25_CTRL_SABM || u_type == AX25_CTRL_SABME) {
-            // Connection request
+            // Connection request; on an existing link this is a reset
             if (!conn) {
-                conn = find_free_connection(tnc);
-                if (conn) {
-                    memset(conn, 0, sizeof(ax25_connection_t));
-                    conn->local_addr = tnc->config.my_address;
-                    conn->remote_addr = remote_addr;
-                    conn->state = AX25_STATE_CONNECTED;
-                    conn->window_size = tnc->config.window_size;
-                    conn->extended_mode = (u_type == AX25_CTRL_SABME);
-                    tnc->num_connections++;
-                }
+                conn = alloc_connection(tnc, &remote_addr, AX25_STATE_CONNECTED);
             }
-            // Respond with UA
+            if (conn) {
+                conn->state = AX25_STATE_CONNECTED;
+                reset_link(tnc, conn, u_type == AX25_CTRL_SABME);
+            }
+            // Respond with UA, or DM when the connection table is full
             ax25_frame_t ua_frame;
             if (ax25_create_frame(&ua_frame, &tnc->config.my_address, &remote_addr,
-                                  AX25_CTRL_UA, 0, NULL, 0) == 0) {
-                tnc->tx_frame = ua_frame;
-                tnc->frame_ready = true;
+                                  conn ? AX25_CTRL_UA : AX25_CTRL_DM, 0, NULL, 0) == 0) {
+                queue_frame(tnc, &ua_frame);
             }
-            return 0;
+            return conn ? 0 : -1;
         } else if (u_type == AX25_CTRL_UA) {
             // Connection acknowledgment
             if (conn && conn->state == AX25_STATE_CONNECTING) {
                 conn->state = AX25_STATE_CONNECTED;
+                conn->retry_count = 0;
+                stop_t1(tnc, conn);
+                // A v2.2 peer: agree on the link parameters
+                if (conn->extended_mode && tnc->config.xid_negotiation) {
+                    if (send_link_xid(tnc, conn, false, true) != 0) {
+                        return -1;
+                    }
+                    conn->xid_pending = true;
+                }
             }
             return 0;
         } else if (u_type == AX25_CTRL_DISC) {
             // Disconnect request
             if (conn) {
-                conn->state = AX25_STATE_DISCONNECTED;
-                memset(conn, 0, sizeof(ax25_connection_t));
-                tnc->num_connections--;
+                release_connection(tnc, conn);
             }
             // Respond with UA
             ax25_frame_t ua_frame;
             if (ax25_create_frame(&ua_frame, &tnc->config.my_address, &remote_addr,
                                   AX25_CTRL_UA, 0, NULL, 0) == 0) {
-                tnc->tx_frame = ua_frame;
-                tnc->frame_ready = true;
+                queue_frame(tnc, &ua_frame);
             }
             return 0;
         } else if (u_type == AX25_CTRL_DM) {
             // Disconnected mode
             if (conn) {
-                conn->state = AX25_STATE_DISCONNECTED;
+                release_connection(tnc, conn);
             }
             return 0;
+        } else if (u_type == AX25_CTRL_XID) {
+            return link_xid_received(tnc, conn, frame);
         } else if (u_type == AX25_CTRL_FRMR) {
+            // A peer without XID support rejects our command: keep the configured values
+            if (conn && conn->xid_pending) {
+                conn->xid_pending = false;
+                return 0;
+            }
             // Frame reject - protocol error
             if (conn) {
                 // Handle FRMR - may need to reset connection
-                conn->state = AX25_STATE_DISCONNECTED;
+                release_connection(tnc, conn);
             }
             return -1; // Protocol error
         }
     }
     
     // Handle supervisory frames
-    if (frame_type == 0x01 && conn) {
+    if (frame_type == 0x01 && conn && conn->state == AX25_STATE_CONNECTED) {
         uint8_t s_type = control & 0x0F;
-        uint8_t n_r = (control >> 5) & 0x07;
+        numbered_fields_t fields;
+        if (decode_numbered(conn, frame, &fields) != 0) {
+            return -1;
+        }
+        
+        if (s_type == AX25_CTRL_SREJ) {
+            // Selective Reject (v2.2): resend frame N(R) only. Frames before it count as
+            // acknowledged only when F is set.
+            if (fields.pf && acknowledge(tnc, conn, fields.nr) != 0) {
+                return -1;
+            }
+            if (seq_distance(conn, fields.nr, conn->ack_seq) >=
+                seq_distance(conn, conn->send_seq, conn->ack_seq)) {
+                return -1; // Never sent
+            }
+            set_seq_bit(conn->srej_resend, fields.nr, true);
+            conn->peer_busy = false;
+            return ax25_transmit_pending(tnc) < 0 ? -1 : 0;
+        }
+        
+        if (acknowledge(tnc, conn, fields.nr) != 0) {
+            return -1; // N(R) outside the window
+        }
         
         if (s_type == AX25_CTRL_RR) {
             // Receive Ready - acknowledgment
-            if (conn->extended_mode) {
-                conn->send_seq = n_r % 128;
-            } else {
-                conn->send_seq = n_r % 8;
-            }
-            return 0;
+            conn->peer_busy = false;
         } else if (s_type == AX25_CTRL_RNR) {
-            // Receive Not Ready - flow control
-            if (conn->extended_mode) {
-                conn->send_seq = n_r % 128;
-            } else {
-                conn->send_seq = n_r % 8;
-            }
-            // Stop sending until RR received
-            return 0;
+            // Receive Not Ready - stop sending until RR received
+            conn->peer_busy = true;
         } else if (s_type == AX25_CTRL_REJ) {
-            // Reject - retransmit from sequence number
-            if (conn->extended_mode) {
-                conn->send_seq = n_r % 128;
-            } else {
-                conn->send_seq = n_r % 8;
-            }
-            // Trigger retransmission
-            return 0;
-        } else if (s_type == AX25_CTRL_SREJ) {
-            // Selective Reject (v2.2) - retransmit specific frame
-            if (conn->extended_mode) {
-                conn->send_seq = n_r % 128;
-            } else {
-                conn->send_seq = n_r % 8;
-            }
-            // Trigger selective retransmission
-            return 0;
+            // Reject - go back to N(R) and retransmit everything from there
+            conn->peer_busy = false;
+            conn->send_seq = conn->ack_seq;
+            memset(conn->srej_resend, 0, sizeof(conn->srej_resend));
         }
+        if (fields.pf && is_command(frame) &&
+            send_supervisory(tnc, conn, AX25_CTRL_RR, conn->recv_seq, true, false) != 0) {
+            return -1; // Poll not answered
+        }
+        return ax25_transmit_pending(tnc) < 0 ? -1 : 0;
     }
     
-    // Handle information frames
-    if (frame_type == 0x00) {
-        // I-frame handling is done in ax25_receive_data
+    // Handle information frames: N(R) here, the payload in ax25_receive_data
+    if ((control & 0x01) == 0x00 && conn && conn->state == AX25_STATE_CONNECTED) {
+        numbered_fields_t fields;
+        if (decode_numbered(conn, frame, &fields) != 0 ||
+            acknowledge(tnc, conn, fields.nr) != 0) {
+            return -1;
+        }
         return 0;
     }
     
@@ -1176,22 +2452,7 @@ int ax25_send_supervisory(ax25_tnc_t* tnc, const ax25_address_t* remote_addr, ui
         return -1;
     }
     
-    uint8_t control = ctrl_type;
-    if (conn->extended_mode) {
-        control |= ((conn->recv_seq & 0x07) << 5); // N(R) in bits 5-7 for extended
-    } else {
-        control |= ((conn->recv_seq & 0x07) << 5); // N(R) in bits 5-7
-    }
-    
-    ax25_frame_t frame;
-    if (ax25_create_frame(&frame, &conn->local_addr, remote_addr, 
-                          control, 0, NULL, 0) != 0) {
-        return -1;
-    }
-    
-    tnc->tx_frame = frame;
-    tnc->frame_ready = true;
-    return 0;
+    return send_supervisory(tnc, conn, ctrl_type & 0x0F, conn->recv_seq, false, false);
 }
 
 // Send FRMR (Frame Reject)
@@ -1214,8 +2475,315 @@ int ax25_send_frmr(ax25_tnc_t* tnc, const ax25_address_t* remote_addr, uint8_t r
         return -1;
     }
     
-    tnc->tx_frame = frame;
-    tnc->frame_ready = true;
+    if (queue_frame(tnc, &frame) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+// Move the I-frames the windows allow into the TX queue until it is full, one frame per
+// connection in turn so one bulk transfer cannot starve the other links
+int ax25_transmit_pending(ax25_tnc_t* tnc) {
+    if (!tnc) {
+        return -1;
+    }
+    
+    int queued = 0;
+    int idle = 0;
+    while (idle < tnc->connection_capacity) {
+        if (tnc->service_index >= tnc->connection_capacity) {
+            tnc->service_index = 0;
+        }
+        ax25_connection_t* conn = &tnc->connections[tnc->service_index++];
+        if (conn->state != AX25_STATE_CONNECTED || conn->peer_busy ||
+            (conn->send_seq == conn->queue_seq && !has_srej_resend(conn))) {
+            idle++;
+            continue;
+        }
+        int result = send_next_iframe(tnc, conn);
+        if (result < 0) {
+            return -1;
+        }
+        if (result > 0) {
+            break; // TX queue full
+        }
+        queued++;
+        idle = 0;
+    }
+    return queued;
+}
+
+// Take the next frame from the TX queue, control ring first
+int ax25_tx_dequeue(ax25_tnc_t* tnc, uint8_t* data, uint16_t* length) {
+    if (!tnc || !data || !length) {
+        return -1;
+    }
+    
+    if (tnc->tx_control_ring.frames > 0) {
+        if (ring_front_length(tnc->tx_control, AX25_TX_CONTROL_BYTES,
+                              &tnc->tx_control_ring) > *length) {
+            return -1; // Buffer too small
+        }
+        *length = ring_front_length(tnc->tx_control, AX25_TX_CONTROL_BYTES,
+                                    &tnc->tx_control_ring);
+        ring_pop(tnc->tx_control, AX25_TX_CONTROL_BYTES, &tnc->tx_control_ring, data);
+        return 0;
+    }
+    
+    if (tnc->tx_data_ring.frames == 0) {
+        ax25_transmit_pending(tnc);
+        if (tnc->tx_data_ring.frames == 0) {
+            return -1; // Nothing to send
+        }
+    }
+    uint16_t front = ring_front_length(tnc->tx_data, AX25_TX_DATA_BYTES,
+                                       &tnc->tx_data_ring);
+    if (front > *length) {
+        return -1; // Buffer too small
+    }
+    *length = front;
+    ring_pop(tnc->tx_data, AX25_TX_DATA_BYTES, &tnc->tx_data_ring, data);
+    ax25_transmit_pending(tnc); // Refill from the retransmit buffers
+    return 0;
+}
+
+// Pack queued frames back to back for one transmit opportunity
+int ax25_tx_drain(ax25_tnc_t* tnc, uint8_t* buffer, uint32_t size, uint16_t* lengths,
+                  int max_frames) {
+    if (!tnc || !buffer || !lengths) {
+        return -1;
+    }
+    
+    int count = 0;
+    uint32_t offset = 0;
+    while (count < max_frames && offset < size) {
+        uint32_t room = size - offset;
+        uint16_t length = room > 0xFFFF ? 0xFFFF : (uint16_t)room;
+        if (ax25_tx_dequeue(tnc, buffer + offset, &length) != 0) {
+            break; // Empty, or the next frame does not fit
+        }
+        lengths[count++] = length;
+        offset += length;
+    }
+    return count;
+}
+
+int ax25_tx_queued(const ax25_tnc_t* tnc) {
+    if (!tnc) {
+        return -1;
+    }
+    return tnc->tx_control_ring.frames + tnc->tx_data_ring.frames;
+}
+
+// Number of payloads ax25_send_data() accepts before the window closes
+int ax25_window_space(ax25_tnc_t* tnc, const ax25_address_t* remote_addr) {
+    if (!tnc || !remote_addr) {
+        return -1;
+    }
+    
+    ax25_connection_t* conn = find_connection(tnc, remote_addr);
+    if (!conn || conn->state != AX25_STATE_CONNECTED) {
+        return -1;
+    }
+    if (conn->tx_message) {
+        return 0; // A message's remaining segments come first
+    }
+    return conn->window_size - seq_distance(conn, conn->queue_seq, conn->ack_seq);
+}
+
+int ax25_max_info(ax25_tnc_t* tnc, const ax25_address_t* remote_addr) {
+    if (!tnc || !remote_addr) {
+        return -1;
+    }
+    
+    ax25_connection_t* conn = find_connection(tnc, remote_addr);
+    if (!conn || conn->state != AX25_STATE_CONNECTED) {
+        return -1;
+    }
+    return conn->max_info;
+}
+
+// T1 expiry: repeat SABM(E) while connecting, otherwise go back to V(A) and retransmit
+// every unacknowledged I-frame, polling with the first, or repeat the poll if none is
+// outstanding. After max_retries the link is dropped and 1 is returned.
+static int t1_expired(ax25_tnc_t* tnc, ax25_connection_t* conn) {
+    if (!conn->t1_running) {
+        return 0;
+    }
+    
+    if (++conn->retry_count > conn->max_retries) {
+        release_connection(tnc, conn);
+        return 1;
+    }
+    if (conn->backoff < 16) {
+        conn->backoff++;
+    }
+    
+    int result;
+    if (conn->state == AX25_STATE_CONNECTING) {
+        uint8_t ctrl = conn->extended_mode ? AX25_CTRL_SABME : AX25_CTRL_SABM;
+        ax25_frame_t frame;
+        if (ax25_create_frame(&frame, &conn->local_addr, &conn->remote_addr, ctrl, 0, NULL,
+                              0) != 0) {
+            return -1;
+        }
+        result = queue_frame(tnc, &frame);
+    } else if (conn->ack_seq == conn->queue_seq) {
+        result = send_supervisory(tnc, conn, AX25_CTRL_RR, conn->recv_seq, true, true);
+    } else {
+        conn->send_seq = conn->ack_seq;
+        conn->poll_pending = true;
+        memset(conn->srej_resend, 0, sizeof(conn->srej_resend));
+        result = ax25_transmit_pending(tnc) < 0 ? -1 : 0;
+    }
+    
+    // Armed after the resend so the airtime covers every frame going out again
+    timer_stop(tnc, timer_id(tnc, conn, AX25_TIMER_T1));
+    start_t1(tnc, conn);
+    return result;
+}
+
+// T2 expiry: acknowledge the I-frames received since the last frame carrying N(R)
+static int t2_expired(ax25_tnc_t* tnc, ax25_connection_t* conn) {
+    if (conn->state != AX25_STATE_CONNECTED) {
+        return 0;
+    }
+    return send_acknowledgement(tnc, conn);
+}
+
+// T3 expiry: nothing was heard on an idle link; poll the peer and let T1 count the tries
+static int t3_expired(ax25_tnc_t* tnc, ax25_connection_t* conn) {
+    if (conn->state != AX25_STATE_CONNECTED || conn->t1_running) {
+        return 0;
+    }
+    conn->retry_count = 0;
+    if (send_supervisory(tnc, conn, AX25_CTRL_RR, conn->recv_seq, true, true) != 0) {
+        return -1;
+    }
+    start_t1(tnc, conn);
+    return 0;
+}
+
+int ax25_t1_duration(ax25_tnc_t* tnc, const ax25_address_t* remote_addr) {
+    if (!tnc || !remote_addr) {
+        return -1;
+    }
+    
+    ax25_connection_t* conn = find_connection(tnc, remote_addr);
+    if (!conn) {
+        return -1;
+    }
+    return (int)t1_duration(tnc, conn);
+}
+
+// T1 expiry signalled by the caller instead of ax25_tick()
+int ax25_t1_expired(ax25_tnc_t* tnc, const ax25_address_t* remote_addr) {
+    if (!tnc || !remote_addr) {
+        return -1;
+    }
+    
+    ax25_connection_t* conn = find_connection(tnc, remote_addr);
+    if (!conn) {
+        return -1;
+    }
+    return t1_expired(tnc, conn);
+}
+
+int ax25_set_clock(ax25_tnc_t* tnc, ax25_clock_t clock, void* context) {
+    if (!tnc) {
+        return -1;
+    }
+    tnc->clock = clock;
+    tnc->clock_context = context;
     return 0;
 }
 
+// Advance the timing wheel to now, visiting only occupied slots
+int ax25_tick(ax25_tnc_t* tnc, uint64_t now) {
+    if (!tnc) {
+        return -1;
+    }
+    
+    ax25_timer_wheel_t* wheel = &tnc->timers;
+    if (now < wheel->now) {
+        return 0; // Not monotonic
+    }
+    wheel->now = now;
+    
+    int fired = 0;
+    while (wheel->armed > 0) {
+        uint64_t t = wheel_next_event(wheel);
+        if (t > now) {
+            break;
+        }
+        wheel->time = t;
+        wheel_cascade(tnc, t);
+        
+        // Timers armed while these fire are placed from t + 1, so a slot that comes round
+        // again here may hold one that is not due yet
+        wheel->time = t + 1;
+        uint32_t* head = &wheel->slots[0][t & WHEEL_MASK];
+        uint32_t id = *head;
+        while (id != AX25_NO_TIMER) {
+            ax25_timer_t* timer = timer_at(tnc, id);
+            if (timer->expires > t) {
+                id = timer->next;
+                continue;
+            }
+            timer_stop(tnc, id);
+            ax25_connection_t* conn = &tnc->connections[id / AX25_TIMER_COUNT];
+            switch (id % AX25_TIMER_COUNT) {
+            case AX25_TIMER_T1:
+                t1_expired(tnc, conn);
+                break;
+            case AX25_TIMER_T2:
+                t2_expired(tnc, conn);
+                break;
+            case AX25_TIMER_T3:
+                t3_expired(tnc, conn);
+                break;
+            default:
+                drop_reassembly(tnc, conn, false); // No segment within reassembly_timeout
+                break;
+            }
+            fired++;
+            id = *head; // The handler may have stopped or armed other timers
+        }
+    }
+    if (wheel->time <= now) {
+        wheel->time = now + 1;
+    }
+    return fired;
+}
+
+// In-sequence frames that were buffered behind a gap the last received frame filled
+int ax25_receive_pending(ax25_tnc_t* tnc, ax25_address_t* remote_addr, uint8_t* data,
+                         uint16_t* length) {
+    if (!tnc || !remote_addr || !data || !length) {
+        return -1;
+    }
+    
+    for (uint16_t i = 0; i < tnc->connection_capacity; i++) {
+        ax25_connection_t* conn = &tnc->connections[i];
+        if (conn->state != AX25_STATE_CONNECTED || !conn->rx_slots ||
+            !conn->rx_slots[conn->recv_seq].data) {
+            continue;
+        }
+        const ax25_slot_t* slot = &conn->rx_slots[conn->recv_seq];
+        if (receive_segment(tnc, conn, slot->pid, slot->data, slot->length)) {
+            *length = 0;
+        } else if (slot->length > *length) {
+            return -1; // Buffer too small
+        } else {
+            memcpy(data, slot->data, slot->length);
+            *length = slot->length;
+        }
+        *remote_addr = conn->remote_addr;
+        clear_slot(conn->rx_slots, conn->recv_seq);
+        set_seq_bit(conn->srej_requested, conn->recv_seq, false);
+        conn->recv_seq = seq_next(conn, conn->recv_seq);
+        frame_accepted(tnc, conn, false);
+        return 0;
+    }
+    return -1;
+}
@@ -0,0 +1,229 @@
+/*
+ * Copyright 2024 gr-packet-protocols
+ *
+ * This file is part of gr-packet-protocols
+ *
+ * gr-packet-protocols is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-packet-protocols is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-packet-protocols; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "ax25_segmenter_impl.h"
+#include <gnuradio/io_signature.h>
+#include <algorithm>
+
+namespace gr {
+namespace packet_protocols {
+
+namespace {
+
+const pmt::pmt_t PID_KEY = pmt::mp("pid");
+const pmt::pmt_t SRC_KEY = pmt::mp("src");
+
+// PID from a PDU's meta dict, or `fallback` when it has none
+long meta_pid(const pmt::pmt_t& meta, long fallback) {
+    if (!pmt::is_dict(meta) || !pmt::dict_has_key(meta, PID_KEY)) {
+        return fallback;
+    }
+    const pmt::pmt_t value = pmt::dict_ref(meta, PID_KEY, pmt::PMT_NIL);
+    return pmt::is_integer(value) ? pmt::to_long(value) : fallback;
+}
+
+pmt::pmt_t with_pid(const pmt::pmt_t& meta, long pid) {
+    return pmt::dict_add(pmt::is_dict(meta) ? meta : pmt::make_dict(), PID_KEY,
+                         pmt::from_long(pid));
+}
+
+} // namespace
+
+ax25_segmenter::sptr ax25_segmenter::make(int max_info, int max_messages,
+                                          int timeout_ms) {
+    return gnuradio::make_block_sptr<ax25_segmenter_impl>(max_info, max_messages,
+                                                          timeout_ms);
+}
+
+ax25_segmenter_impl::ax25_segmenter_impl(int max_info, int max_messages, int timeout_ms)
+    : gr::block("ax25_segmenter", gr::io_signature::make(0, 0, 0),
+                gr::io_signature::make(0, 0, 0)),
+      d_max_info(static_cast<uint16_t>(std::clamp(max_info, 3, AX25_MAX_INFO))),
+      d_max_messages(static_cast<size_t>(std::max(max_messages, 1))),
+      d_timeout(std::max(timeout_ms, 0)), d_segment(AX25_MAX_INFO) {
+    message_port_register_in(pmt::mp("pdus_in"));
+    message_port_register_out(pmt::mp("segments_out"));
+    set_msg_handler(pmt::mp("pdus_in"),
+                    [this](const pmt::pmt_t& msg) { handle_pdus_in(msg); });
+
+    message_port_register_in(pmt::mp("segments_in"));
+    message_port_register_out(pmt::mp("pdus_out"));
+    set_msg_handler(pmt::mp("segments_in"),
+                    [this](const pmt::pmt_t& msg) { handle_segments_in(msg); });
+}
+
+ax25_segmenter_impl::~ax25_segmenter_impl() {
+    stop();
+    for (auto& entry : d_messages) {
+        ax25_reassembly_reset(&entry.second.reassembly);
+    }
+}
+
+bool ax25_segmenter_impl::start() {
+    // Segments drive expiry while they arrive; the thread covers a source that goes quiet
+    if (d_timeout.count() > 0 && !d_expiry.joinable()) {
+        d_stopping = false;
+        d_expiry = std::thread([this] { run_expiry(); });
+    }
+    return block::start();
+}
+
+bool ax25_segmenter_impl::stop() {
+    if (d_expiry.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(d_mutex);
+            d_stopping = true;
+        }
+        d_wake.notify_all();
+        d_expiry.join();
+    }
+    return block::stop();
+}
+
+void ax25_segmenter_impl::run_expiry() {
+    // Checking every half timeout drops a message at most 1.5 timeouts after its last
+    // segment
+    const auto period = std::max(d_timeout / 2, std::chrono::milliseconds(1));
+    std::unique_lock<std::mutex> lock(d_mutex);
+    while (!d_wake.wait_for(lock, period, [this] { return d_stopping; })) {
+        expire(std::chrono::steady_clock::now());
+    }
+}
+
+void ax25_segmenter_impl::handle_pdus_in(const pmt::pmt_t& msg) {
+    if (!pmt::is_pair(msg) || !pmt::is_u8vector(pmt::cdr(msg))) {
+        return;
+    }
+    size_t length = 0;
+    const uint8_t* data = pmt::u8vector_elements(pmt::cdr(msg), length);
+    if (length <= d_max_info) {
+        message_port_pub(pmt::mp("segments_out"), msg);
+        return;
+    }
+
+    // Longer than AX25_MAX_SEGMENTS segments can carry: nothing is sent
+    const int count = ax25_segment_count(static_cast<uint32_t>(length), d_max_info);
+    if (length > static_cast<size_t>(AX25_MAX_MESSAGE) || count < 0) {
+        d_logger->warn("{} byte PDU does not fit in {} segments", length,
+                       AX25_MAX_SEGMENTS);
+        return;
+    }
+    const pmt::pmt_t meta = pmt::car(msg);
+    const uint8_t pid = static_cast<uint8_t>(meta_pid(meta, AX25_PID_NONE));
+    const pmt::pmt_t segment_meta = with_pid(meta, AX25_PID_SEGMENT);
+    for (int index = 0; index < count; index++) {
+        uint16_t info_length = static_cast<uint16_t>(d_segment.size());
+        if (ax25_segment(data, static_cast<uint32_t>(length), pid, d_max_info, index,
+                         d_segment.data(), &info_length) < 0) {
+            return;
+        }
+        message_port_pub(pmt::mp("segments_out"),
+                         pmt::cons(segment_meta, pmt::init_u8vector(info_length,
+                                                                    d_segment.data())));
+    }
+}
+
+void ax25_segmenter_impl::handle_segments_in(const pmt::pmt_t& msg) {
+    if (!pmt::is_pair(msg) || !pmt::is_u8vector(pmt::cdr(msg))) {
+        return;
+    }
+    const pmt::pmt_t meta = pmt::car(msg);
+    if (meta_pid(meta, AX25_PID_NONE) != AX25_PID_SEGMENT) {
+        message_port_pub(pmt::mp("pdus_out"), msg);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(d_mutex);
+    const auto now = std::chrono::steady_clock::now();
+    expire(now);
+
+    size_t length = 0;
+    const uint8_t* info = pmt::u8vector_elements(pmt::cdr(msg), length);
+    if (length == 0 || length > AX25_MAX_INFO) {
+        return;
+    }
+    std::string src;
+    if (pmt::is_dict(meta) && pmt::dict_has_key(meta, SRC_KEY)) {
+        src = pmt::write_string(pmt::dict_ref(meta, SRC_KEY, pmt::PMT_NIL));
+    }
+
+    // Only a first segment starts a message; it needs a free slot
+    auto it = d_messages.find(src);
+    if (it == d_messages.end()) {
+        if (!(info[0] & AX25_SEGMENT_FIRST)) {
+            return;
+        }
+        if (d_messages.size() >= d_max_messages) {
+            d_dropped++;
+            return;
+        }
+        it = d_messages.emplace(src, message()).first;
+    }
+
+    // A new first segment restarts the source's message
+    message& entry = it->second;
+    if ((info[0] & AX25_SEGMENT_FIRST) && entry.reassembly.active &&
+        !entry.reassembly.complete) {
+        d_dropped++;
+    }
+    entry.last = now;
+    const int result =
+        ax25_reassembly_add(&entry.reassembly, info, static_cast<uint16_t>(length));
+    if (result < 0) {
+        drop(it);
+    } else if (result > 0) {
+        const pmt::pmt_t out_meta = with_pid(meta, entry.reassembly.pid);
+        message_port_pub(pmt::mp("pdus_out"),
+                         pmt::cons(out_meta, pmt::init_u8vector(entry.reassembly.length,
+                                                                entry.reassembly.data)));
+        d_reassembled++;
+        ax25_reassembly_reset(&entry.reassembly);
+        d_messages.erase(it);
+    }
+}
+
+// Drop messages whose next segment is overdue; checked as segments arrive and by the
+// expiry thread, with d_mutex held
+void ax25_segmenter_impl::expire(std::chrono::steady_clock::time_point now) {
+    if (d_timeout.count() == 0) {
+        return;
+    }
+    for (auto it = d_messages.begin(); it != d_messages.end();) {
+        auto next = std::next(it);
+        if (now - it->second.last > d_timeout) {
+            drop(it);
+        }
+        it = next;
+    }
+}
+
+void ax25_segmenter_impl::drop(std::map<std::string, message>::iterator it) {
+    ax25_reassembly_reset(&it->second.reassembly);
+    d_messages.erase(it);
+    d_dropped++;
+}
+
+} // namespace packet_protocols
+} // namespace gr
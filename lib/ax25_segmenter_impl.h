@@ -0,0 +1,83 @@
+/*
+ * Copyright 2024 gr-packet-protocols
+ *
+ * This file is part of gr-packet-protocols
+ *
+ * gr-packet-protocols is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * gr-packet-protocols is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gr-packet-protocols; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_PACKET_PROTOCOLS_AX25_SEGMENTER_IMPL_H
+#define INCLUDED_PACKET_PROTOCOLS_AX25_SEGMENTER_IMPL_H
+
+#include <gnuradio/packet_protocols/ax25_protocol.h>
+#include <gnuradio/packet_protocols/ax25_segmenter.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gr {
+namespace packet_protocols {
+
+class ax25_segmenter_impl : public ax25_segmenter {
+  private:
+    //! Message being reassembled for one source
+    struct message {
+        ax25_reassembly_t reassembly{};
+        std::chrono::steady_clock::time_point last; //!< Arrival of the latest segment
+    };
+
+    const uint16_t d_max_info;
+    const size_t d_max_messages;
+    const std::chrono::milliseconds d_timeout;
+
+    std::map<std::string, message> d_messages; //!< Keyed by meta "src"; under d_mutex
+    std::vector<uint8_t> d_segment;            //!< Scratch information field
+
+    // Expiry thread: drops overdue messages while no segments arrive
+    std::mutex d_mutex;
+    std::condition_variable d_wake;
+    bool d_stopping{ false };
+    std::thread d_expiry;
+
+    std::atomic<uint64_t> d_reassembled{ 0 };
+    std::atomic<uint64_t> d_dropped{ 0 };
+
+    void handle_pdus_in(const pmt::pmt_t& msg);
+    void handle_segments_in(const pmt::pmt_t& msg);
+    void expire(std::chrono::steady_clock::time_point now);
+    void drop(std::map<std::string, message>::iterator it);
+    void run_expiry();
+
+  public:
+    ax25_segmenter_impl(int max_info, int max_messages, int timeout_ms);
+    ~ax25_segmenter_impl() override;
+
+    bool start() override;
+    bool stop() override;
+
+    uint64_t messages_reassembled() const override { return d_reassembled.load(); }
+    uint64_t messages_dropped() const override { return d_dropped.load(); }
+};
+
+} // namespace packet_protocols
+} // namespace gr
+
+#endif /* INCLUDED_PACKET_PROTOCOLS_AX25_SEGMENTER_IMPL_H */
@@ -24,6 +24,7 @@
 #endif
 
 #include "fx25_decoder_impl.h"
+#include "fx25_interleaver.h"
 #include <algorithm>
 #include <gnuradio/io_signature.h>
 
@@ -36,7 +37,7 @@ fx25_decoder::sptr fx25_decoder::make() {
 
 fx25_decoder_impl::fx25_decoder_impl()
     : gr::block("fx25_decoder", gr::io_signature::make(1, 1, sizeof(char)),
-                gr::io_signature::make(1, 1, sizeof(char))),
+                gr::io_signature::make(1, 2, sizeof(char))),
       d_state(STATE_IDLE), d_bit_buffer(0), d_bit_count(0), d_frame_buffer(8192), d_frame_length(0),
       d_ones_count(0), d_escaped(false), d_fec_type(FX25_FEC_RS_255_223), d_interleaver_depth(1),
       d_reed_solomon_decoder(nullptr) {
@@ -44,6 +45,7 @@ fx25_decoder_impl::fx25_decoder_impl()
     initialize_reed_solomon();
 
     d_frame_length = 0;
+    message_port_register_out(pmt::mp("dcd"));
 }
 
 fx25_decoder_impl::~fx25_decoder_impl() {
@@ -103,6 +105,8 @@ int fx25_decoder_impl::general_work(int noutput_items,
 {
     const char* in = (const char*)input_items[0];
     char* out = (char*)output_items[0];
+    // Optional second output: the DCD state for every consumed input bit
+    char* dcd_out = output_items.size() > 1 ? (char*)output_items[1] : nullptr;
     int produced = 0;
     int consumed = 0;
     const int nin = ninput_items[0];
@@ -112,8 +116,15 @@ int fx25_decoder_impl::general_work(int noutput_items,
         d_out_queue.pop_front();
     }
 
-    while (produced < noutput_items && consumed < nin) {
+    while (produced < noutput_items && consumed < nin &&
+           (!dcd_out || consumed < noutput_items)) {
         bool bit = in[consumed] != 0;
+        if (d_dcd.process(bit)) {
+            message_port_pub(pmt::mp("dcd"),
+                             pmt::cons(pmt::mp("dcd"), pmt::from_bool(d_dcd.dcd())));
+        }
+        if (dcd_out)
+            dcd_out[consumed] = d_dcd.dcd() ? 1 : 0;
         consumed++;
         process_bit(bit);
 
@@ -139,6 +150,11 @@ int fx25_decoder_impl::general_work(int noutput_items,
     }
 
     consume_each(consumed);
+    if (dcd_out) {
+        produce(0, produced);
+        produce(1, consumed);
+        return WORK_CALLED_PRODUCE;
+    }
     return produced;
 }
 
@@ -219,15 +235,14 @@ std::vector<uint8_t> fx25_decoder_impl::decode_fx25_frame() {
     }
 
     // Extract RS codeword octets (after FX.25 fixed header; before 16-bit checksum). Buffer excludes HDLC flags.
-    std::vector<uint8_t> data;
-    for (int i = 6; i < d_frame_length - 2; i++)
-        data.push_back(d_frame_buffer[i]);
+    std::vector<uint8_t> data(d_frame_buffer.begin() + 6,
+                              d_frame_buffer.begin() + (d_frame_length - 2));
 
     // Deinterleave data
-    std::vector<uint8_t> deinterleaved_data = deinterleave_data(data);
+    deinterleave_data(data);
 
     // Apply Reed-Solomon decoding
-    std::vector<uint8_t> decoded_data = apply_reed_solomon_decode(deinterleaved_data);
+    std::vector<uint8_t> decoded_data = apply_reed_solomon_decode(data);
 
     return decoded_data;
 }
@@ -250,19 +265,8 @@ bool fx25_decoder_impl::parse_fx25_header() {
     return true;
 }
 
-std::vector<uint8_t> fx25_decoder_impl::deinterleave_data(const std::vector<uint8_t>& data) {
-    if (d_interleaver_depth <= 1) {
-        return data;
-    }
-
-    std::vector<uint8_t> deinterleaved_data(data.size());
-
-    for (size_t i = 0; i < data.size(); i++) {
-        int original_pos = (i * d_interleaver_depth) % data.size();
-        deinterleaved_data[original_pos] = data[i];
-    }
-
-    return deinterleaved_data;
+void fx25_decoder_impl::deinterleave_data(std::vector<uint8_t>& data) {
+    fx25_deinterleave_inplace(data, d_interleaver_depth, d_interleave_scratch);
 }
 
 std::vector<uint8_t> fx25_decoder_impl::apply_reed_solomon_decode(
@@ -22,6 +22,7 @@
 #ifndef INCLUDED_PACKET_PROTOCOLS_FX25_DECODER_IMPL_H
 #define INCLUDED_PACKET_PROTOCOLS_FX25_DECODER_IMPL_H
 
+#include "hdlc_dcd.h"
 #include <gnuradio/packet_protocols/common.h>
 #include <gnuradio/packet_protocols/fx25_decoder.h>
 #include <gnuradio/packet_protocols/fx25_protocol.h>
@@ -54,6 +55,8 @@ class fx25_decoder_impl : public fx25_decoder {
     int d_interleaver_depth;                    //!< Interleaver depth
     ReedSolomonDecoder* d_reed_solomon_decoder; //!< Reed-Solomon decoder
     std::deque<uint8_t> d_out_queue;            //!< Pending decoded bytes
+    std::vector<uint8_t> d_interleave_scratch;  //!< Reused deinterleaver output buffer
+    hdlc_dcd d_dcd;                             //!< Carrier detect on the raw bit stream
 
   public:
     /*!
@@ -79,6 +82,10 @@ class fx25_decoder_impl : public fx25_decoder {
                      gr_vector_const_void_star& input_items,
                      gr_vector_void_star& output_items) override;
 
+    void set_dcd_flags(int flags) override { d_dcd.set_flags_to_assert(flags); }
+    void set_dcd_hold_off(int bits) override { d_dcd.set_hold_off(bits); }
+    bool dcd() const override { return d_dcd.dcd(); }
+
   private:
     /*!
      * \brief Initialize Reed-Solomon decoder
@@ -104,11 +111,10 @@ class fx25_decoder_impl : public fx25_decoder {
     bool parse_fx25_header();
 
     /*!
-     * \brief Deinterleave data
-     * \param data Input data
-     * \return Deinterleaved data
+     * \brief Undo the encoder's block interleaving in place
+     * \param data Received codeword octets; replaced by codewords in RS order
      */
-    std::vector<uint8_t> deinterleave_data(const std::vector<uint8_t>& data);
+    void deinterleave_data(std::vector<uint8_t>& data);
 
     /*!
      * \brief Apply Reed-Solomon decoding
@@ -24,6 +24,7 @@
 #endif
 
 #include "fx25_encoder_impl.h"
+#include "fx25_interleaver.h"
 #include <gnuradio/io_signature.h>
 
 namespace gr {
@@ -182,13 +183,11 @@ void fx25_encoder_impl::build_fx25_frame(char data_byte) {
     std::vector<uint8_t> fec_data = apply_reed_solomon_fec(ax25_data);
 
     // Interleave data
-    std::vector<uint8_t> interleaved_data = interleave_data(fec_data);
+    interleave_data(fec_data);
 
     // Add to frame buffer
-    for (size_t i = 0; i < interleaved_data.size(); i++) {
-        d_frame_buffer.push_back(interleaved_data[i]);
-        d_frame_length++;
-    }
+    d_frame_buffer.insert(d_frame_buffer.end(), fec_data.begin(), fec_data.end());
+    d_frame_length += static_cast<uint16_t>(fec_data.size());
 
     // Add checksum if requested
     if (d_add_checksum) {
@@ -262,19 +261,8 @@ std::vector<uint8_t> fx25_encoder_impl::apply_reed_solomon_fec(const std::vector
     return encoded_data;
 }
 
-std::vector<uint8_t> fx25_encoder_impl::interleave_data(const std::vector<uint8_t>& data) {
-    if (d_interleaver_depth <= 1) {
-        return data;
-    }
-
-    std::vector<uint8_t> interleaved_data(data.size());
-
-    for (size_t i = 0; i < data.size(); i++) {
-        int new_pos = (i * d_interleaver_depth) % data.size();
-        interleaved_data[new_pos] = data[i];
-    }
-
-    return interleaved_data;
+void fx25_encoder_impl::interleave_data(std::vector<uint8_t>& data) {
+    fx25_interleave_inplace(data, d_interleaver_depth, d_interleave_scratch);
 }
 
 uint16_t fx25_encoder_impl::calculate_checksum() {
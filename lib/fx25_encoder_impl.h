@@ -46,6 +46,7 @@ class fx25_encoder_impl : public fx25_encoder {
     uint16_t d_frame_length{ 0 };               //!< Valid length in d_frame_buffer
     std::vector<uint8_t> d_bit_queue;             //!< Serialized bits to emit (stuffed body)
     size_t d_bit_q_read{ 0 };
+    std::vector<uint8_t> d_interleave_scratch;    //!< Reused interleaver output buffer
     ReedSolomonEncoder* d_reed_solomon_encoder; //!< Reed-Solomon encoder
 
   public:
@@ -120,11 +121,10 @@ class fx25_encoder_impl : public fx25_encoder {
     std::vector<uint8_t> apply_reed_solomon_fec(const std::vector<uint8_t>& data);
 
     /*!
-     * \brief Interleave data
-     * \param data Input data
-     * \return Interleaved data
+     * \brief Block-interleave RS codewords in place (depth = codewords per group)
+     * \param data Concatenated codewords; replaced by the interleaved sequence
      */
-    std::vector<uint8_t> interleave_data(const std::vector<uint8_t>& data);
+    void interleave_data(std::vector<uint8_t>& data);
 
     /*!
      * \brief Calculate checksum for frame
@@ -0,0 +1,251 @@
+/*
+ * Copyright 2024 gr-packet-protocols
+ *
+ * This file is part of gr-packet-protocols
+ */
+
+#ifndef INCLUDED_PACKET_PROTOCOLS_FX25_INTERLEAVER_H
+#define INCLUDED_PACKET_PROTOCOLS_FX25_INTERLEAVER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace gr {
+namespace packet_protocols {
+
+// FX.25 block interleaver across Reed-Solomon codewords.
+//
+// Codewords are grouped `depth` at a time and each group is written to the
+// wire column by column: symbol c of codeword 0, symbol c of codeword 1, ...
+// symbol c of codeword depth-1, then symbol c+1 of each codeword. A burst of
+// up to `depth` consecutive channel errors therefore lands as at most one
+// symbol error per codeword. The last group may hold fewer than `depth`
+// codewords; it is transposed with its actual row count, so the mapping is a
+// permutation for every (depth, length) pair. Trailing bytes that do not fill
+// a whole codeword are copied through unchanged.
+
+static const size_t FX25_INTERLEAVER_CODEWORD_LEN = 255;
+
+namespace fx25_interleaver_detail {
+
+#if defined(__SSE2__)
+// Zip `R` rows of 16 bytes into R consecutive 16-byte output registers
+// (out byte m*R + r = row r byte m).
+template <int R>
+inline void zip_rows(const __m128i* rows, __m128i* out)
+{
+    if constexpr (R == 1) {
+        out[0] = rows[0];
+    } else {
+        __m128i even_rows[R / 2], odd_rows[R / 2];
+        for (int i = 0; i < R / 2; ++i) {
+            even_rows[i] = rows[2 * i];
+            odd_rows[i] = rows[2 * i + 1];
+        }
+        __m128i even[R / 2], odd[R / 2];
+        zip_rows<R / 2>(even_rows, even);
+        zip_rows<R / 2>(odd_rows, odd);
+        for (int i = 0; i < R / 2; ++i) {
+            out[2 * i] = _mm_unpacklo_epi8(even[i], odd[i]);
+            out[2 * i + 1] = _mm_unpackhi_epi8(even[i], odd[i]);
+        }
+    }
+}
+
+// Inverse of zip_rows: split R consecutive registers back into R rows.
+template <int R>
+inline void unzip_rows(const __m128i* in, __m128i* rows)
+{
+    if constexpr (R == 1) {
+        rows[0] = in[0];
+    } else {
+        const __m128i lo_mask = _mm_set1_epi16(0x00FF);
+        __m128i even[R / 2], odd[R / 2];
+        for (int i = 0; i < R / 2; ++i) {
+            even[i] = _mm_packus_epi16(_mm_and_si128(in[2 * i], lo_mask),
+                                       _mm_and_si128(in[2 * i + 1], lo_mask));
+            odd[i] = _mm_packus_epi16(_mm_srli_epi16(in[2 * i], 8),
+                                      _mm_srli_epi16(in[2 * i + 1], 8));
+        }
+        __m128i even_rows[R / 2], odd_rows[R / 2];
+        unzip_rows<R / 2>(even, even_rows);
+        unzip_rows<R / 2>(odd, odd_rows);
+        for (int i = 0; i < R / 2; ++i) {
+            rows[2 * i] = even_rows[i];
+            rows[2 * i + 1] = odd_rows[i];
+        }
+    }
+}
+
+template <int R>
+inline size_t transpose_simd(const uint8_t* in, uint8_t* out, size_t cols)
+{
+    size_t c = 0;
+    for (; c + 16 <= cols; c += 16) {
+        __m128i rows[R], zipped[R];
+        for (int r = 0; r < R; ++r)
+            rows[r] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + r * cols + c));
+        zip_rows<R>(rows, zipped);
+        for (int r = 0; r < R; ++r)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + c * R + 16 * r), zipped[r]);
+    }
+    return c;
+}
+
+template <int R>
+inline size_t untranspose_simd(const uint8_t* in, uint8_t* out, size_t cols)
+{
+    size_t c = 0;
+    for (; c + 16 <= cols; c += 16) {
+        __m128i zipped[R], rows[R];
+        for (int r = 0; r < R; ++r)
+            zipped[r] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + c * R + 16 * r));
+        unzip_rows<R>(zipped, rows);
+        for (int r = 0; r < R; ++r)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + r * cols + c), rows[r]);
+    }
+    return c;
+}
+#endif
+
+// rows x cols (row-major) -> cols x rows (row-major)
+inline void transpose(const uint8_t* in, uint8_t* out, size_t rows, size_t cols)
+{
+    size_t c0 = 0;
+#if defined(__SSE2__)
+    switch (rows) {
+    case 2:
+        c0 = transpose_simd<2>(in, out, cols);
+        break;
+    case 4:
+        c0 = transpose_simd<4>(in, out, cols);
+        break;
+    case 8:
+        c0 = transpose_simd<8>(in, out, cols);
+        break;
+    default:
+        break;
+    }
+#endif
+    uint8_t* dst = out + c0 * rows;
+    for (size_t c = c0; c < cols; ++c)
+        for (size_t r = 0; r < rows; ++r)
+            *dst++ = in[r * cols + c];
+}
+
+// Inverse of transpose()
+inline void untranspose(const uint8_t* in, uint8_t* out, size_t rows, size_t cols)
+{
+    size_t c0 = 0;
+#if defined(__SSE2__)
+    switch (rows) {
+    case 2:
+        c0 = untranspose_simd<2>(in, out, cols);
+        break;
+    case 4:
+        c0 = untranspose_simd<4>(in, out, cols);
+        break;
+    case 8:
+        c0 = untranspose_simd<8>(in, out, cols);
+        break;
+    default:
+        break;
+    }
+#endif
+    const uint8_t* src = in + c0 * rows;
+    for (size_t c = c0; c < cols; ++c)
+        for (size_t r = 0; r < rows; ++r)
+            out[r * cols + c] = *src++;
+}
+
+} // namespace fx25_interleaver_detail
+
+/*!
+ * \brief Interleave \p length bytes of concatenated codewords from \p in into \p out.
+ *
+ * \p in and \p out must not overlap. A depth of 0 or 1 is a plain copy.
+ */
+inline void fx25_interleave(const uint8_t* in,
+                            uint8_t* out,
+                            size_t length,
+                            int depth,
+                            size_t codeword_len = FX25_INTERLEAVER_CODEWORD_LEN)
+{
+    const size_t codewords = codeword_len ? length / codeword_len : 0;
+    size_t pos = 0;
+    if (depth > 1) {
+        for (size_t cw = 0; cw < codewords;) {
+            size_t rows = codewords - cw;
+            if (rows > static_cast<size_t>(depth))
+                rows = static_cast<size_t>(depth);
+            fx25_interleaver_detail::transpose(in + pos, out + pos, rows, codeword_len);
+            pos += rows * codeword_len;
+            cw += rows;
+        }
+    }
+    if (pos < length)
+        std::memcpy(out + pos, in + pos, length - pos);
+}
+
+/*!
+ * \brief Inverse of fx25_interleave() for the same \p length, \p depth and \p codeword_len.
+ */
+inline void fx25_deinterleave(const uint8_t* in,
+                              uint8_t* out,
+                              size_t length,
+                              int depth,
+                              size_t codeword_len = FX25_INTERLEAVER_CODEWORD_LEN)
+{
+    const size_t codewords = codeword_len ? length / codeword_len : 0;
+    size_t pos = 0;
+    if (depth > 1) {
+        for (size_t cw = 0; cw < codewords;) {
+            size_t rows = codewords - cw;
+            if (rows > static_cast<size_t>(depth))
+                rows = static_cast<size_t>(depth);
+            fx25_interleaver_detail::untranspose(in + pos, out + pos, rows, codeword_len);
+            pos += rows * codeword_len;
+            cw += rows;
+        }
+    }
+    if (pos < length)
+        std::memcpy(out + pos, in + pos, length - pos);
+}
+
+/*!
+ * \brief In-place variants: transpose into \p scratch and copy back, so \p data keeps
+ * its storage. \p scratch is resized once and reused across calls.
+ */
+inline void fx25_interleave_inplace(std::vector<uint8_t>& data,
+                                    int depth,
+                                    std::vector<uint8_t>& scratch)
+{
+    if (depth <= 1 || data.size() < 2 * FX25_INTERLEAVER_CODEWORD_LEN)
+        return;
+    scratch.resize(data.size());
+    fx25_interleave(data.data(), scratch.data(), data.size(), depth);
+    std::copy(scratch.begin(), scratch.begin() + data.size(), data.begin());
+}
+
+inline void fx25_deinterleave_inplace(std::vector<uint8_t>& data,
+                                      int depth,
+                                      std::vector<uint8_t>& scratch)
+{
+    if (depth <= 1 || data.size() < 2 * FX25_INTERLEAVER_CODEWORD_LEN)
+        return;
+    scratch.resize(data.size());
+    fx25_deinterleave(data.data(), scratch.data(), data.size(), depth);
+    std::copy(scratch.begin(), scratch.begin() + data.size(), data.begin());
+}
+
+} // namespace packet_protocols
+} // namespace gr
+
+#endif /* INCLUDED_PACKET_PROTOCOLS_FX25_INTERLEAVER_H */
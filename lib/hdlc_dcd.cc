@@ -0,0 +1,96 @@
+/*
+ * Copyright 2024 gr-packet-protocols
+ *
+ * This file is part of gr-packet-protocols
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "hdlc_dcd.h"
+
+namespace gr {
+namespace packet_protocols {
+
+bool hdlc_dcd::process(bool bit) {
+    d_changed = false;
+    if (d_bits_since_flag <= HDLC_DCD_FLAG_SPACING)
+        d_bits_since_flag++;
+    if (d_drop_countdown > 0 && --d_drop_countdown == 0)
+        drop();
+    if (d_dcd && ++d_flag_gap >= d_flag_timeout.load())
+        drop();
+
+    if (bit) {
+        if (d_ones < 7 && ++d_ones == 7)
+            on_invalid_run();
+        d_clean_bits = d_ones < 7 ? d_clean_bits + 1 : 0;
+    } else {
+        if (d_ones == 5)
+            on_valid_stuff();
+        else if (d_ones == 6)
+            on_flag();
+        d_ones = 0;
+        d_clean_bits++;
+    }
+
+    // Frame data without stuffing: held once, until two flags in a row re-arm it
+    if (d_drop_countdown > 0 && d_data_hold && d_clean_bits >= HDLC_DCD_DATA_TO_HOLD) {
+        d_drop_countdown = 0;
+        d_data_hold = false;
+    }
+    return d_changed;
+}
+
+void hdlc_dcd::reset() {
+    d_ones = 0;
+    d_bits_since_flag = HDLC_DCD_FLAG_SPACING + 1;
+    d_flag_chain = 0;
+    d_dcd = false;
+    d_drop_countdown = 0;
+    d_stuffs_pending = 0;
+    d_clean_bits = 0;
+    d_data_hold = false;
+    d_flag_gap = 0;
+}
+
+void hdlc_dcd::on_flag() {
+    d_flags++;
+    d_flag_chain = d_bits_since_flag <= HDLC_DCD_FLAG_SPACING ? d_flag_chain + 1 : 1;
+    d_bits_since_flag = 0;
+    d_flag_gap = 0;
+    if (d_flag_chain >= 2)
+        d_data_hold = true;
+
+    if (d_dcd) {
+        d_drop_countdown = 0;
+    } else if (d_flag_chain >= d_flags_to_assert.load()) {
+        d_dcd = true;
+        d_changed = true;
+    }
+}
+
+void hdlc_dcd::on_invalid_run() {
+    d_invalid_runs++;
+    d_flag_chain = 0;
+    d_stuffs_pending = 0;
+    // The hold-off runs from the first invalid run; later ones do not extend it
+    if (d_dcd && d_drop_countdown == 0)
+        d_drop_countdown = d_hold_off.load();
+}
+
+void hdlc_dcd::drop() {
+    d_dcd = false;
+    d_changed = true;
+    d_drop_countdown = 0;
+}
+
+void hdlc_dcd::on_valid_stuff() {
+    d_valid_stuffs++;
+    if (d_drop_countdown > 0 && ++d_stuffs_pending >= HDLC_DCD_STUFFS_TO_HOLD)
+        d_drop_countdown = 0;
+}
+
+} // namespace packet_protocols
+} // namespace gr
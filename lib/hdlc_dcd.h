@@ -0,0 +1,99 @@
+/*
+ * Copyright 2024 gr-packet-protocols
+ *
+ * This file is part of gr-packet-protocols
+ */
+
+#ifndef INCLUDED_PACKET_PROTOCOLS_HDLC_DCD_H
+#define INCLUDED_PACKET_PROTOCOLS_HDLC_DCD_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+namespace gr {
+namespace packet_protocols {
+
+const int HDLC_DCD_FLAG_SPACING = 16;     //!< Max bits between flags counted as "dense"
+const int HDLC_DCD_DEFAULT_FLAGS = 4;     //!< Dense flags needed to assert
+const int HDLC_DCD_DEFAULT_HOLD_OFF = 64; //!< Bits a suspected loss of signal must last
+const int HDLC_DCD_STUFFS_TO_HOLD = 2;    //!< Valid stuffs that cancel a pending drop
+const int HDLC_DCD_DATA_TO_HOLD = 32;     //!< Bits free of invalid runs that cancel it
+//! Bits without any flag before DCD drops: a 2048-octet I-field, fully stuffed, fits
+const int HDLC_DCD_DEFAULT_FLAG_TIMEOUT = 24576;
+
+/*!
+ * \brief Data carrier detect from the statistics of an NRZI-decoded HDLC bit stream.
+ *
+ * Three events are recognised in the raw bits, independently of any frame decoder:
+ * a flag (01111110), a valid stuffed zero (exactly five ones, then a zero) and an
+ * invalid run (seven or more ones, which HDLC never sends). Random noise produces
+ * each of them every few hundred bits; a real transmission produces flags eight bits
+ * apart in the preamble and never an invalid run.
+ *
+ * DCD asserts on flag density: a chain of flags each at most HDLC_DCD_FLAG_SPACING
+ * bits after the previous one, with no invalid run in between. Once asserted, an
+ * invalid run only starts a hold-off; DCD drops when the hold-off expires unless a
+ * flag (more frames follow) or HDLC_DCD_STUFFS_TO_HOLD valid stuffed zeros without a
+ * further invalid run (frame data is still arriving) are seen first. Frame data that
+ * never stuffs, such as text, holds DCD by HDLC_DCD_DATA_TO_HOLD bits without an
+ * invalid run; noise often looks like that too, so this rescue is allowed once and
+ * re-armed only by two flags in a row (a preamble or a gap between frames). A single
+ * bit error therefore never toggles the output.
+ *
+ * DCD also drops when no flag at all has been seen for the flag timeout, which bounds
+ * how long data (or noise that keeps rescuing it) can hold the carrier.
+ *
+ * process() and reset() belong to the block thread; the setters and dcd() may be
+ * called from any.
+ */
+class hdlc_dcd
+{
+  public:
+    void set_flags_to_assert(int flags) { d_flags_to_assert.store(std::max(flags, 1)); }
+    void set_hold_off(int bits) { d_hold_off.store(std::max(bits, 1)); }
+    void set_flag_timeout(int bits) { d_flag_timeout.store(std::max(bits, 1)); }
+
+    /*!
+     * \brief Feed one received bit.
+     * \return true if the DCD state changed on this bit
+     */
+    bool process(bool bit);
+
+    bool dcd() const { return d_dcd.load(std::memory_order_relaxed); }
+    void reset();
+
+    uint64_t flags() const { return d_flags; }
+    uint64_t valid_stuffs() const { return d_valid_stuffs; }
+    uint64_t invalid_runs() const { return d_invalid_runs; }
+
+  private:
+    void on_flag();
+    void on_invalid_run();
+    void on_valid_stuff();
+    void drop();
+
+    std::atomic<int> d_flags_to_assert{ HDLC_DCD_DEFAULT_FLAGS };
+    std::atomic<int> d_hold_off{ HDLC_DCD_DEFAULT_HOLD_OFF };
+    std::atomic<int> d_flag_timeout{ HDLC_DCD_DEFAULT_FLAG_TIMEOUT };
+
+    int d_ones{ 0 };            //!< Current run of ones
+    int d_bits_since_flag{ HDLC_DCD_FLAG_SPACING + 1 }; //!< Saturates past the spacing
+    int d_flag_chain{ 0 };      //!< Dense flags since the last invalid run
+    std::atomic<bool> d_dcd{ false }; //!< Read by dcd() from any thread
+    int d_drop_countdown{ 0 };  //!< Bits left in the hold-off; 0 = no drop pending
+    int d_stuffs_pending{ 0 };  //!< Valid stuffs since the last invalid run
+    int d_clean_bits{ 0 };      //!< Bits since the last one of an invalid run
+    bool d_data_hold{ false };  //!< Clean data may still cancel a pending drop
+    int d_flag_gap{ 0 };        //!< Bits since the last flag while DCD is up
+    bool d_changed{ false };
+
+    uint64_t d_flags{ 0 };
+    uint64_t d_valid_stuffs{ 0 };
+    uint64_t d_invalid_runs{ 0 };
+};
+
+} // namespace packet_protocols
+} // namespace gr
+
+#endif /* INCLUDED_PACKET_PROTOCOLS_HDLC_DCD_H */
@@ -25,54 +25,27 @@
 
 #include "il2p_decoder_impl.h"
 #include <algorithm>
+#include <bitset>
 #include <gnuradio/io_signature.h>
 
 namespace gr {
 namespace packet_protocols {
 
-namespace {
-constexpr int IL2P_ENC_HEADER_OCTETS =
-    1 + IL2P_SYNC_WORD_SIZE + 1 + 14; //!< preamble + sync + fec + dest(7) + src(7)
+il2p_decoder::sptr il2p_decoder::make(bool check_crc) {
+    return gnuradio::make_block_sptr<il2p_decoder_impl>(check_crc);
 }
 
-il2p_decoder::sptr il2p_decoder::make() {
-    return gnuradio::make_block_sptr<il2p_decoder_impl>();
-}
-
-il2p_decoder_impl::il2p_decoder_impl()
+il2p_decoder_impl::il2p_decoder_impl(bool check_crc)
     : gr::block("il2p_decoder", gr::io_signature::make(1, 1, sizeof(char)),
-                gr::io_signature::make(1, 1, sizeof(char))),
-      d_state(STATE_IDLE), d_bit_buffer(0), d_bit_count(0), d_frame_buffer(8192), d_frame_length(0),
-      d_ones_count(0), d_fec_type(IL2P_FEC_RS_255_223), d_reed_solomon_decoder(nullptr) {
-    // Initialize Reed-Solomon decoder
-    initialize_reed_solomon();
-
-    d_frame_length = 0;
-}
-
-il2p_decoder_impl::~il2p_decoder_impl() {
-    if (d_reed_solomon_decoder) {
-        delete d_reed_solomon_decoder;
-    }
+                gr::io_signature::make(1, 2, sizeof(char))),
+      d_state(STATE_HUNT), d_sync_shift(0), d_sync_bits(0), d_bit_buffer(0), d_bit_count(0),
+      d_frame_buffer(IL2P_ENCODED_HEADER_SIZE + IL2P_MAX_ENCODED_PAYLOAD_SIZE +
+                     IL2P_CRC_SIZE),
+      d_frame_length(0), d_frame_end(0), d_check_crc(check_crc), d_frame_crc(false) {
+    message_port_register_out(pmt::mp("dcd"));
 }
 
-void il2p_decoder_impl::initialize_reed_solomon() {
-    // Initialize Reed-Solomon decoder based on FEC type
-    switch (d_fec_type) {
-    case IL2P_FEC_RS_255_223:
-        d_reed_solomon_decoder = new ReedSolomonDecoder(255, 223);
-        break;
-    case IL2P_FEC_RS_255_239:
-        d_reed_solomon_decoder = new ReedSolomonDecoder(255, 239);
-        break;
-    case IL2P_FEC_RS_255_247:
-        d_reed_solomon_decoder = new ReedSolomonDecoder(255, 247);
-        break;
-    default:
-        d_reed_solomon_decoder = new ReedSolomonDecoder(255, 223);
-        break;
-    }
-}
+il2p_decoder_impl::~il2p_decoder_impl() {}
 
 void il2p_decoder_impl::forecast(int noutput_items, gr_vector_int& ninput_items_required)
 {
@@ -92,6 +65,8 @@ int il2p_decoder_impl::general_work(int noutput_items,
 {
     const char* in = (const char*)input_items[0];
     char* out = (char*)output_items[0];
+    // Optional second output: the DCD state for every consumed input bit
+    char* dcd_out = output_items.size() > 1 ? (char*)output_items[1] : nullptr;
     int produced = 0;
     int consumed = 0;
     const int nin = ninput_items[0];
@@ -101,23 +76,25 @@ int il2p_decoder_impl::general_work(int noutput_items,
         d_out_queue.pop_front();
     }
 
-    while (produced < noutput_items && consumed < nin) {
+    while (produced < noutput_items && consumed < nin &&
+           (!dcd_out || consumed < noutput_items)) {
         bool bit = in[consumed] != 0;
-        consumed++;
+        const il2p_state_t before = d_state;
         process_bit(bit);
+        if (update_dcd(before, d_state)) {
+            message_port_pub(pmt::mp("dcd"),
+                             pmt::cons(pmt::mp("dcd"), pmt::from_bool(d_dcd.load())));
+        }
+        if (dcd_out)
+            dcd_out[consumed] = d_dcd.load() ? 1 : 0;
+        consumed++;
 
         if (d_state == STATE_FRAME_COMPLETE) {
-            if (d_frame_length > 0) {
-                std::vector<uint8_t> decoded_data = decode_il2p_frame();
-                for (uint8_t b : decoded_data)
-                    d_out_queue.push_back(b);
-            }
+            std::vector<uint8_t> decoded_data = decode_il2p_frame();
+            for (uint8_t b : decoded_data)
+                d_out_queue.push_back(b);
 
-            d_state = STATE_IDLE;
-            d_frame_length = 0;
-            d_bit_buffer = 0;
-            d_bit_count = 0;
-            d_ones_count = 0;
+            reset_hunt();
 
             while (produced < noutput_items && !d_out_queue.empty()) {
                 out[produced++] = static_cast<char>(d_out_queue.front());
@@ -127,228 +104,134 @@ int il2p_decoder_impl::general_work(int noutput_items,
     }
 
     consume_each(consumed);
+    if (dcd_out) {
+        produce(0, produced);
+        produce(1, consumed);
+        return WORK_CALLED_PRODUCE;
+    }
     return produced;
 }
 
-void il2p_decoder_impl::process_bit(bool bit) {
-    switch (d_state) {
-    case STATE_IDLE:
-        if (bit) {
-            d_ones_count++;
-            if (d_ones_count >= 6) {
-                // Found flag sequence, start frame
-                d_state = STATE_FLAG;
-                d_ones_count = 0;
-                d_bit_buffer = 0;
-                d_bit_count = 0;
-                d_frame_length = 0;
-            }
-        } else {
-            d_ones_count = 0;
+bool il2p_decoder_impl::update_dcd(il2p_state_t before, il2p_state_t after) {
+    // Assert on an error-free sync word; a sync accepted with bit errors is confirmed
+    // by the header passing its RS check instead, so noise alone cannot raise DCD
+    const bool exact_sync = before == STATE_HUNT && after == STATE_HEADER &&
+                            d_sync_shift == static_cast<uint32_t>(IL2P_SYNC_WORD);
+    const bool header_ok = before == STATE_HEADER && after != STATE_HEADER &&
+                           after != STATE_HUNT;
+    bool changed = false;
+    if (exact_sync || header_ok) {
+        d_dcd_countdown = 0;
+        if (!d_dcd.load()) {
+            d_dcd.store(true);
+            changed = true;
         }
-        break;
-
-    case STATE_FLAG:
-        if (!bit) {
-            // End of flag, start data
-            d_state = STATE_DATA;
-            d_bit_buffer = 0;
-            d_bit_count = 0;
-            d_ones_count = 0;
-        }
-        break;
-
-    case STATE_DATA: {
-        auto append_data_bit = [&](bool data_bit) {
-            d_bit_buffer = static_cast<uint8_t>((d_bit_buffer << 1) | (data_bit ? 1 : 0));
-            d_bit_count++;
-            if (d_bit_count == 8) {
-                uint8_t byte = d_bit_buffer;
-                if (d_frame_length < static_cast<int>(d_frame_buffer.size())) {
-                    d_frame_buffer[d_frame_length] = byte;
-                    d_frame_length++;
-                }
-                d_bit_buffer = 0;
-                d_bit_count = 0;
-            }
-        };
-
-        if (bit) {
-            d_ones_count++;
-            if (d_ones_count >= 6) {
-                d_state = STATE_FRAME_COMPLETE;
-                return;
-            }
-            append_data_bit(true);
-        } else {
-            if (d_ones_count == 5) {
-                d_ones_count = 0;
-                return;
-            }
-            d_ones_count = 0;
-            append_data_bit(false);
-        }
-    } break;
-
-    case STATE_FRAME_COMPLETE:
-        // Frame is complete, will be handled in general_work()
-        break;
-    }
-}
-
-std::vector<uint8_t> il2p_decoder_impl::decode_il2p_frame() {
-    if (d_frame_length < IL2P_ENC_HEADER_OCTETS + 4) {
-        return std::vector<uint8_t>();
     }
 
-    // Parse IL2P header
-    if (!parse_il2p_header()) {
-        return std::vector<uint8_t>();
+    const bool frame_over =
+        after == STATE_FRAME_COMPLETE || (after == STATE_HUNT && before != STATE_HUNT);
+    if (d_dcd.load() && frame_over) {
+        d_dcd_countdown = d_dcd_hold_off.load();
+    } else if (d_dcd_countdown > 0 && --d_dcd_countdown == 0) {
+        d_dcd.store(false);
+        changed = true;
     }
-
-    // Extract scrambled RS codeword octets (fixed header through frame checksum)
-    std::vector<uint8_t> data;
-    for (int i = IL2P_ENC_HEADER_OCTETS; i < d_frame_length - 4; i++)
-        data.push_back(d_frame_buffer[i]);
-
-    // Descramble data (IL2P uses scrambling)
-    std::vector<uint8_t> descrambled_data = descramble_data(data);
-
-    // Apply Reed-Solomon decoding
-    std::vector<uint8_t> decoded_data = apply_reed_solomon_decode(descrambled_data);
-
-    return decoded_data;
+    return changed;
 }
 
-bool il2p_decoder_impl::parse_il2p_header() {
-    if (d_frame_length < IL2P_ENC_HEADER_OCTETS) {
-        return false;
-    }
-
-    // Check IL2P preamble (0x55)
-    if (d_frame_buffer[0] != IL2P_PREAMBLE) {
-        return false;
-    }
+void il2p_decoder_impl::reset_hunt() {
+    d_state = STATE_HUNT;
+    d_sync_shift = 0;
+    d_sync_bits = 0;
+    d_bit_buffer = 0;
+    d_bit_count = 0;
+    d_frame_length = 0;
+}
 
-    // Check IL2P sync word (0xF15E48)
-    if (d_frame_buffer[1] != 0xF1 || d_frame_buffer[2] != 0x5E || d_frame_buffer[3] != 0x48) {
+bool il2p_decoder_impl::sync_word_detected() const {
+    if (d_sync_bits < 8 * IL2P_SYNC_WORD_SIZE)
         return false;
-    }
-
-    // FEC type follows sync (matches il2p_encoder_impl::add_il2p_header)
-    d_fec_type = d_frame_buffer[4];
-
-    initialize_reed_solomon();
-
-    return true;
+    const std::bitset<24> diff(d_sync_shift ^ static_cast<uint32_t>(IL2P_SYNC_WORD));
+    return static_cast<int>(diff.count()) <= IL2P_SYNC_MAX_BIT_ERRORS;
 }
 
-std::vector<uint8_t> il2p_decoder_impl::apply_reed_solomon_decode(
-    const std::vector<uint8_t>& data) {
-    if (!d_reed_solomon_decoder) {
-        return data;
-    }
-
-    std::vector<uint8_t> decoded_data;
-
-    // Process data in blocks
-    int block_size = d_reed_solomon_decoder->get_code_length();
-    int total_blocks = (data.size() + block_size - 1) / block_size;
-
-    for (int block = 0; block < total_blocks; block++) {
-        std::vector<uint8_t> block_data;
-
-        // Extract block data
-        for (int i = 0; i < block_size; i++) {
-            int index = block * block_size + i;
-            if (index < data.size()) {
-                block_data.push_back(data[index]);
-            } else {
-                block_data.push_back(0); // Padding
-            }
+void il2p_decoder_impl::process_bit(bool bit) {
+    switch (d_state) {
+    case STATE_HUNT:
+        d_sync_shift = ((d_sync_shift << 1) | (bit ? 1u : 0u)) & 0xFFFFFFu;
+        if (d_sync_bits < 8 * IL2P_SYNC_WORD_SIZE)
+            d_sync_bits++;
+        if (sync_word_detected()) {
+            d_state = STATE_HEADER;
+            d_bit_buffer = 0;
+            d_bit_count = 0;
+            d_frame_length = 0;
         }
+        break;
 
-        // Decode block
-        std::vector<uint8_t> decoded_block = d_reed_solomon_decoder->decode(block_data);
-
-        // Add to output
-        for (size_t i = 0; i < decoded_block.size(); i++) {
-            decoded_data.push_back(decoded_block[i]);
+    case STATE_HEADER:
+    case STATE_PAYLOAD:
+        d_bit_buffer = static_cast<uint8_t>((d_bit_buffer << 1) | (bit ? 1 : 0));
+        d_bit_count++;
+        if (d_bit_count < 8)
+            break;
+        d_frame_buffer[d_frame_length++] = d_bit_buffer;
+        d_bit_buffer = 0;
+        d_bit_count = 0;
+
+        if (d_state == STATE_HEADER) {
+            if (d_frame_length == IL2P_ENCODED_HEADER_SIZE)
+                header_complete();
+        } else if (d_frame_length == d_frame_end) {
+            d_state = STATE_FRAME_COMPLETE;
         }
-    }
-
-    return decoded_data;
-}
+        break;
 
-std::vector<uint8_t> il2p_decoder_impl::descramble_data(const std::vector<uint8_t>& data) {
-    // IL2P uses a simple XOR scrambler with polynomial 0x21 (x^5 + x^0)
-    // Descrambling is the same as scrambling (XOR is self-inverse)
-    std::vector<uint8_t> descrambled(data.size());
-    uint8_t scrambler_state = 0x1F; // Initial state (all ones)
-    
-    for (size_t i = 0; i < data.size(); i++) {
-        uint8_t output_bit = 0;
-        for (int bit = 0; bit < 8; bit++) {
-            // XOR feedback
-            uint8_t feedback = ((scrambler_state >> 4) ^ (scrambler_state >> 0)) & 0x01;
-            scrambler_state = ((scrambler_state << 1) | feedback) & 0x1F;
-            
-            // XOR with input bit (descrambling is same as scrambling)
-            uint8_t input_bit = (data[i] >> (7 - bit)) & 0x01;
-            output_bit |= ((input_bit ^ feedback) << (7 - bit));
-        }
-        descrambled[i] = output_bit;
+    case STATE_FRAME_COMPLETE:
+        // Frame is complete, will be handled in general_work()
+        break;
     }
-    
-    return descrambled;
 }
 
-bool il2p_decoder_impl::validate_checksum() {
-    if (d_frame_length < 4) {
-        return false;
+void il2p_decoder_impl::header_complete() {
+    if (!il2p_decode_header(d_codec, d_frame_buffer.data(), d_header)) {
+        // False sync or uncorrectable header: resume hunting on the following bits
+        reset_hunt();
+        return;
     }
-
-    uint32_t received_checksum =
-        d_frame_buffer[d_frame_length - 4] | (d_frame_buffer[d_frame_length - 3] << 8) |
-        (d_frame_buffer[d_frame_length - 2] << 16) | (d_frame_buffer[d_frame_length - 1] << 24);
-
-    uint32_t calculated_checksum = calculate_checksum();
-
-    return calculated_checksum == received_checksum;
+    d_layout = il2p_compute_payload_layout(d_header.payload_length, d_header.max_fec);
+    d_frame_crc = d_check_crc.load();
+    d_frame_end = IL2P_ENCODED_HEADER_SIZE + d_layout.encoded_length +
+                  (d_frame_crc ? IL2P_CRC_SIZE : 0);
+    d_state =
+        d_frame_end > IL2P_ENCODED_HEADER_SIZE ? STATE_PAYLOAD : STATE_FRAME_COMPLETE;
 }
 
-uint32_t il2p_decoder_impl::calculate_checksum() {
-    uint32_t checksum = 0xFFFFFFFF;
-
-    for (int i = 0; i < d_frame_length - 4; i++) {
-        checksum ^= d_frame_buffer[i];
-        for (int j = 0; j < 8; j++) {
-            if (checksum & 0x00000001) {
-                checksum = (checksum >> 1) ^ 0xEDB88320;
-            } else {
-                checksum = checksum >> 1;
-            }
-        }
+std::vector<uint8_t> il2p_decoder_impl::decode_il2p_frame() {
+    std::vector<uint8_t> frame;
+    if (d_layout.encoded_length > 0 &&
+        !d_payload_decoder.decode(
+            d_layout, d_frame_buffer.data() + IL2P_ENCODED_HEADER_SIZE, d_payload)) {
+        return frame;
+    }
+    if (d_layout.encoded_length == 0)
+        d_payload.clear();
+
+    // The AX.25 frame as the AX.25 decoder delivers it: header, information and FCS
+    if (!il2p_ax25_from_header(d_header, d_payload.data(), d_payload.size(), frame) ||
+        frame.size() > UINT16_MAX) {
+        return std::vector<uint8_t>();
     }
-
-    return checksum ^ 0xFFFFFFFF;
-}
-
-std::string il2p_decoder_impl::extract_callsign(int start_pos) {
-    std::string callsign;
-
-    for (int i = 0; i < 6; i++) {
-        char c = (d_frame_buffer[start_pos + i] >> 1) & 0x7F;
-        if (c != ' ') {
-            callsign += c;
-        }
+    const uint16_t fcs =
+        ax25_calculate_fcs(frame.data(), static_cast<uint16_t>(frame.size()));
+    if (d_frame_crc &&
+        il2p_decode_crc(d_frame_buffer.data() + IL2P_ENCODED_HEADER_SIZE +
+                        d_layout.encoded_length) != fcs) {
+        return std::vector<uint8_t>();
     }
-
-    return callsign;
-}
-
-int il2p_decoder_impl::extract_ssid(int pos) {
-    return (d_frame_buffer[pos] >> 1) & 0x0F;
+    frame.push_back(static_cast<uint8_t>(fcs & 0xFF));
+    frame.push_back(static_cast<uint8_t>(fcs >> 8));
+    return frame;
 }
 
 } /* namespace packet_protocols */
@@ -22,9 +22,13 @@
 #ifndef INCLUDED_PACKET_PROTOCOLS_IL2P_DECODER_IMPL_H
 #define INCLUDED_PACKET_PROTOCOLS_IL2P_DECODER_IMPL_H
 
+#include "il2p_frame.h"
+#include <gnuradio/packet_protocols/ax25_protocol.h>
 #include <gnuradio/packet_protocols/common.h> // Include common.h for ReedSolomonDecoder and FEC types
 #include <gnuradio/packet_protocols/il2p_decoder.h>
 #include <gnuradio/packet_protocols/il2p_protocol.h>
+#include <algorithm>
+#include <atomic>
 #include <deque>
 #include <string>
 #include <vector>
@@ -33,22 +37,37 @@ namespace gr {
 namespace packet_protocols {
 
 // State machine constants
-enum il2p_state_t { STATE_IDLE = 0, STATE_FLAG = 1, STATE_DATA = 2, STATE_FRAME_COMPLETE = 3 };
+enum il2p_state_t {
+    STATE_HUNT = 0,          //!< Searching the bitstream for the sync word
+    STATE_HEADER = 1,        //!< Collecting the RS-protected header
+    STATE_PAYLOAD = 2,       //!< Collecting the payload blocks (and CRC) of the header
+    STATE_FRAME_COMPLETE = 3
+};
 
 class il2p_decoder_impl : public il2p_decoder {
   private:
     il2p_state_t d_state;                       //!< Current state
+    uint32_t d_sync_shift;                      //!< Last 24 received bits
+    int d_sync_bits;                            //!< Bits shifted in since the last reset
     uint8_t d_bit_buffer;                       //!< Bit buffer for byte assembly
     uint8_t d_bit_count;                        //!< Number of bits in buffer
-    std::vector<uint8_t> d_frame_buffer;        //!< Frame buffer (fixed capacity)
+    std::vector<uint8_t> d_frame_buffer;        //!< Header, payload, CRC (fixed capacity)
     uint16_t d_frame_length;                    //!< Current frame length
-    uint8_t d_ones_count;                       //!< Consecutive ones count
-    int d_fec_type;                             //!< FEC type
-    ReedSolomonDecoder* d_reed_solomon_decoder; //!< Reed-Solomon decoder
+    size_t d_frame_end;                         //!< Frame length announced by the header
+    std::atomic<bool> d_check_crc;              //!< Expect the IL2P+CRC trailer
+    bool d_frame_crc;                           //!< The current frame has a trailer
+    il2p_header_fields d_header;                //!< Decoded header of the current frame
+    il2p_payload_layout d_layout;               //!< Payload layout from the header
+    il2p_block_codec d_codec;                   //!< Header RS codec
+    il2p_payload_decoder d_payload_decoder;     //!< Concurrent per-block payload decode
+    std::vector<uint8_t> d_payload;             //!< Decoded payload of the current frame
     std::deque<uint8_t> d_out_queue;            //!< Decoded bytes pending output
+    std::atomic<bool> d_dcd{ false };           //!< Carrier detect state
+    std::atomic<int> d_dcd_hold_off{ 64 };      //!< Bits after a frame before DCD drops
+    int d_dcd_countdown{ 0 };                   //!< Hold-off bits left; 0 = none pending
 
   public:
-    il2p_decoder_impl();
+    il2p_decoder_impl(bool check_crc);
     ~il2p_decoder_impl();
 
     void forecast(int noutput_items, gr_vector_int& ninput_items_required) override;
@@ -58,17 +77,20 @@ class il2p_decoder_impl : public il2p_decoder {
                      gr_vector_const_void_star& input_items,
                      gr_vector_void_star& output_items) override;
 
+    void set_dcd_hold_off(int bits) override { d_dcd_hold_off.store(std::max(bits, 1)); }
+    void set_check_crc(bool check_crc) override { d_check_crc.store(check_crc); }
+    bool dcd() const override { return d_dcd.load(); }
+
   private:
     void process_bit(bool bit);
-    void initialize_reed_solomon();
+    void reset_hunt();
+    bool sync_word_detected() const;
+    void header_complete();
+    //! The AX.25 frame (with FCS) rebuilt from the header and payload; empty on failure,
+    //! including a frame that does not match its IL2P+CRC trailer
     std::vector<uint8_t> decode_il2p_frame();
-    bool parse_il2p_header();
-    std::vector<uint8_t> apply_reed_solomon_decode(const std::vector<uint8_t>& data);
-    std::vector<uint8_t> descramble_data(const std::vector<uint8_t>& data);
-    bool validate_checksum();
-    uint32_t calculate_checksum();
-    std::string extract_callsign(int start_pos);
-    int extract_ssid(int pos);
+    //! Track DCD across one bit's state transition; true if it changed
+    bool update_dcd(il2p_state_t before, il2p_state_t after);
 };
 
 } // namespace packet_protocols
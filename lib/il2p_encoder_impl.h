@@ -22,6 +22,9 @@
 #ifndef INCLUDED_PACKET_PROTOCOLS_IL2P_ENCODER_IMPL_H
 #define INCLUDED_PACKET_PROTOCOLS_IL2P_ENCODER_IMPL_H
 
+#include "il2p_frame.h"
+#include "kiss_codec.h"
+#include <gnuradio/packet_protocols/ax25_protocol.h>
 #include <gnuradio/packet_protocols/common.h>
 #include <gnuradio/packet_protocols/il2p_encoder.h>
 #include <gnuradio/packet_protocols/il2p_protocol.h>
@@ -31,41 +34,40 @@
 namespace gr {
 namespace packet_protocols {
 
+//! Longest KISS data frame encoded: type byte, two addresses, control, PID, information
+static const size_t IL2P_MAX_KISS_FRAME = 1 + 14 + 2 + IL2P_MAX_PAYLOAD_SIZE;
+
 /*!
  * \brief IL2P Encoder Implementation
  * \ingroup packet_protocols
  *
- * This class implements IL2P packet encoding using the real
- * IL2P protocol implementation from gr-m17.
+ * Reads AX.25 frames as KISS data frames from the input byte stream and emits one
+ * IL2P frame per AX.25 frame as an unstuffed bitstream (MSB first): preamble, 24-bit
+ * sync word, RS-protected 13-byte header translated from the AX.25 header, then
+ * scrambled RS payload blocks, and the IL2P+CRC trailer if enabled. No HDLC flags.
  */
 class il2p_encoder_impl : public il2p_encoder {
   private:
-    std::string d_dest_callsign;                //!< Destination callsign
-    std::string d_dest_ssid;                    //!< Destination SSID
-    std::string d_src_callsign;                 //!< Source callsign
-    std::string d_src_ssid;                     //!< Source SSID
     int d_fec_type;                             //!< FEC type
-    bool d_add_checksum;                        //!< Add checksum flag
-    std::vector<uint8_t> d_frame_buffer;        //!< Frame buffer (HDLC flags + interior)
-    uint16_t d_frame_length;                    //!< Current frame length (interior; for checksum)
-    std::vector<uint8_t> d_bit_queue;           //!< Serialized stuffed bits for general_work
+    bool d_add_checksum;                        //!< Append the IL2P+CRC trailer
+    std::vector<uint8_t> d_frame_buffer;        //!< Frame octets (preamble through trailer)
+    std::vector<uint8_t> d_bit_queue;           //!< Serialized bits for general_work
     size_t d_bit_q_read;                        //!< Read index into d_bit_queue
-
-    ReedSolomonEncoder* d_reed_solomon_encoder; //!< Reed-Solomon encoder
+    il2p_block_codec d_codec;                   //!< Header/payload RS codec
+    kiss_unescaper d_unescaper;                 //!< AX.25 frames from the KISS input
 
     static void push_msb_bits_raw(uint8_t byte, std::vector<uint8_t>& q);
-    static void push_msb_bits_stuffed(uint8_t byte, std::vector<uint8_t>& q, int& ones_run);
-    void rebuild_bit_queue_from_frame();
+    void append_frame_bits();
 
   public:
     /*!
      * \brief Constructor
-     * \param dest_callsign Destination callsign
-     * \param dest_ssid Destination SSID
-     * \param src_callsign Source callsign
-     * \param src_ssid Source SSID
-     * \param fec_type FEC type
-     * \param add_checksum Add checksum flag
+     * \param dest_callsign Unused: addresses come from each AX.25 frame
+     * \param dest_ssid Unused
+     * \param src_callsign Unused
+     * \param src_ssid Unused
+     * \param fec_type FEC type (IL2P_FEC_RS_255_223 selects max FEC)
+     * \param add_checksum Append the IL2P+CRC trailer after the payload blocks
      */
     il2p_encoder_impl(const std::string& dest_callsign, const std::string& dest_ssid,
                       const std::string& src_callsign, const std::string& src_ssid, int fec_type,
@@ -97,48 +99,23 @@ class il2p_encoder_impl : public il2p_encoder {
 
   private:
     /*!
-     * \brief Initialize Reed-Solomon encoder
-     */
-    void initialize_reed_solomon();
-
-    /*!
-     * \brief Build IL2P frame
-     * \param data_byte Input data byte
-     */
-    void build_il2p_frame(char data_byte);
-
-    /*!
-     * \brief Add IL2P header to frame
-     */
-    void add_il2p_header();
-
-    /*!
-     * \brief Add address to frame
-     * \param callsign Callsign
-     * \param ssid SSID
-     * \param is_last Is last address flag
-     */
-    void add_address(const std::string& callsign, const std::string& ssid, bool is_last);
-
-    /*!
-     * \brief Apply Reed-Solomon FEC to data
-     * \param data Input data
-     * \return FEC encoded data
+     * \brief Encode the AX.25 frame of a KISS data frame
+     * \param frame Type byte and data
+     * \param length Frame length
      */
-    std::vector<uint8_t> apply_reed_solomon_fec(const std::vector<uint8_t>& data);
+    void handle_kiss_frame(const uint8_t* frame, size_t length);
 
     /*!
-     * \brief Calculate checksum for frame
-     * \return Calculated checksum
+     * \brief Build one IL2P frame and queue its bits
+     * \param ax25_frame AX.25 frame without FCS
+     * \param length Frame length
      */
-    uint32_t calculate_checksum();
+    void build_il2p_frame(const uint8_t* ax25_frame, size_t length);
 
     /*!
-     * \brief Scramble data (IL2P scrambling)
-     * \param data Input data
-     * \return Scrambled data
+     * \brief Whether the configured FEC type selects IL2P max FEC (16 parity per block)
      */
-    std::vector<uint8_t> scramble_data(const std::vector<uint8_t>& data);
+    bool max_fec() const;
 };
 
 } // namespace packet_protocols
@@ -0,0 +1,564 @@
+/*
+ * Copyright 2024 gr-packet-protocols
+ *
+ * This file is part of gr-packet-protocols
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "il2p_frame.h"
+#include "il2p_scrambler.h"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace gr {
+namespace packet_protocols {
+
+namespace {
+
+// IL2P PID codes 0x2..0xF; 0x0 (supervisory) and 0x1 (unnumbered) carry no PID octet
+const uint8_t k_pid_by_code[16] = { 0x00, 0x00, 0x20, 0x01, 0x06, 0x07, 0x08, 0xC3,
+                                    0xC4, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF, 0xF0 };
+
+// AX.25 U frame control octets (P/F clear) by IL2P opcode; UI (5) has its own header bit
+const uint8_t k_u_control_by_opcode[8] = { 0x2F, 0x43, 0x0F, 0x63,
+                                           0x87, 0x03, 0xAF, 0xE3 };
+const int IL2P_OPCODE_UI = 5;
+
+const int AX25_ADDRESS_LENGTH = 7;
+
+// Hamming(7,4) codewords of the IL2P+CRC trailer: data in bits 3..0, parity in 6..4
+const uint8_t k_hamming_encode[16] = { 0x00, 0x71, 0x62, 0x13, 0x54, 0x25, 0x36, 0x47,
+                                       0x38, 0x49, 0x5A, 0x2B, 0x6C, 0x1D, 0x0E, 0x7F };
+
+const int IL2P_MAX_BLOCK_DATA_MAX_FEC = 239;
+const int IL2P_MAX_BLOCK_DATA_NORMAL = 247;
+
+// IL2P's RS generator has roots alpha^0 .. alpha^(nroots - 1) (FX.25 starts at alpha^1)
+const unsigned IL2P_RS_FCR = 0;
+
+bool encode_sixbit(const std::string& callsign, uint8_t* out)
+{
+    if (callsign.size() > 6)
+        return false;
+    for (size_t i = 0; i < 6; i++) {
+        char c = i < callsign.size() ? callsign[i] : ' ';
+        if (c >= 'a' && c <= 'z')
+            c = static_cast<char>(c - 'a' + 'A');
+        if (c < 0x20 || c > 0x5F)
+            return false;
+        out[i] = static_cast<uint8_t>(c - 0x20);
+    }
+    return true;
+}
+
+std::string decode_sixbit(const uint8_t* in)
+{
+    std::string callsign;
+    for (int i = 0; i < 6; i++) {
+        const char c = static_cast<char>((in[i] & 0x3F) + 0x20);
+        if (c != ' ')
+            callsign += c;
+    }
+    return callsign;
+}
+
+// Callsign of an AX.25 address field if it survives SIXBIT (no lower case, no spaces
+// but the trailing padding)
+bool ax25_callsign(const uint8_t* field, std::string& callsign)
+{
+    callsign.clear();
+    bool padding = false;
+    for (int i = 0; i < 6; i++) {
+        const char c = static_cast<char>(field[i] >> 1);
+        if (c < 0x20 || c > 0x5F || (padding && c != ' '))
+            return false;
+        if (c == ' ')
+            padding = true;
+        else
+            callsign += c;
+    }
+    return true;
+}
+
+void append_ax25_address(std::vector<uint8_t>& frame,
+                         const std::string& callsign,
+                         uint8_t ssid,
+                         bool c_bit,
+                         bool last)
+{
+    for (size_t i = 0; i < 6; i++) {
+        const char c = i < callsign.size() ? callsign[i] : ' ';
+        frame.push_back(static_cast<uint8_t>(c << 1));
+    }
+    frame.push_back(static_cast<uint8_t>((c_bit ? 0x80 : 0x00) | 0x60 |
+                                         ((ssid & 0x0F) << 1) | (last ? 0x01 : 0x00)));
+}
+
+// Type 1 fields for a frame with two addresses, or false if it needs a type 0 header
+bool type1_fields(const uint8_t* frame, size_t length, il2p_header_fields& fields,
+                  size_t& info_offset)
+{
+    if (length < 2 * AX25_ADDRESS_LENGTH + 1 || (frame[6] & 0x01) || !(frame[13] & 0x01))
+        return false;
+    if (!ax25_callsign(frame, fields.dest_callsign) ||
+        !ax25_callsign(frame + AX25_ADDRESS_LENGTH, fields.src_callsign))
+        return false;
+    fields.dest_ssid = static_cast<uint8_t>((frame[6] >> 1) & 0x0F);
+    fields.src_ssid = static_cast<uint8_t>((frame[13] >> 1) & 0x0F);
+    // Command: C set in the destination and clear in the source; v1 frames count as one
+    const bool command = (frame[6] & 0x80) || !(frame[13] & 0x80);
+
+    const uint8_t control = frame[14];
+    const uint8_t pf = (control >> 4) & 0x01;
+    const uint8_t nr = (control >> 5) & 0x07;
+    const uint8_t c_bit = command ? 0x04 : 0x00;
+    info_offset = 2 * AX25_ADDRESS_LENGTH + 1;
+    fields.ui = false;
+    if ((control & 0x01) == 0) {
+        if (!command || length < info_offset + 1)
+            return false;
+        fields.pid_code = il2p_pid_to_code(frame[info_offset++]);
+        fields.control =
+            static_cast<uint8_t>((pf << 6) | (nr << 3) | ((control >> 1) & 0x07));
+        return fields.pid_code != 0;
+    }
+    if ((control & 0x03) == 0x01) {
+        fields.pid_code = 0;
+        fields.control = static_cast<uint8_t>((pf << 6) | (nr << 3) | c_bit |
+                                              ((control >> 2) & 0x03));
+        return true;
+    }
+
+    const uint8_t* opcode = std::find(std::begin(k_u_control_by_opcode),
+                                      std::end(k_u_control_by_opcode),
+                                      static_cast<uint8_t>(control & ~0x10));
+    if (opcode == std::end(k_u_control_by_opcode))
+        return false;
+    if (opcode - k_u_control_by_opcode == IL2P_OPCODE_UI) {
+        if (length < info_offset + 1)
+            return false;
+        fields.ui = true;
+        fields.pid_code = il2p_pid_to_code(frame[info_offset++]);
+        fields.control = static_cast<uint8_t>((pf << 6) | c_bit);
+        return fields.pid_code != 0;
+    }
+    fields.pid_code = 1;
+    fields.control =
+        static_cast<uint8_t>((pf << 6) | ((opcode - k_u_control_by_opcode) << 3) | c_bit);
+    return true;
+}
+
+int normal_fec_parity(int block_size)
+{
+    if (block_size <= 61)
+        return 2;
+    if (block_size <= 123)
+        return 4;
+    if (block_size <= 185)
+        return 6;
+    return 8;
+}
+
+// Correct and descramble one block of \p encoded into its slot in \p data
+bool decode_block(il2p_block_codec& codec,
+                  std::vector<uint8_t>& scratch,
+                  const il2p_payload_layout& layout,
+                  const uint8_t* encoded,
+                  int block,
+                  uint8_t* data)
+{
+    const size_t n = layout.data_size(block);
+    const uint8_t* src = encoded + layout.encoded_offset(block);
+    scratch.assign(src, src + n + static_cast<size_t>(layout.parity_per_block));
+    if (!codec.decode(scratch.data(), n, layout.parity_per_block))
+        return false;
+    il2p_descramble_inplace(scratch.data(), n);
+    std::memcpy(data + layout.data_offset(block), scratch.data(), n);
+    return true;
+}
+
+} // namespace
+
+uint8_t il2p_pid_to_code(uint8_t pid)
+{
+    for (uint8_t code = 2; code < 16; code++) {
+        if (k_pid_by_code[code] == pid)
+            return code;
+    }
+    return 0;
+}
+
+uint8_t il2p_code_to_pid(uint8_t code) { return k_pid_by_code[code & 0x0F]; }
+
+bool il2p_pack_header(const il2p_header_fields& fields, uint8_t* header)
+{
+    if (fields.payload_length > IL2P_MAX_PAYLOAD_SIZE)
+        return false;
+    if (fields.type1) {
+        if (!encode_sixbit(fields.dest_callsign, header) ||
+            !encode_sixbit(fields.src_callsign, header + 6))
+            return false;
+        header[12] = static_cast<uint8_t>(((fields.dest_ssid & 0x0F) << 4) |
+                                          (fields.src_ssid & 0x0F));
+
+        header[0] |= fields.ui ? 0x40 : 0x00;
+        for (int i = 0; i < 4; i++)
+            header[1 + i] |=
+                static_cast<uint8_t>(((fields.pid_code >> (3 - i)) & 1) << 6);
+        for (int i = 0; i < 7; i++)
+            header[5 + i] |= static_cast<uint8_t>(((fields.control >> (6 - i)) & 1) << 6);
+        header[1] |= 0x80; // header type 1
+    }
+
+    header[0] |= fields.max_fec ? 0x80 : 0x00;
+    for (int i = 0; i < 10; i++)
+        header[2 + i] |= static_cast<uint8_t>(((fields.payload_length >> (9 - i)) & 1) << 7);
+    return true;
+}
+
+bool il2p_unpack_header(const uint8_t* header, il2p_header_fields& fields)
+{
+    fields = il2p_header_fields();
+    fields.type1 = (header[1] & 0x80) != 0;
+    if (fields.type1) {
+        fields.dest_callsign = decode_sixbit(header);
+        fields.src_callsign = decode_sixbit(header + 6);
+        fields.dest_ssid = static_cast<uint8_t>(header[12] >> 4);
+        fields.src_ssid = static_cast<uint8_t>(header[12] & 0x0F);
+
+        fields.ui = (header[0] & 0x40) != 0;
+        fields.pid_code = 0;
+        for (int i = 0; i < 4; i++)
+            fields.pid_code = static_cast<uint8_t>((fields.pid_code << 1) |
+                                                   ((header[1 + i] >> 6) & 1));
+        for (int i = 0; i < 7; i++)
+            fields.control =
+                static_cast<uint8_t>((fields.control << 1) | ((header[5 + i] >> 6) & 1));
+    } else {
+        fields.ui = false;
+    }
+
+    fields.max_fec = (header[0] & 0x80) != 0;
+    uint16_t count = 0;
+    for (int i = 0; i < 10; i++)
+        count = static_cast<uint16_t>((count << 1) | (header[2 + i] >> 7));
+    fields.payload_length = count;
+    return count <= IL2P_MAX_PAYLOAD_SIZE;
+}
+
+bool il2p_header_from_ax25(const uint8_t* frame,
+                           size_t length,
+                           il2p_header_fields& fields,
+                           const uint8_t*& payload,
+                           size_t& payload_length)
+{
+    // The address block ends at the first E bit
+    size_t addresses = 0;
+    while ((addresses + 1) * AX25_ADDRESS_LENGTH <= length &&
+           !(frame[(addresses + 1) * AX25_ADDRESS_LENGTH - 1] & 0x01))
+        addresses++;
+    if ((addresses + 1) * AX25_ADDRESS_LENGTH >= length || addresses + 1 < 2)
+        return false;
+
+    const bool max_fec = fields.max_fec;
+    fields = il2p_header_fields();
+    fields.max_fec = max_fec;
+    size_t info_offset = 0;
+    if (addresses + 1 == 2 && type1_fields(frame, length, fields, info_offset)) {
+        payload = frame + info_offset;
+        payload_length = length - info_offset;
+    } else {
+        fields = il2p_header_fields();
+        fields.max_fec = max_fec;
+        fields.type1 = false;
+        fields.ui = false;
+        payload = frame;
+        payload_length = length;
+    }
+    if (payload_length > IL2P_MAX_PAYLOAD_SIZE)
+        return false;
+    fields.payload_length = static_cast<uint16_t>(payload_length);
+    return true;
+}
+
+bool il2p_ax25_from_header(const il2p_header_fields& fields,
+                           const uint8_t* payload,
+                           size_t payload_length,
+                           std::vector<uint8_t>& frame)
+{
+    frame.clear();
+    if (!fields.type1) {
+        frame.assign(payload, payload + payload_length);
+        return true;
+    }
+
+    const uint8_t control = fields.control;
+    const uint8_t pf = static_cast<uint8_t>(((control >> 6) & 0x01) << 4);
+    const uint8_t nr = (control >> 3) & 0x07;
+    const bool i_frame = !fields.ui && fields.pid_code > 1;
+    const bool command = i_frame || (control & 0x04);
+    append_ax25_address(frame, fields.dest_callsign, fields.dest_ssid, command, false);
+    append_ax25_address(frame, fields.src_callsign, fields.src_ssid, !command, true);
+
+    if (fields.ui) {
+        if (fields.pid_code < 2)
+            return false;
+        frame.push_back(static_cast<uint8_t>(k_u_control_by_opcode[IL2P_OPCODE_UI] | pf));
+        frame.push_back(il2p_code_to_pid(fields.pid_code));
+    } else if (fields.pid_code == 0) {
+        frame.push_back(
+            static_cast<uint8_t>((nr << 5) | pf | ((control & 0x03) << 2) | 0x01));
+    } else if (fields.pid_code == 1) {
+        frame.push_back(static_cast<uint8_t>(k_u_control_by_opcode[nr] | pf));
+    } else {
+        frame.push_back(static_cast<uint8_t>((nr << 5) | pf | ((control & 0x07) << 1)));
+        frame.push_back(il2p_code_to_pid(fields.pid_code));
+    }
+    frame.insert(frame.end(), payload, payload + payload_length);
+    return true;
+}
+
+void il2p_encode_crc(uint16_t crc, uint8_t* trailer)
+{
+    for (int i = 0; i < IL2P_CRC_SIZE; i++)
+        trailer[i] = k_hamming_encode[(crc >> (12 - 4 * i)) & 0x0F];
+}
+
+uint16_t il2p_decode_crc(const uint8_t* trailer)
+{
+    uint16_t crc = 0;
+    for (int i = 0; i < IL2P_CRC_SIZE; i++) {
+        // The code is perfect: every 7-bit word is within one bit of one codeword
+        const uint8_t received = trailer[i] & 0x7F;
+        uint8_t nibble = 0;
+        for (uint8_t d = 0; d < 16; d++) {
+            const uint8_t diff = static_cast<uint8_t>(received ^ k_hamming_encode[d]);
+            if ((diff & (diff - 1)) == 0) {
+                nibble = d;
+                break;
+            }
+        }
+        crc = static_cast<uint16_t>((crc << 4) | nibble);
+    }
+    return crc;
+}
+
+size_t il2p_payload_layout::data_size(int block) const
+{
+    return static_cast<size_t>(small_block_size + (block < large_block_count ? 1 : 0));
+}
+
+size_t il2p_payload_layout::data_offset(int block) const
+{
+    return static_cast<size_t>(block * small_block_size + std::min(block, large_block_count));
+}
+
+size_t il2p_payload_layout::encoded_offset(int block) const
+{
+    return data_offset(block) + static_cast<size_t>(block * parity_per_block);
+}
+
+il2p_payload_layout il2p_compute_payload_layout(size_t payload_length, bool max_fec)
+{
+    il2p_payload_layout layout;
+    layout.payload_length = payload_length;
+    if (payload_length == 0)
+        return layout;
+
+    const int length = static_cast<int>(payload_length);
+    const int max_block = max_fec ? IL2P_MAX_BLOCK_DATA_MAX_FEC : IL2P_MAX_BLOCK_DATA_NORMAL;
+    layout.block_count = (length + max_block - 1) / max_block;
+    layout.small_block_size = length / layout.block_count;
+    layout.large_block_count = length % layout.block_count;
+    layout.parity_per_block =
+        max_fec ? IL2P_MAX_PARITY_SYMBOLS : normal_fec_parity(layout.small_block_size);
+    layout.encoded_length =
+        payload_length + static_cast<size_t>(layout.block_count * layout.parity_per_block);
+    return layout;
+}
+
+ReedSolomonEncoder& il2p_block_codec::encoder(int nroots)
+{
+    if (!d_encoders[nroots])
+        d_encoders[nroots].reset(new ReedSolomonEncoder(255, 255 - nroots, IL2P_RS_FCR));
+    return *d_encoders[nroots];
+}
+
+ReedSolomonDecoder& il2p_block_codec::decoder(int nroots)
+{
+    if (!d_decoders[nroots])
+        d_decoders[nroots].reset(new ReedSolomonDecoder(255, 255 - nroots, IL2P_RS_FCR));
+    return *d_decoders[nroots];
+}
+
+void il2p_block_codec::encode(const uint8_t* data, size_t length, int nroots, uint8_t* parity)
+{
+    const size_t k = static_cast<size_t>(255 - nroots);
+    d_work.assign(k, 0);
+    std::memcpy(d_work.data() + (k - length), data, length);
+    const std::vector<uint8_t> codeword = encoder(nroots).encode(d_work);
+    std::memcpy(parity, codeword.data() + k, static_cast<size_t>(nroots));
+}
+
+bool il2p_block_codec::decode(uint8_t* block, size_t length, int nroots)
+{
+    const size_t k = static_cast<size_t>(255 - nroots);
+    const size_t pad = k - length;
+    d_work.assign(255, 0);
+    std::memcpy(d_work.data() + pad, block, length + static_cast<size_t>(nroots));
+    if (!decoder(nroots).decode(d_work, d_out))
+        return false;
+    for (size_t i = 0; i < pad; i++) {
+        if (d_out[i] != 0)
+            return false; // correction landed in the virtual zero fill
+    }
+    std::memcpy(block, d_out.data() + pad, length);
+    return true;
+}
+
+bool il2p_encode_header(il2p_block_codec& codec,
+                        const il2p_header_fields& fields,
+                        uint8_t* encoded)
+{
+    std::memset(encoded, 0, IL2P_ENCODED_HEADER_SIZE);
+    if (!il2p_pack_header(fields, encoded))
+        return false;
+    il2p_scramble_inplace(encoded, IL2P_HEADER_SIZE);
+    codec.encode(encoded, IL2P_HEADER_SIZE, IL2P_HEADER_PARITY, encoded + IL2P_HEADER_SIZE);
+    return true;
+}
+
+bool il2p_decode_header(il2p_block_codec& codec,
+                        const uint8_t* encoded,
+                        il2p_header_fields& fields)
+{
+    uint8_t header[IL2P_ENCODED_HEADER_SIZE];
+    std::memcpy(header, encoded, sizeof(header));
+    if (!codec.decode(header, IL2P_HEADER_SIZE, IL2P_HEADER_PARITY))
+        return false;
+    il2p_descramble_inplace(header, IL2P_HEADER_SIZE);
+    return il2p_unpack_header(header, fields);
+}
+
+void il2p_encode_payload(il2p_block_codec& codec,
+                         const il2p_payload_layout& layout,
+                         const uint8_t* data,
+                         std::vector<uint8_t>& out)
+{
+    for (int b = 0; b < layout.block_count; b++) {
+        const size_t n = layout.data_size(b);
+        const size_t start = out.size();
+        out.insert(out.end(), data, data + n);
+        out.resize(start + n + static_cast<size_t>(layout.parity_per_block));
+        il2p_scramble_inplace(out.data() + start, n);
+        codec.encode(out.data() + start, n, layout.parity_per_block, out.data() + start + n);
+        data += n;
+    }
+}
+
+bool il2p_decode_payload(il2p_block_codec& codec,
+                         const il2p_payload_layout& layout,
+                         const uint8_t* encoded,
+                         std::vector<uint8_t>& data)
+{
+    data.resize(layout.payload_length);
+    std::vector<uint8_t> block;
+    for (int b = 0; b < layout.block_count; b++) {
+        if (!decode_block(codec, block, layout, encoded, b, data.data()))
+            return false;
+    }
+    return true;
+}
+
+il2p_payload_decoder::il2p_payload_decoder() {}
+
+il2p_payload_decoder::~il2p_payload_decoder()
+{
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        d_stop = true;
+    }
+    d_work_cv.notify_all();
+    for (auto& thread : d_threads)
+        thread.join();
+}
+
+void il2p_payload_decoder::start_workers()
+{
+    const unsigned cpus = std::thread::hardware_concurrency();
+    const int count = std::min(IL2P_MAX_PAYLOAD_BLOCKS - 1, static_cast<int>(cpus) - 1);
+    for (int i = 0; i < count; i++)
+        d_threads.emplace_back(&il2p_payload_decoder::worker_loop, this, i + 1);
+}
+
+void il2p_payload_decoder::decode_blocks(worker_state& state)
+{
+    int b;
+    while ((b = d_next_block.fetch_add(1)) < d_layout->block_count) {
+        if (d_failed.load(std::memory_order_relaxed))
+            return;
+        if (!decode_block(state.codec, state.block, *d_layout, d_encoded, b, d_output))
+            d_failed.store(true, std::memory_order_relaxed);
+    }
+}
+
+void il2p_payload_decoder::worker_loop(int index)
+{
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(d_mutex);
+    while (true) {
+        d_work_cv.wait(lock, [&] { return d_stop || d_generation != seen; });
+        if (d_stop)
+            return;
+        seen = d_generation;
+        if (index > d_active)
+            continue;
+
+        lock.unlock();
+        decode_blocks(d_states[index]);
+        lock.lock();
+        if (--d_pending == 0)
+            d_done_cv.notify_one();
+    }
+}
+
+bool il2p_payload_decoder::decode(const il2p_payload_layout& layout,
+                                  const uint8_t* encoded,
+                                  std::vector<uint8_t>& data)
+{
+    if (layout.block_count > 1 && d_threads.empty())
+        start_workers();
+
+    data.resize(layout.payload_length);
+    d_layout = &layout;
+    d_encoded = encoded;
+    d_output = data.data();
+    d_next_block.store(0);
+    d_failed.store(false);
+
+    const int helpers = std::min(layout.block_count - 1, static_cast<int>(d_threads.size()));
+    if (helpers <= 0) {
+        decode_blocks(d_states[0]);
+        return !d_failed.load();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        d_active = helpers;
+        d_pending = helpers;
+        d_generation++;
+    }
+    d_work_cv.notify_all();
+    decode_blocks(d_states[0]);
+
+    std::unique_lock<std::mutex> lock(d_mutex);
+    d_done_cv.wait(lock, [&] { return d_pending == 0; });
+    return !d_failed.load();
+}
+
+} // namespace packet_protocols
+} // namespace gr
@@ -0,0 +1,223 @@
+/*
+ * Copyright 2024 gr-packet-protocols
+ *
+ * This file is part of gr-packet-protocols
+ */
+
+#ifndef INCLUDED_PACKET_PROTOCOLS_IL2P_FRAME_H
+#define INCLUDED_PACKET_PROTOCOLS_IL2P_FRAME_H
+
+#include <gnuradio/packet_protocols/common.h>
+#include <gnuradio/packet_protocols/il2p_protocol.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gr {
+namespace packet_protocols {
+
+// On-air IL2P frame (no HDLC flags, no bit stuffing):
+//   [0x55 preamble][F1 5E 48 sync][13-byte header + 2 RS parity][payload blocks]
+//
+// Type 1 header layout (bits 5..0 of octets 0..11 carry SIXBIT callsigns):
+//   octets 0..5   destination callsign     octet 12  dest SSID << 4 | src SSID
+//   octets 6..11  source callsign
+//   bit 6: octet 0 = UI, octets 1..4 = PID code, octets 5..11 = control (7 bits)
+//   bit 7: octet 0 = max FEC, octet 1 = header type (1), octets 2..11 = payload
+//          byte count (10 bits, MSB first)
+// A type 0 header only carries max FEC, the header type (0) and the count; its
+// payload is a whole AX.25 frame. The header is scrambled and then protected by
+// RS(15,13); each payload block is scrambled independently and carries its own RS
+// parity.
+//
+// Frames follow the IL2P specification: the x^9 + x^4 + 1 scrambler of
+// il2p_scrambler.h, and RS over GF(2^8) (x^8 + x^4 + x^3 + x^2 + 1) whose generator
+// has first consecutive root 0, so they interoperate with other IL2P modems.
+//
+// With IL2P+CRC, the frame ends in a 4-byte trailer after the last payload block (or
+// the header): the AX.25 FCS (CRC-16-CCITT) of the frame the header and payload stand
+// for, each nibble coded as one Hamming(7,4) byte, most significant nibble first.
+// It is neither scrambled nor RS protected; a byte survives one bit error.
+//
+// Payloads are split into balanced blocks: block_count = ceil(len / max_block)
+// (239 data bytes with max FEC, 247 otherwise), every block holds len / count
+// bytes and the first len % count blocks one byte more. Normal FEC parity is
+// chosen from the small block size.
+
+static const int IL2P_SYNC_MAX_BIT_ERRORS = 1; //!< Tolerated bit errors in the sync word
+static const int IL2P_ENCODED_HEADER_SIZE = IL2P_HEADER_SIZE + IL2P_HEADER_PARITY;
+static const int IL2P_CRC_SIZE = 4; //!< IL2P+CRC trailer
+
+struct il2p_header_fields {
+    std::string dest_callsign;
+    uint8_t dest_ssid{ 0 };
+    std::string src_callsign;
+    uint8_t src_ssid{ 0 };
+    bool type1{ true };     //!< false: type 0, the payload is a whole AX.25 frame
+    bool ui{ true };
+    uint8_t pid_code{ 0xF }; //!< 0 S frame, 1 U frame, 2..15 PID (il2p_code_to_pid)
+    uint8_t control{ 0 };    //!< 7-bit IL2P control field
+    bool max_fec{ false };
+    uint16_t payload_length{ 0 };
+};
+
+//! AX.25 PID octet <-> 4-bit IL2P PID code (0 if the PID has no IL2P code)
+uint8_t il2p_pid_to_code(uint8_t pid);
+uint8_t il2p_code_to_pid(uint8_t code);
+
+//! Pack / unpack the unscrambled 13-byte type 0 or type 1 header
+bool il2p_pack_header(const il2p_header_fields& fields, uint8_t* header);
+bool il2p_unpack_header(const uint8_t* header, il2p_header_fields& fields);
+
+// AX.25 frames (address block, control, PID, information; no FCS, as KISS carries
+// them) and IL2P headers. A frame with two addresses whose callsigns are SIXBIT and a
+// modulo-8 control field translates into a type 1 header, and only its information
+// field is sent as payload:
+//   I frame   control = P/F, N(R), N(S)       PID code of its PID
+//   S frame   control = P/F, N(R), C, SS      PID code 0
+//   U frame   control = P/F, opcode, C, 00    PID code 1 (SABM, DISC, DM, UA, FRMR,
+//                                             XID, TEST)
+//   UI frame  control = P/F, 000, C, 00       UI bit, PID code of its PID
+// C is set for commands (I frames always are). Anything else (digipeaters, SABME,
+// PIDs without a code, a responding I frame) is sent whole under a type 0 header.
+
+/*!
+ * \brief Fill \p fields (but for max_fec) from an AX.25 frame.
+ * \param payload Set to the bytes to send: the information field or the whole frame
+ * \return false if the frame is malformed or the payload exceeds IL2P_MAX_PAYLOAD_SIZE
+ */
+bool il2p_header_from_ax25(const uint8_t* frame,
+                           size_t length,
+                           il2p_header_fields& fields,
+                           const uint8_t*& payload,
+                           size_t& payload_length);
+
+//! Rebuild the AX.25 frame a header and its payload carry (no FCS)
+bool il2p_ax25_from_header(const il2p_header_fields& fields,
+                           const uint8_t* payload,
+                           size_t payload_length,
+                           std::vector<uint8_t>& frame);
+
+//! IL2P+CRC trailer for \p crc (IL2P_CRC_SIZE bytes)
+void il2p_encode_crc(uint16_t crc, uint8_t* trailer);
+//! CRC carried by a trailer, one bit error per byte corrected
+uint16_t il2p_decode_crc(const uint8_t* trailer);
+
+//! Payload block layout implied by the header (payload length and FEC mode)
+struct il2p_payload_layout {
+    int block_count{ 0 };
+    int small_block_size{ 0 };  //!< Data bytes in the shorter blocks
+    int large_block_count{ 0 }; //!< Leading blocks carrying small_block_size + 1 bytes
+    int parity_per_block{ 0 };
+    size_t payload_length{ 0 };
+    size_t encoded_length{ 0 };
+
+    size_t data_size(int block) const;
+    size_t data_offset(int block) const;    //!< Offset of the block in the payload
+    size_t encoded_offset(int block) const; //!< Offset of the block in the encoded payload
+};
+
+il2p_payload_layout il2p_compute_payload_layout(size_t payload_length, bool max_fec);
+
+/*!
+ * \brief Shortened RS(len + nroots, len) codec over the shared RS(255, k) implementation,
+ *        with the IL2P generator (first consecutive root 0).
+ *
+ * Short blocks are zero-extended at the front to a full 255-symbol codeword; the
+ * zeros are never transmitted. Encoders/decoders are cached per parity count.
+ */
+class il2p_block_codec
+{
+  public:
+    void encode(const uint8_t* data, size_t length, int nroots, uint8_t* parity);
+    bool decode(uint8_t* block, size_t length, int nroots);
+
+  private:
+    ReedSolomonEncoder& encoder(int nroots);
+    ReedSolomonDecoder& decoder(int nroots);
+
+    std::unique_ptr<ReedSolomonEncoder> d_encoders[IL2P_MAX_PARITY_SYMBOLS + 1];
+    std::unique_ptr<ReedSolomonDecoder> d_decoders[IL2P_MAX_PARITY_SYMBOLS + 1];
+    std::vector<uint8_t> d_work;
+    std::vector<uint8_t> d_out;
+};
+
+//! Header: scramble + RS parity into IL2P_ENCODED_HEADER_SIZE bytes
+bool il2p_encode_header(il2p_block_codec& codec,
+                        const il2p_header_fields& fields,
+                        uint8_t* encoded);
+//! Header: RS correct + descramble + unpack
+bool il2p_decode_header(il2p_block_codec& codec,
+                        const uint8_t* encoded,
+                        il2p_header_fields& fields);
+
+//! Payload: append scrambled, RS-protected blocks for \p data to \p out
+void il2p_encode_payload(il2p_block_codec& codec,
+                         const il2p_payload_layout& layout,
+                         const uint8_t* data,
+                         std::vector<uint8_t>& out);
+//! Payload: decode layout.encoded_length bytes into layout.payload_length bytes
+bool il2p_decode_payload(il2p_block_codec& codec,
+                         const il2p_payload_layout& layout,
+                         const uint8_t* encoded,
+                         std::vector<uint8_t>& data);
+
+/*!
+ * \brief Payload decoder that corrects the blocks of one frame concurrently.
+ *
+ * Blocks are independent codewords, so a multi-block payload is spread over a
+ * small persistent worker pool (at most IL2P_MAX_PAYLOAD_BLOCKS - 1 threads,
+ * started on the first multi-block frame); the calling thread decodes blocks
+ * too. Single-block payloads, or hosts with one CPU, decode inline. Each worker
+ * owns its codec, so decode() is the only call that must not run concurrently.
+ */
+class il2p_payload_decoder
+{
+  public:
+    il2p_payload_decoder();
+    ~il2p_payload_decoder();
+
+    il2p_payload_decoder(const il2p_payload_decoder&) = delete;
+    il2p_payload_decoder& operator=(const il2p_payload_decoder&) = delete;
+
+    //! Same contract as il2p_decode_payload()
+    bool decode(const il2p_payload_layout& layout,
+                const uint8_t* encoded,
+                std::vector<uint8_t>& data);
+
+  private:
+    struct worker_state {
+        il2p_block_codec codec;
+        std::vector<uint8_t> block;
+    };
+
+    void start_workers();
+    void worker_loop(int index);
+    void decode_blocks(worker_state& state);
+
+    worker_state d_states[IL2P_MAX_PAYLOAD_BLOCKS]; //!< [0] is the calling thread
+    std::vector<std::thread> d_threads;
+    std::mutex d_mutex;
+    std::condition_variable d_work_cv;
+    std::condition_variable d_done_cv;
+    uint64_t d_generation{ 0 }; //!< Bumped for every dispatched frame
+    int d_active{ 0 };          //!< Workers taking part in the current frame
+    int d_pending{ 0 };         //!< Active workers still running
+    bool d_stop{ false };
+
+    // Current frame, published under d_mutex before d_generation is bumped
+    const il2p_payload_layout* d_layout{ nullptr };
+    const uint8_t* d_encoded{ nullptr };
+    uint8_t* d_output{ nullptr };
+    std::atomic<int> d_next_block{ 0 };
+    std::atomic<bool> d_failed{ false };
+};
+
+} // namespace packet_protocols
+} // namespace gr
+
+#endif /* INCLUDED_PACKET_PROTOCOLS_IL2P_FRAME_H */
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2024 gr-packet-protocols
+ *
+ * This file is part of gr-packet-protocols
+ */
+
+#ifndef INCLUDED_PACKET_PROTOCOLS_IL2P_SCRAMBLER_H
+#define INCLUDED_PACKET_PROTOCOLS_IL2P_SCRAMBLER_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace gr {
+namespace packet_protocols {
+
+// IL2P scrambler shared by il2p_encoder and il2p_decoder.
+//
+// The IL2P specification's multiplicative scrambler, polynomial x^9 + x^4 + 1:
+// every scrambled bit is y[t] = x[t] ^ y[t-4] ^ y[t-9], bits MSB first, and the
+// descrambler recovers x[t] = y[t] ^ y[t-4] ^ y[t-9]. The state is the last nine
+// scrambled bits (bit 0 the most recent); each block starts from all ones, which
+// is what the reference implementation's register seeds (0x00F scrambling, 0x1F0
+// descrambling) amount to.
+//
+// A byte is processed a nibble at a time: the taps of the first nibble are all in
+// the state, and the second nibble's y[t-4] taps are the first nibble itself.
+
+static const uint16_t IL2P_SCRAMBLER_INIT = 0x1FF;
+
+/*!
+ * \brief Scramble \p length bytes in place.
+ * \param state State to start from (IL2P_SCRAMBLER_INIT at the start of a block)
+ * \return State after the last byte, for continuing across buffers
+ */
+inline uint16_t il2p_scramble_inplace(uint8_t* data,
+                                      size_t length,
+                                      uint16_t state = IL2P_SCRAMBLER_INIT)
+{
+    unsigned s = state & 0x1FFu;
+    for (size_t i = 0; i < length; ++i) {
+        const unsigned high = (data[i] >> 4) ^ (s & 0x0Fu) ^ ((s >> 5) & 0x0Fu);
+        const unsigned low = (data[i] & 0x0Fu) ^ high ^ ((s >> 1) & 0x0Fu);
+        const unsigned out = (high << 4) | low;
+        data[i] = static_cast<uint8_t>(out);
+        s = ((s << 8) | out) & 0x1FFu;
+    }
+    return static_cast<uint16_t>(s);
+}
+
+/*!
+ * \brief Descramble \p length bytes in place.
+ * \param state State to start from (IL2P_SCRAMBLER_INIT at the start of a block)
+ * \return State after the last byte, for continuing across buffers
+ */
+inline uint16_t il2p_descramble_inplace(uint8_t* data,
+                                        size_t length,
+                                        uint16_t state = IL2P_SCRAMBLER_INIT)
+{
+    unsigned s = state & 0x1FFu;
+    for (size_t i = 0; i < length; ++i) {
+        const unsigned window = (s << 8) | data[i];
+        data[i] = static_cast<uint8_t>(window ^ (window >> 4) ^ (window >> 9));
+        s = window & 0x1FFu;
+    }
+    return static_cast<uint16_t>(s);
+}
+
+} // namespace packet_protocols
+} // namespace gr
+
+#endif /* INCLUDED_PACKET_PROTOCOLS_IL2P_SCRAMBLER_H */
@@ -0,0 +1,169 @@
+/*
+ * Copyright 2024 gr-packet-protocols
+ *
+ * This file is part of gr-packet-protocols
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "kiss_codec.h"
+#include <cstring>
+
+namespace gr {
+namespace packet_protocols {
+
+namespace {
+
+const uint8_t FEND = 0xC0;
+const uint8_t FESC = 0xDB;
+const uint8_t TFEND = 0xDC;
+const uint8_t TFESC = 0xDD;
+
+//! First occurrence of \p byte in [p, end), or end
+inline const uint8_t* find_byte(const uint8_t* p, const uint8_t* end, uint8_t byte)
+{
+    const void* hit = std::memchr(p, byte, static_cast<size_t>(end - p));
+    return hit ? static_cast<const uint8_t*>(hit) : end;
+}
+
+inline uint8_t unescape_byte(uint8_t byte)
+{
+    // Anything other than TFEND/TFESC after FESC is passed through unchanged
+    return byte == TFEND ? FEND : (byte == TFESC ? FESC : byte);
+}
+
+} // namespace
+
+size_t kiss_escape(const uint8_t* data, size_t length, uint8_t* out) {
+    if (length == 0)
+        return 0;
+    const uint8_t* p = data;
+    const uint8_t* const end = data + length;
+    uint8_t* o = out;
+    // Track the next FEND and FESC separately so each is searched for only once
+    const uint8_t* next_fend = find_byte(p, end, FEND);
+    const uint8_t* next_fesc = find_byte(p, end, FESC);
+    while (true) {
+        const uint8_t* special = next_fend < next_fesc ? next_fend : next_fesc;
+        const size_t run = static_cast<size_t>(special - p);
+        std::memcpy(o, p, run);
+        o += run;
+        if (special == end)
+            break;
+        *o++ = FESC;
+        *o++ = (*special == FEND) ? TFEND : TFESC;
+        p = special + 1;
+        if (special == next_fend)
+            next_fend = find_byte(p, end, FEND);
+        else
+            next_fesc = find_byte(p, end, FESC);
+    }
+    return static_cast<size_t>(o - out);
+}
+
+size_t kiss_encode_frame(uint8_t type, const uint8_t* data, size_t length, uint8_t* out) {
+    size_t n = 0;
+    out[n++] = FEND;
+    n += kiss_escape(&type, 1, out + n); // port 12 data (0xC0) must be escaped too
+    n += kiss_escape(data, length, out + n);
+    out[n++] = FEND;
+    return n;
+}
+
+void kiss_append_frame(std::vector<uint8_t>& out,
+                       uint8_t type,
+                       const uint8_t* data,
+                       size_t length) {
+    const size_t base = out.size();
+    out.resize(base + kiss_encoded_size_max(length));
+    out.resize(base + kiss_encode_frame(type, data, length, out.data() + base));
+}
+
+kiss_unescaper::kiss_unescaper(size_t max_frame) : d_frame(max_frame) {}
+
+void kiss_unescaper::reset() {
+    d_in_frame = false;
+    d_length = 0;
+    d_escape = false;
+    d_overflow = false;
+}
+
+void kiss_unescaper::append(const uint8_t* data, size_t length) {
+    if (d_overflow || length == 0)
+        return;
+    if (length > d_frame.size() - d_length) {
+        d_overflow = true; // discard until the next FEND
+        return;
+    }
+    std::memcpy(d_frame.data() + d_length, data, length);
+    d_length += length;
+}
+
+void kiss_unescaper::feed(const uint8_t* data, size_t length, const frame_fn& on_frame) {
+    const uint8_t* p = data;
+    const uint8_t* const end = data + length;
+    while (p < end) {
+        if (!d_in_frame) {
+            p = find_byte(p, end, FEND);
+            if (p == end)
+                return;
+            p++;
+            d_in_frame = true;
+            continue;
+        }
+
+        const uint8_t* const fend = find_byte(p, end, FEND);
+        const uint8_t* fesc = find_byte(p, fend, FESC);
+
+        if (fend != end && fesc == fend && d_length == 0 && !d_escape && !d_overflow) {
+            // Complete frame without escapes: hand out the caller's bytes in place
+            const size_t frame_length = static_cast<size_t>(fend - p);
+            if (frame_length > d_frame.size())
+                d_frames_oversized++;
+            else if (frame_length > 0)
+                on_frame(p, frame_length);
+            p = fend + 1;
+            continue;
+        }
+
+        if (d_escape && p < fend) {
+            // FESC was the last byte of the previous chunk
+            const uint8_t byte = unescape_byte(*p);
+            append(&byte, 1);
+            d_escape = false;
+            if (fesc == p)
+                fesc = find_byte(p + 1, fend, FESC);
+            p++;
+        }
+        while (true) {
+            append(p, static_cast<size_t>(fesc - p));
+            if (fesc == fend)
+                break;
+            if (fesc + 1 == fend) {
+                d_escape = true; // completed by the next chunk (or dropped by FEND)
+                break;
+            }
+            const uint8_t byte = unescape_byte(fesc[1]);
+            append(&byte, 1);
+            p = fesc + 2;
+            fesc = find_byte(p, fend, FESC);
+        }
+        if (fend == end)
+            return;
+
+        // Closing FEND, which also opens the next frame
+        if (d_overflow)
+            d_frames_oversized++;
+        else if (d_length > 0)
+            on_frame(d_frame.data(), d_length);
+        d_length = 0;
+        d_escape = false;
+        d_overflow = false;
+        p = fend + 1;
+    }
+}
+
+} // namespace packet_protocols
+} // namespace gr
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2024 gr-packet-protocols
+ *
+ * This file is part of gr-packet-protocols
+ */
+
+#ifndef INCLUDED_PACKET_PROTOCOLS_KISS_CODEC_H
+#define INCLUDED_PACKET_PROTOCOLS_KISS_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace gr {
+namespace packet_protocols {
+
+/*
+ * Bulk KISS framing. Both directions locate the next FEND/FESC with memchr(),
+ * which libc implements with vector compares (SSE2/AVX2 on x86, NEON/ASIMD on
+ * ARM), and move the clean run in front of it with one memcpy(); payload bytes
+ * are never visited one at a time.
+ */
+
+//! Output capacity kiss_encode_frame() may need for \p length data bytes
+inline size_t kiss_encoded_size_max(size_t length) { return 2 * (length + 1) + 2; }
+
+/*!
+ * \brief Escape \p length bytes of \p data into \p out.
+ * \param out Buffer of at least 2 * \p length bytes
+ * \return Number of bytes written
+ */
+size_t kiss_escape(const uint8_t* data, size_t length, uint8_t* out);
+
+/*!
+ * \brief Write FEND, the escaped type byte and data, FEND into \p out.
+ * \param out Buffer of at least kiss_encoded_size_max(\p length) bytes
+ * \return Frame length in bytes
+ */
+size_t kiss_encode_frame(uint8_t type, const uint8_t* data, size_t length, uint8_t* out);
+
+//! Append one encoded frame to \p out (a single resize, no per-byte push_back)
+void kiss_append_frame(std::vector<uint8_t>& out,
+                       uint8_t type,
+                       const uint8_t* data,
+                       size_t length);
+
+/*!
+ * \brief Streaming KISS de-framer.
+ *
+ * feed() accepts arbitrary chunks of the serial byte stream and calls the frame
+ * callback with each complete, unescaped frame (type byte followed by data). A
+ * frame that lies wholly inside one chunk and contains no escapes is passed as
+ * a span into the caller's buffer; anything else is assembled in a buffer of
+ * \p max_frame bytes allocated once at construction. A FEND both closes a frame
+ * and opens the next, so back-to-back frames may share it. Frames longer than
+ * \p max_frame are discarded and counted.
+ */
+class kiss_unescaper
+{
+  public:
+    //! One frame; the span is only valid for the duration of the call
+    typedef std::function<void(const uint8_t*, size_t)> frame_fn;
+
+    explicit kiss_unescaper(size_t max_frame = 4096);
+
+    void feed(const uint8_t* data, size_t length, const frame_fn& on_frame);
+
+    //! Drop any partial frame and wait for the next FEND
+    void reset();
+
+    uint64_t frames_oversized() const { return d_frames_oversized; }
+
+  private:
+    void append(const uint8_t* data, size_t length);
+
+    std::vector<uint8_t> d_frame; //!< Fixed-capacity assembly buffer
+    size_t d_length{ 0 };
+    bool d_in_frame{ false };
+    bool d_escape{ false };   //!< Previous chunk ended on FESC
+    bool d_overflow{ false }; //!< Current frame exceeded the buffer
+    uint64_t d_frames_oversized{ 0 };
+};
+
+} // namespace packet_protocols
+} // namespace gr
+
+#endif /* INCLUDED_PACKET_PROTOCOLS_KISS_CODEC_H */
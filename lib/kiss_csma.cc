@@ -0,0 +1,71 @@
+/*
+ * Copyright 2024 gr-packet-protocols
+ *
+ * This file is part of gr-packet-protocols
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "kiss_csma.h"
+#include <ctime>
+#include <memory>
+#include <random>
+
+namespace gr {
+namespace packet_protocols {
+
+namespace {
+
+int64_t monotonic_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+} // namespace
+
+const int64_t kiss_csma::WAIT_FOR_DCD;
+
+kiss_csma::kiss_csma(clock_fn clock, random_fn random)
+    : d_clock(clock ? std::move(clock) : clock_fn(monotonic_ns)),
+      d_random(std::move(random)) {
+    if (!d_random) {
+        auto engine = std::make_shared<std::minstd_rand>(std::random_device{}());
+        d_random = [engine]() { return static_cast<uint8_t>((*engine)() >> 8); };
+    }
+}
+
+int64_t kiss_csma::access() {
+    if (d_full_duplex.load())
+        return 0;
+    if (d_dcd.load()) {
+        // Channel busy: any slot in progress is void, start over once it clears
+        if (!d_was_busy)
+            d_busy_deferrals++;
+        d_was_busy = true;
+        d_next_slot = 0;
+        return WAIT_FOR_DCD;
+    }
+    d_was_busy = false;
+
+    const int64_t slot_ns = static_cast<int64_t>(d_slot_time.load()) * 10000000LL;
+    if (slot_ns <= 0)
+        return 0;
+    const int64_t now = d_clock();
+    if (d_next_slot != 0 && now < d_next_slot)
+        return d_next_slot - now;
+
+    if (d_random() <= d_persistence.load()) {
+        d_next_slot = 0;
+        return 0;
+    }
+    d_slots_deferred++;
+    d_next_slot = now + slot_ns;
+    return slot_ns;
+}
+
+} // namespace packet_protocols
+} // namespace gr
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2024 gr-packet-protocols
+ *
+ * This file is part of gr-packet-protocols
+ */
+
+#ifndef INCLUDED_PACKET_PROTOCOLS_KISS_CSMA_H
+#define INCLUDED_PACKET_PROTOCOLS_KISS_CSMA_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+namespace gr {
+namespace packet_protocols {
+
+/*!
+ * \brief p-persistent CSMA channel access (KISS P / SLOTTIME / FULLDUPLEX).
+ *
+ * A frame that is ready to go asks access(). While carrier is detected it must
+ * wait for DCD to drop. Once the channel is clear a random number 0..255 is
+ * drawn at each slot boundary: if it is <= P the frame is sent, otherwise the
+ * attempt is deferred by SLOTTIME and repeated (DCD is checked again first).
+ * Full duplex bypasses the procedure, as does SLOTTIME 0 (no slot to defer
+ * into). Time and randomness come from injectable functions so the schedule
+ * is deterministic under test. access() and reset() belong to one thread;
+ * the setters may be called from any.
+ */
+class kiss_csma
+{
+  public:
+    typedef std::function<int64_t()> clock_fn;  //!< Monotonic time in nanoseconds
+    typedef std::function<uint8_t()> random_fn; //!< Uniform over 0..255
+
+    static const int64_t WAIT_FOR_DCD = -1;
+
+    //! Empty functions select CLOCK_MONOTONIC and an internally seeded generator
+    explicit kiss_csma(clock_fn clock = clock_fn(), random_fn random = random_fn());
+
+    void set_persistence(int persistence) { d_persistence.store(persistence & 0xFF); }
+    void set_slot_time(int units) { d_slot_time.store(units); }
+    void set_full_duplex(bool full_duplex) { d_full_duplex.store(full_duplex); }
+    void set_dcd(bool busy) { d_dcd.store(busy); }
+    bool dcd() const { return d_dcd.load(); }
+
+    /*!
+     * \brief Channel-access decision for the frame at the head of the queue.
+     * \return 0 to transmit now, a positive number of nanoseconds to wait before
+     *         asking again, or WAIT_FOR_DCD while carrier is detected
+     */
+    int64_t access();
+
+    //! Current reading of the clock the schedule runs on
+    int64_t now() const { return d_clock(); }
+
+    //! Forget a pending slot deferral (e.g. after the frame was sent)
+    void reset() { d_next_slot = 0; }
+
+    uint64_t slots_deferred() const { return d_slots_deferred.load(); }
+    uint64_t busy_deferrals() const { return d_busy_deferrals.load(); }
+
+  private:
+    clock_fn d_clock;
+    random_fn d_random;
+
+    std::atomic<int> d_persistence{ 255 }; //!< Transmit if random <= P
+    std::atomic<int> d_slot_time{ 0 };     //!< 10 ms units
+    std::atomic<bool> d_full_duplex{ false };
+    std::atomic<bool> d_dcd{ false };
+
+    int64_t d_next_slot{ 0 }; //!< Earliest time of the next draw; 0 = none pending
+    bool d_was_busy{ false };
+
+    std::atomic<uint64_t> d_slots_deferred{ 0 };
+    std::atomic<uint64_t> d_busy_deferrals{ 0 };
+};
+
+} // namespace packet_protocols
+} // namespace gr
+
+#endif /* INCLUDED_PACKET_PROTOCOLS_KISS_CSMA_H */
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2024 gr-packet-protocols
+ *
+ * This file is part of gr-packet-protocols
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "kiss_dispatcher.h"
+#include <utility>
+
+namespace gr {
+namespace packet_protocols {
+
+const char* kiss_parameter_name(uint8_t command) {
+    switch (command) {
+    case KISS_CMD_TXDELAY:
+        return "tx_delay";
+    case KISS_CMD_P:
+        return "persistence";
+    case KISS_CMD_SLOTTIME:
+        return "slot_time";
+    case KISS_CMD_TXTAIL:
+        return "tx_tail";
+    case KISS_CMD_FULLDUPLEX:
+        return "full_duplex";
+    case KISS_CMD_SET_HARDWARE:
+        return "hardware";
+    default:
+        return nullptr;
+    }
+}
+
+kiss_dispatcher::kiss_dispatcher(size_t max_frame,
+                                 data_fn on_data,
+                                 parameter_fn on_parameter,
+                                 negotiation_fn on_negotiation)
+    : d_on_data(std::move(on_data)),
+      d_on_parameter(std::move(on_parameter)),
+      d_on_negotiation(std::move(on_negotiation)),
+      d_unescaper(max_frame) {}
+
+void kiss_dispatcher::feed(const char* data, size_t length) {
+    // The block's byte stream is char, which is signed on most targets: compare FEND and
+    // FESC as unsigned octets
+    d_unescaper.feed(reinterpret_cast<const uint8_t*>(data), length,
+                     [this](const uint8_t* frame, size_t frame_length) {
+                         dispatch(frame, frame_length);
+                     });
+}
+
+void kiss_dispatcher::dispatch(const uint8_t* frame, size_t length) {
+    if (length < 1) {
+        return; // Invalid frame
+    }
+
+    const uint8_t type = frame[0];
+    if (type == 0xFF) {
+        // Return to normal mode
+        d_kiss_mode = false;
+        return;
+    }
+
+    const int num_ports = d_num_ports.load();
+    if (num_ports == 1 && type >= KISS_CMD_NEG_REQ && type <= KISS_CMD_QUALITY_FB) {
+        // Negotiation frames, handled by the modulation_negotiation block. The extension
+        // reuses the type bytes of port 1, so it is only recognised while port 1 is not
+        // routed.
+        if (length > 1 && d_on_negotiation) {
+            d_on_negotiation(type, frame + 1, length - 1);
+        }
+        return;
+    }
+
+    const int port = (type >> 4) & 0x0F;
+    const uint8_t command = type & 0x0F;
+    if (port >= num_ports || length < 2) {
+        return; // Unrouted port, or command without its argument
+    }
+
+    if (command != KISS_CMD_DATA) {
+        set_parameter(port, command, frame[1]);
+        return;
+    }
+    if (d_on_data) {
+        d_on_data(port, frame + 1, length - 1);
+    }
+}
+
+bool kiss_dispatcher::host_frame(long port,
+                                 const uint8_t* data,
+                                 size_t length,
+                                 std::vector<uint8_t>& out) const {
+    if (port < 0 || port >= d_num_ports.load()) {
+        return false;
+    }
+    kiss_append_frame(out, static_cast<uint8_t>(port << 4) | KISS_CMD_DATA, data, length);
+    return true;
+}
+
+void kiss_dispatcher::set_parameter(int port, uint8_t command, uint8_t value) {
+    kiss_port_params& params = d_ports[port];
+    switch (command) {
+    case KISS_CMD_TXDELAY:
+        params.tx_delay = value;
+        break;
+    case KISS_CMD_P:
+        params.persistence = value;
+        break;
+    case KISS_CMD_SLOTTIME:
+        params.slot_time = value;
+        break;
+    case KISS_CMD_TXTAIL:
+        params.tx_tail = value;
+        break;
+    case KISS_CMD_FULLDUPLEX:
+        params.full_duplex = (value != 0);
+        break;
+    case KISS_CMD_SET_HARDWARE:
+        params.hardware = value;
+        break;
+    default:
+        return;
+    }
+    if (d_on_parameter) {
+        d_on_parameter(port, command, value);
+    }
+}
+
+} // namespace packet_protocols
+} // namespace gr
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2024 gr-packet-protocols
+ *
+ * This file is part of gr-packet-protocols
+ */
+
+#ifndef INCLUDED_PACKET_PROTOCOLS_KISS_DISPATCHER_H
+#define INCLUDED_PACKET_PROTOCOLS_KISS_DISPATCHER_H
+
+#include "kiss_codec.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace gr {
+namespace packet_protocols {
+
+// KISS command constants
+enum kiss_cmd_t {
+    KISS_CMD_DATA = 0,
+    KISS_CMD_TXDELAY = 1,
+    KISS_CMD_P = 2,
+    KISS_CMD_SLOTTIME = 3,
+    KISS_CMD_TXTAIL = 4,
+    KISS_CMD_FULLDUPLEX = 5,
+    KISS_CMD_SET_HARDWARE = 6,
+    KISS_CMD_NEG_REQ = 0x10,      // Negotiation request
+    KISS_CMD_NEG_RESP = 0x11,     // Negotiation response
+    KISS_CMD_NEG_ACK = 0x12,      // Negotiation acknowledgment
+    KISS_CMD_MODE_CHANGE = 0x13,  // Mode change notification
+    KISS_CMD_QUALITY_FB = 0x14,   // Quality feedback
+    KISS_CMD_RETURN = 15
+};
+
+// Logical KISS ports addressed by the high nibble of the type byte
+const int KISS_MAX_PORTS = 16;
+
+//! Per-port KISS parameters (KISS defaults)
+struct kiss_port_params {
+    int tx_delay{ 50 };        //!< TXDELAY, 10 ms units
+    int persistence{ 63 };     //!< P
+    int slot_time{ 10 };       //!< SLOTTIME, 10 ms units
+    int tx_tail{ 0 };          //!< TXTAIL, 10 ms units
+    bool full_duplex{ false }; //!< FULLDUPLEX
+    uint8_t hardware{ 0 };     //!< SETHARDWARE
+};
+
+//! Name of a parameter command in the port's update dict, nullptr if not a parameter
+const char* kiss_parameter_name(uint8_t command);
+
+/*!
+ * \brief Routes the KISS frames a host sends to kiss_tnc.
+ *
+ * The type byte 0xFF leaves KISS mode. While only port 0 is routed, the types 0x10 to
+ * 0x14 carry the negotiation extension, which overlaps port 1. Otherwise the high nibble
+ * selects the port and the low nibble the command: data goes to on_data, and parameter
+ * commands update the port's kiss_port_params and are reported to on_parameter. Frames
+ * for unrouted ports and commands without their argument are dropped.
+ *
+ * The dispatcher owns no device or message port; kiss_tnc connects the handlers to
+ * those. feed(), dispatch() and host_frame() belong to the block thread, set_num_ports()
+ * may be called from any.
+ */
+class kiss_dispatcher
+{
+  public:
+    typedef std::function<void(int port, const uint8_t* data, size_t length)> data_fn;
+    typedef std::function<void(int port, uint8_t command, int value)> parameter_fn;
+    typedef std::function<void(uint8_t type, const uint8_t* data, size_t length)>
+        negotiation_fn;
+
+    kiss_dispatcher(size_t max_frame,
+                    data_fn on_data,
+                    parameter_fn on_parameter,
+                    negotiation_fn on_negotiation);
+
+    //! De-frame a chunk of the host byte stream (the block input) and dispatch each frame
+    void feed(const char* data, size_t length);
+
+    //! Dispatch one unescaped frame: type byte followed by its data
+    void dispatch(const uint8_t* frame, size_t length);
+
+    /*!
+     * \brief Append the KISS frame carrying \p data received on \p port for the host
+     * \return false, appending nothing, if the port is not routed
+     */
+    bool host_frame(long port,
+                    const uint8_t* data,
+                    size_t length,
+                    std::vector<uint8_t>& out) const;
+
+    void set_num_ports(int num_ports) { d_num_ports.store(num_ports); }
+    int num_ports() const { return d_num_ports.load(); }
+    bool kiss_mode() const { return d_kiss_mode; }
+
+    kiss_port_params& params(int port) { return d_ports[port]; }
+    const kiss_port_params& params(int port) const { return d_ports[port]; }
+
+  private:
+    void set_parameter(int port, uint8_t command, uint8_t value);
+
+    data_fn d_on_data;
+    parameter_fn d_on_parameter;
+    negotiation_fn d_on_negotiation;
+    kiss_unescaper d_unescaper;
+
+    kiss_port_params d_ports[KISS_MAX_PORTS]; //!< Port 0 is the serial device
+    std::atomic<int> d_num_ports{ 1 };        //!< Ports 0..d_num_ports-1 are routed
+    bool d_kiss_mode{ true };
+};
+
+} // namespace packet_protocols
+} // namespace gr
+
+#endif /* INCLUDED_PACKET_PROTOCOLS_KISS_DISPATCHER_H */
@@ -0,0 +1,214 @@
+/*
+ * Copyright 2024 gr-packet-protocols
+ *
+ * This file is part of gr-packet-protocols
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "kiss_rx_reader.h"
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace gr {
+namespace packet_protocols {
+
+namespace {
+
+const uint8_t FEND = 0xC0;
+
+int64_t monotonic_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+} // namespace
+
+kiss_rx_reader::kiss_rx_reader(int fd,
+                               size_t ring_bytes,
+                               frame_fn frame_tap,
+                               notify_fn on_data)
+    : d_fd(fd), d_frame_tap(std::move(frame_tap)), d_on_data(std::move(on_data)),
+      d_epoll_fd(-1), d_wake_fd(-1), d_data_fd(-1), d_bytes(ring_bytes),
+      d_marks(ring_bytes / 2) {
+    for (auto& bucket : d_latency)
+        bucket.store(0);
+
+    d_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    d_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    d_data_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    struct epoll_event dev_ev = {};
+    dev_ev.events = EPOLLIN;
+    dev_ev.data.fd = d_fd;
+    struct epoll_event wake_ev = {};
+    wake_ev.events = EPOLLIN;
+    wake_ev.data.fd = d_wake_fd;
+    if (d_epoll_fd < 0 || d_wake_fd < 0 || d_data_fd < 0 ||
+        epoll_ctl(d_epoll_fd, EPOLL_CTL_ADD, d_fd, &dev_ev) != 0 ||
+        epoll_ctl(d_epoll_fd, EPOLL_CTL_ADD, d_wake_fd, &wake_ev) != 0) {
+        for (int f : { d_epoll_fd, d_wake_fd, d_data_fd }) {
+            if (f >= 0)
+                close(f);
+        }
+        throw std::runtime_error("kiss_rx_reader: failed to set up epoll on device");
+    }
+    d_thread = std::thread(&kiss_rx_reader::run, this);
+}
+
+kiss_rx_reader::~kiss_rx_reader() {
+    d_stop.store(true);
+    const uint64_t one = 1;
+    (void)write(d_wake_fd, &one, sizeof(one));
+    d_thread.join();
+    close(d_data_fd);
+    close(d_wake_fd);
+    close(d_epoll_fd);
+}
+
+void kiss_rx_reader::run() {
+    struct epoll_event events[2];
+    while (!d_stop.load()) {
+        const int n = epoll_wait(d_epoll_fd, events, 2, -1);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            if (events[i].data.fd != d_fd)
+                continue;
+            if (events[i].events & EPOLLIN)
+                drain_device();
+            if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                // Device gone (e.g. USB unplug or PTY peer closed): stop polling it
+                epoll_ctl(d_epoll_fd, EPOLL_CTL_DEL, d_fd, nullptr);
+            }
+        }
+    }
+}
+
+void kiss_rx_reader::drain_device() {
+    uint8_t buffer[4096];
+    bool pushed = false;
+    while (true) {
+        const ssize_t n = ::read(d_fd, buffer, sizeof(buffer));
+        if (n > 0) {
+            ingest(buffer, static_cast<size_t>(n), monotonic_ns());
+            pushed = true;
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        break; // EAGAIN, EOF or error
+    }
+    if (pushed) {
+        const uint64_t one = 1;
+        (void)write(d_data_fd, &one, sizeof(one));
+        if (d_on_data)
+            d_on_data();
+    }
+}
+
+void kiss_rx_reader::ingest(const uint8_t* data, size_t length, int64_t now_ns) {
+    d_bytes_received.fetch_add(length, std::memory_order_relaxed);
+    const size_t accepted = d_bytes.push(data, length);
+    if (accepted < length) {
+        d_overruns.fetch_add(1, std::memory_order_relaxed);
+        d_overrun_bytes.fetch_add(length - accepted, std::memory_order_relaxed);
+    }
+
+    // Frame boundaries: jump from FEND to FEND instead of testing every byte
+    const uint8_t* p = data;
+    const uint8_t* const end = data + accepted;
+    while (p < end) {
+        const uint8_t* fend =
+            static_cast<const uint8_t*>(std::memchr(p, FEND, static_cast<size_t>(end - p)));
+        const uint8_t* const stop = fend ? fend : end;
+        d_frame_length += static_cast<size_t>(stop - p);
+        if (d_frame_tap) {
+            const size_t chunk = static_cast<size_t>(stop - p);
+            if (d_tap_frame.size() + chunk <= KISS_RX_MAX_TAP_FRAME)
+                d_tap_frame.insert(d_tap_frame.end(), p, stop);
+            else
+                d_tap_frame.clear(); // longer than any frame: drop it, resync on next FEND
+        }
+        if (!fend)
+            break;
+        if (d_frame_length > 0) {
+            d_frames_received.fetch_add(1, std::memory_order_relaxed);
+            const uint64_t frame_end = d_pushed + static_cast<uint64_t>(fend - data) + 1;
+            d_marks.push(frame_mark{ frame_end, now_ns });
+            if (d_frame_tap && d_tap_frame.size() > d_frame_length) {
+                d_tap_frame.push_back(FEND);
+                d_frame_tap(d_tap_frame.data() + d_tap_frame.size() - d_frame_length - 2,
+                            d_frame_length + 2);
+            }
+        }
+        d_frame_length = 0;
+        if (d_frame_tap) {
+            d_tap_frame.clear();
+            d_tap_frame.push_back(FEND); // opening FEND of the next frame
+        }
+        p = fend + 1;
+    }
+    d_pushed += accepted;
+    if (accepted < length) {
+        d_frame_length = 0; // the frame in progress lost bytes; resynchronise on next FEND
+        d_tap_frame.clear();
+    }
+}
+
+size_t kiss_rx_reader::read(uint8_t* out, size_t max) {
+    const size_t n = d_bytes.pop(out, max);
+    if (n == 0)
+        return 0;
+    d_consumed += n;
+
+    int64_t now_ns = 0;
+    const frame_mark* mark;
+    while ((mark = d_marks.front()) != nullptr && mark->end <= d_consumed) {
+        if (now_ns == 0)
+            now_ns = monotonic_ns();
+        uint64_t us = static_cast<uint64_t>((now_ns - mark->arrival_ns) / 1000);
+        int bucket = 0;
+        while (us > 1 && bucket < KISS_RX_LATENCY_BUCKETS - 1) {
+            us >>= 1;
+            bucket++;
+        }
+        d_latency[bucket].fetch_add(1, std::memory_order_relaxed);
+        frame_mark done;
+        d_marks.pop(done);
+    }
+    return n;
+}
+
+bool kiss_rx_reader::wait_readable(int timeout_ms) {
+    if (d_bytes.size() > 0)
+        return true;
+    struct pollfd pfd = { d_data_fd, POLLIN, 0 };
+    if (poll(&pfd, 1, timeout_ms) > 0) {
+        uint64_t count;
+        (void)::read(d_data_fd, &count, sizeof(count));
+    }
+    return d_bytes.size() > 0;
+}
+
+std::vector<uint64_t> kiss_rx_reader::latency_histogram() const {
+    std::vector<uint64_t> histogram(KISS_RX_LATENCY_BUCKETS);
+    for (int i = 0; i < KISS_RX_LATENCY_BUCKETS; i++)
+        histogram[i] = d_latency[i].load(std::memory_order_relaxed);
+    return histogram;
+}
+
+} // namespace packet_protocols
+} // namespace gr
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2024 gr-packet-protocols
+ *
+ * This file is part of gr-packet-protocols
+ */
+
+#ifndef INCLUDED_PACKET_PROTOCOLS_KISS_RX_READER_H
+#define INCLUDED_PACKET_PROTOCOLS_KISS_RX_READER_H
+
+#include "spsc_ring.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace gr {
+namespace packet_protocols {
+
+static const size_t KISS_RX_RING_BYTES = 1 << 16;   //!< Default serial RX ring size
+static const int KISS_RX_LATENCY_BUCKETS = 24;     //!< log2(us) histogram buckets
+//! Longest frame passed to the tap: 4096 data bytes, all escaped, and both FENDs
+static const size_t KISS_RX_MAX_TAP_FRAME = 2 * 4096 + 2;
+
+/*!
+ * \brief Serial RX thread for kiss_tnc.
+ *
+ * A dedicated thread blocks in epoll_wait() on the (non-blocking) device
+ * descriptor, drains it with read() and pushes the bytes into a lock-free SPSC
+ * ring consumed by work() through read(). The reader also tracks KISS frame
+ * boundaries (FEND after a non-empty frame) and stamps each with its arrival
+ * time; when read() hands out the final byte of a frame, the serial-to-work()
+ * latency is added to a histogram whose bucket i counts latencies in
+ * [2^i, 2^(i+1)) microseconds. Bytes that do not fit in the ring are dropped
+ * and counted as an overrun. An optional tap receives every complete on-wire
+ * frame (FEND to FEND) on the reader thread, e.g. for KISS-over-TCP fan-out;
+ * a frame longer than KISS_RX_MAX_TAP_FRAME is not tapped, the tap resynchronises
+ * on the next FEND. The optional on_data callback runs on the reader thread
+ * after each batch pushed into the ring, so a consumer can be woken instead of
+ * polling wait_readable().
+ */
+class kiss_rx_reader
+{
+  public:
+    typedef std::function<void(const uint8_t*, size_t)> frame_fn;
+    typedef std::function<void()> notify_fn;
+
+    kiss_rx_reader(int fd,
+                   size_t ring_bytes = KISS_RX_RING_BYTES,
+                   frame_fn frame_tap = frame_fn(),
+                   notify_fn on_data = notify_fn());
+    ~kiss_rx_reader();
+
+    kiss_rx_reader(const kiss_rx_reader&) = delete;
+    kiss_rx_reader& operator=(const kiss_rx_reader&) = delete;
+
+    //! Consumer: take up to \p max bytes; call from one thread only
+    size_t read(uint8_t* out, size_t max);
+
+    //! Consumer: wait up to \p timeout_ms for bytes to become available
+    bool wait_readable(int timeout_ms);
+
+    size_t available() const { return d_bytes.size(); }
+    uint64_t bytes_received() const { return d_bytes_received.load(); }
+    uint64_t frames_received() const { return d_frames_received.load(); }
+    uint64_t overruns() const { return d_overruns.load(); }
+    uint64_t overrun_bytes() const { return d_overrun_bytes.load(); }
+    std::vector<uint64_t> latency_histogram() const;
+
+  private:
+    struct frame_mark {
+        uint64_t end;        //!< Stream offset one past the frame's closing FEND
+        int64_t arrival_ns;  //!< CLOCK_MONOTONIC time the FEND was read
+    };
+
+    void run();
+    void drain_device();
+    void ingest(const uint8_t* data, size_t length, int64_t now_ns);
+
+    const int d_fd;
+    const frame_fn d_frame_tap;
+    const notify_fn d_on_data; //!< Called on the reader thread after each batch
+    int d_epoll_fd;
+    int d_wake_fd; //!< eventfd: shutdown
+    int d_data_fd; //!< eventfd: signalled after each batch pushed into the ring
+
+    spsc_ring<uint8_t> d_bytes;
+    spsc_ring<frame_mark> d_marks;
+
+    // Producer-only state
+    uint64_t d_pushed{ 0 };
+    size_t d_frame_length{ 0 };
+    std::vector<uint8_t> d_tap_frame; //!< Current frame, FEND included, when tapping
+
+    // Consumer-only state
+    uint64_t d_consumed{ 0 };
+
+    std::atomic<bool> d_stop{ false };
+    std::atomic<uint64_t> d_bytes_received{ 0 };
+    std::atomic<uint64_t> d_frames_received{ 0 };
+    std::atomic<uint64_t> d_overruns{ 0 };
+    std::atomic<uint64_t> d_overrun_bytes{ 0 };
+    std::atomic<uint64_t> d_latency[KISS_RX_LATENCY_BUCKETS];
+
+    std::thread d_thread;
+};
+
+} // namespace packet_protocols
+} // namespace gr
+
+#endif /* INCLUDED_PACKET_PROTOCOLS_KISS_RX_READER_H */
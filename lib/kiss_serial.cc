@@ -0,0 +1,149 @@
+/*
+ * Copyright 2024 gr-packet-protocols
+ *
+ * This file is part of gr-packet-protocols
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "kiss_serial.h"
+
+// termios2/BOTHER come from the kernel headers, which cannot be mixed with glibc's
+// <termios.h>; this file therefore uses the kernel definitions throughout.
+#include <asm/termbits.h>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/serial.h>
+#include <stdexcept>
+#include <string>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace gr {
+namespace packet_protocols {
+
+namespace {
+
+struct standard_speed {
+    int rate;
+    unsigned int code;
+};
+
+const standard_speed STANDARD_SPEEDS[] = {
+    { 50, B50 },           { 75, B75 },           { 110, B110 },
+    { 134, B134 },         { 150, B150 },         { 200, B200 },
+    { 300, B300 },         { 600, B600 },         { 1200, B1200 },
+    { 1800, B1800 },       { 2400, B2400 },       { 4800, B4800 },
+    { 9600, B9600 },       { 19200, B19200 },     { 38400, B38400 },
+    { 57600, B57600 },     { 115200, B115200 },   { 230400, B230400 },
+    { 460800, B460800 },   { 500000, B500000 },   { 576000, B576000 },
+    { 921600, B921600 },   { 1000000, B1000000 }, { 1152000, B1152000 },
+    { 1500000, B1500000 }, { 2000000, B2000000 }, { 2500000, B2500000 },
+    { 3000000, B3000000 }, { 3500000, B3500000 }, { 4000000, B4000000 },
+};
+
+std::runtime_error serial_error(const std::string& what) {
+    return std::runtime_error("serial port: " + what + ": " + std::strerror(errno));
+}
+
+bool set_low_latency(int fd, bool enable) {
+    struct serial_struct serial;
+    if (ioctl(fd, TIOCGSERIAL, &serial) != 0)
+        return false;
+    if (enable)
+        serial.flags |= ASYNC_LOW_LATENCY;
+    else
+        serial.flags &= ~ASYNC_LOW_LATENCY;
+    if (ioctl(fd, TIOCSSERIAL, &serial) != 0)
+        return false;
+    return enable;
+}
+
+} // namespace
+
+serial_status configure_serial_port(int fd, const serial_config& config) {
+    if (config.baud_rate <= 0)
+        throw std::invalid_argument("serial port: invalid baud rate " +
+                                    std::to_string(config.baud_rate));
+    if (config.vmin < 0 || config.vmin > 255 || config.vtime < 0 || config.vtime > 255)
+        throw std::invalid_argument("serial port: VMIN/VTIME must be 0..255");
+
+    struct termios2 tio;
+    if (ioctl(fd, TCGETS2, &tio) != 0)
+        throw serial_error("TCGETS2 failed");
+
+    // Raw 8N1: no break/parity handling, CR/NL translation, flow control or echo
+    tio.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON |
+                     IXOFF | IXANY);
+    tio.c_oflag &= ~OPOST;
+    tio.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+    tio.c_cflag &= ~(CSIZE | PARENB | CSTOPB | CRTSCTS);
+    tio.c_cflag |= CS8 | CREAD | CLOCAL;
+    if (config.hardware_flow_control)
+        tio.c_cflag |= CRTSCTS;
+    tio.c_cc[VMIN] = static_cast<cc_t>(config.vmin);
+    tio.c_cc[VTIME] = static_cast<cc_t>(config.vtime);
+
+    // Input speed bits left at zero: input follows the output rate
+    unsigned int code = BOTHER;
+    for (const auto& speed : STANDARD_SPEEDS) {
+        if (speed.rate == config.baud_rate)
+            code = speed.code;
+    }
+    tio.c_cflag &= ~(CBAUD | (CBAUD << IBSHIFT));
+    tio.c_cflag |= code;
+    tio.c_ispeed = static_cast<speed_t>(config.baud_rate);
+    tio.c_ospeed = static_cast<speed_t>(config.baud_rate);
+
+    if (ioctl(fd, TCSETS2, &tio) != 0)
+        throw serial_error("cannot set " + std::to_string(config.baud_rate) + " baud");
+
+    struct termios2 applied;
+    if (ioctl(fd, TCGETS2, &applied) != 0)
+        throw serial_error("TCGETS2 failed");
+
+    serial_status status;
+    status.baud_rate = static_cast<int>(applied.c_ospeed);
+    const double error =
+        std::fabs(static_cast<double>(status.baud_rate) - config.baud_rate) / config.baud_rate;
+    if (error > SERIAL_BAUD_TOLERANCE) {
+        throw std::runtime_error("serial port: requested " + std::to_string(config.baud_rate) +
+                                 " baud, driver set " + std::to_string(status.baud_rate));
+    }
+    if (config.hardware_flow_control && !(applied.c_cflag & CRTSCTS))
+        throw std::runtime_error("serial port: driver does not support RTS/CTS flow control");
+
+    status.low_latency = set_low_latency(fd, config.low_latency);
+    return status;
+}
+
+pty_pair open_pty_pair() {
+    pty_pair pty;
+    pty.master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (pty.master < 0)
+        throw serial_error("cannot allocate a pseudo-terminal");
+
+    char path[128];
+    if (grantpt(pty.master) != 0 || unlockpt(pty.master) != 0 ||
+        ptsname_r(pty.master, path, sizeof(path)) != 0) {
+        const std::runtime_error error = serial_error("cannot unlock the pseudo-terminal");
+        close(pty.master);
+        throw error;
+    }
+    pty.slave = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (pty.slave < 0) {
+        const std::runtime_error error = serial_error(std::string("cannot open ") + path);
+        close(pty.master);
+        throw error;
+    }
+    pty.slave_path = path;
+    return pty;
+}
+
+} // namespace packet_protocols
+} // namespace gr
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2024 gr-packet-protocols
+ *
+ * This file is part of gr-packet-protocols
+ */
+
+#ifndef INCLUDED_PACKET_PROTOCOLS_KISS_SERIAL_H
+#define INCLUDED_PACKET_PROTOCOLS_KISS_SERIAL_H
+
+#include <string>
+
+namespace gr {
+namespace packet_protocols {
+
+//! Largest relative difference accepted between the requested and the driver's rate
+static const double SERIAL_BAUD_TOLERANCE = 0.02;
+
+//! Serial line settings for a KISS device (always raw 8N1)
+struct serial_config {
+    int baud_rate{ 9600 };
+    bool hardware_flow_control{ false }; //!< RTS/CTS
+    bool low_latency{ true };            //!< ASYNC_LOW_LATENCY, where the driver has it
+    int vmin{ 0 };  //!< Bytes buffered before the device polls readable (0/1: every byte)
+    int vtime{ 0 }; //!< Inter-byte timeout in 100 ms units; non-zero wakes on any byte
+};
+
+//! What the driver actually applied
+struct serial_status {
+    int baud_rate{ 0 };        //!< Rate read back from the driver
+    bool low_latency{ false }; //!< ASYNC_LOW_LATENCY is set
+};
+
+/*!
+ * \brief Put \p fd into raw 8N1 mode at the configured rate and read it back.
+ *
+ * Rates with a standard Bxxx constant (50 to 4000000) use it; any other rate is
+ * programmed through termios2 with BOTHER. The rate the driver reports after the
+ * change must be within SERIAL_BAUD_TOLERANCE of the request. ASYNC_LOW_LATENCY
+ * is best effort: USB CDC and pseudo-terminals do not implement it.
+ *
+ * \throws std::invalid_argument for a non-positive rate or VMIN/VTIME outside 0..255
+ * \throws std::runtime_error if the driver rejects the settings, cannot reach the
+ *         rate, or drops RTS/CTS
+ */
+serial_status configure_serial_port(int fd, const serial_config& config);
+
+//! Both ends of a pseudo-terminal standing in for a KISS serial device
+struct pty_pair {
+    int master{ -1 };       //!< The TNC side, read and written by the block
+    int slave{ -1 };        //!< Held open so the master never sees a hangup
+    std::string slave_path; //!< Where host software (kissattach, a load generator) connects
+};
+
+/*!
+ * \brief Allocate a pseudo-terminal pair with both ends non-blocking and neither
+ *        becoming a controlling terminal. The slave still needs configure_serial_port()
+ *        to make the line raw.
+ * \throws std::runtime_error if no pseudo-terminal can be allocated
+ */
+pty_pair open_pty_pair();
+
+} // namespace packet_protocols
+} // namespace gr
+
+#endif /* INCLUDED_PACKET_PROTOCOLS_KISS_SERIAL_H */
@@ -0,0 +1,254 @@
+/*
+ * Copyright 2024 gr-packet-protocols
+ *
+ * This file is part of gr-packet-protocols
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "kiss_tcp_server.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace gr {
+namespace packet_protocols {
+
+kiss_tcp_server::kiss_tcp_server(const std::string& bind_address,
+                                 int port,
+                                 frame_fn on_frame,
+                                 size_t client_queue_bytes)
+    : d_on_frame(std::move(on_frame)), d_client_queue_bytes(client_queue_bytes),
+      d_listen_fd(-1), d_epoll_fd(-1), d_wake_fd(-1), d_port(port) {
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, bind_address.c_str(), &addr.sin_addr) != 1)
+        throw std::runtime_error("kiss_tcp_server: invalid bind address " + bind_address);
+
+    d_listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    const int one = 1;
+    if (d_listen_fd < 0 ||
+        setsockopt(d_listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0 ||
+        bind(d_listen_fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(d_listen_fd, 16) != 0) {
+        const std::string reason = std::strerror(errno);
+        if (d_listen_fd >= 0)
+            close(d_listen_fd);
+        throw std::runtime_error("kiss_tcp_server: cannot listen on " + bind_address + ":" +
+                                 std::to_string(port) + ": " + reason);
+    }
+    socklen_t len = sizeof(addr);
+    getsockname(d_listen_fd, reinterpret_cast<struct sockaddr*>(&addr), &len);
+    d_port = ntohs(addr.sin_port);
+
+    d_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    d_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    struct epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.fd = d_listen_fd;
+    struct epoll_event wake_ev = {};
+    wake_ev.events = EPOLLIN;
+    wake_ev.data.fd = d_wake_fd;
+    if (d_epoll_fd < 0 || d_wake_fd < 0 ||
+        epoll_ctl(d_epoll_fd, EPOLL_CTL_ADD, d_listen_fd, &ev) != 0 ||
+        epoll_ctl(d_epoll_fd, EPOLL_CTL_ADD, d_wake_fd, &wake_ev) != 0) {
+        for (int f : { d_listen_fd, d_epoll_fd, d_wake_fd }) {
+            if (f >= 0)
+                close(f);
+        }
+        throw std::runtime_error("kiss_tcp_server: failed to set up epoll");
+    }
+    d_thread = std::thread(&kiss_tcp_server::run, this);
+}
+
+kiss_tcp_server::~kiss_tcp_server() {
+    d_stop.store(true);
+    const uint64_t one = 1;
+    (void)write(d_wake_fd, &one, sizeof(one));
+    d_thread.join();
+    for (auto& entry : d_clients)
+        close(entry.first);
+    close(d_wake_fd);
+    close(d_epoll_fd);
+    close(d_listen_fd);
+}
+
+void kiss_tcp_server::broadcast(const uint8_t* kiss_frame, size_t length) {
+    if (d_client_count.load() == 0)
+        return;
+    auto frame = std::make_shared<const std::vector<uint8_t>>(kiss_frame, kiss_frame + length);
+    {
+        std::lock_guard<std::mutex> lock(d_inbox_mutex);
+        d_inbox.push_back(std::move(frame));
+    }
+    const uint64_t one = 1;
+    (void)write(d_wake_fd, &one, sizeof(one));
+}
+
+void kiss_tcp_server::run() {
+    struct epoll_event events[64];
+    while (!d_stop.load()) {
+        const int n = epoll_wait(d_epoll_fd, events, 64, -1);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            const int fd = events[i].data.fd;
+            if (fd == d_wake_fd) {
+                uint64_t count;
+                (void)read(d_wake_fd, &count, sizeof(count));
+                distribute();
+                continue;
+            }
+            if (fd == d_listen_fd) {
+                accept_clients();
+                continue;
+            }
+            auto it = d_clients.find(fd);
+            if (it == d_clients.end())
+                continue;
+            if ((events[i].events & EPOLLOUT) && !flush_client(it->second)) {
+                drop_client(fd);
+                continue;
+            }
+            // Hangups and errors surface as recv() returning 0 / failing, after any
+            // frames the client sent before closing have been delivered
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+                read_client(it->second);
+        }
+    }
+}
+
+void kiss_tcp_server::accept_clients() {
+    while (true) {
+        const int fd = accept4(d_listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+            return; // EAGAIN, or a transient accept error
+        const int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        struct epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(d_epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            close(fd);
+            continue;
+        }
+        client& c = d_clients[fd];
+        c.fd = fd;
+        d_client_count.store(d_clients.size());
+    }
+}
+
+void kiss_tcp_server::drop_client(int fd) {
+    epoll_ctl(d_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    d_clients.erase(fd);
+    d_client_count.store(d_clients.size());
+}
+
+void kiss_tcp_server::read_client(client& c) {
+    uint8_t buffer[4096];
+    while (true) {
+        const ssize_t n = recv(c.fd, buffer, sizeof(buffer), 0);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            drop_client(c.fd);
+            return;
+        }
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        c.unescaper.feed(buffer, static_cast<size_t>(n), d_on_frame);
+    }
+}
+
+void kiss_tcp_server::distribute() {
+    std::vector<frame_ptr> frames;
+    {
+        std::lock_guard<std::mutex> lock(d_inbox_mutex);
+        frames.swap(d_inbox);
+    }
+    std::vector<int> failed;
+    for (auto& entry : d_clients) {
+        client& c = entry.second;
+        for (const auto& frame : frames) {
+            if (c.queued_bytes + frame->size() > d_client_queue_bytes) {
+                d_frames_dropped++;
+                continue;
+            }
+            c.queue.push_back(frame);
+            c.queued_bytes += frame->size();
+        }
+        if (!c.want_write && !flush_client(c))
+            failed.push_back(entry.first);
+    }
+    for (int fd : failed)
+        drop_client(fd);
+}
+
+bool kiss_tcp_server::flush_client(client& c) {
+    struct iovec iov[KISS_TCP_IOV_MAX];
+    while (!c.queue.empty()) {
+        // One sendmsg() for as many queued frames as fit in the iovec
+        int count = 0;
+        for (auto it = c.queue.begin(); it != c.queue.end() && count < KISS_TCP_IOV_MAX;
+             ++it, ++count) {
+            const size_t skip = count == 0 ? c.offset : 0;
+            iov[count].iov_base = const_cast<uint8_t*>((*it)->data()) + skip;
+            iov[count].iov_len = (*it)->size() - skip;
+        }
+        struct msghdr msg = {};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+        const ssize_t n = sendmsg(c.fd, &msg, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            return false;
+        }
+        size_t sent = static_cast<size_t>(n);
+        while (!c.queue.empty()) {
+            const size_t remaining = c.queue.front()->size() - c.offset;
+            if (sent < remaining) {
+                c.offset += sent;
+                break;
+            }
+            sent -= remaining;
+            c.queued_bytes -= c.queue.front()->size();
+            c.queue.pop_front();
+            c.offset = 0;
+        }
+    }
+    update_interest(c);
+    return true;
+}
+
+void kiss_tcp_server::update_interest(client& c) {
+    const bool want_write = !c.queue.empty();
+    if (want_write == c.want_write)
+        return;
+    struct epoll_event ev = {};
+    ev.events = EPOLLIN | (want_write ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+    ev.data.fd = c.fd;
+    epoll_ctl(d_epoll_fd, EPOLL_CTL_MOD, c.fd, &ev);
+    c.want_write = want_write;
+}
+
+} // namespace packet_protocols
+} // namespace gr
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2024 gr-packet-protocols
+ *
+ * This file is part of gr-packet-protocols
+ */
+
+#ifndef INCLUDED_PACKET_PROTOCOLS_KISS_TCP_SERVER_H
+#define INCLUDED_PACKET_PROTOCOLS_KISS_TCP_SERVER_H
+
+#include "kiss_codec.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gr {
+namespace packet_protocols {
+
+static const int KISS_TCP_DEFAULT_PORT = 8001;                //!< Customary KISS-over-TCP port
+static const size_t KISS_TCP_CLIENT_QUEUE_BYTES = 256 * 1024; //!< Per-client backlog bound
+static const int KISS_TCP_IOV_MAX = 64;                       //!< Frames coalesced per sendmsg()
+static const size_t KISS_TCP_MAX_FRAME = 4096;                //!< Longest accepted client frame
+
+/*!
+ * \brief KISS-over-TCP server shared by any number of clients.
+ *
+ * One thread runs an epoll loop over the listening socket, the clients and an
+ * eventfd. broadcast() (callable from any thread) hands an on-wire KISS frame
+ * to the loop, which appends one shared copy to every client's bounded send
+ * queue; a client whose backlog would exceed the bound loses that frame
+ * (counted) rather than stalling the others. Frames received from clients
+ * are de-framed and unescaped and passed to the frame callback on the server
+ * thread.
+ */
+class kiss_tcp_server
+{
+  public:
+    //! Receives one unescaped KISS frame: type byte followed by its data
+    typedef std::function<void(const uint8_t*, size_t)> frame_fn;
+
+    /*!
+     * \param bind_address IPv4 address to listen on ("0.0.0.0" for all interfaces)
+     * \param port TCP port; 0 picks an ephemeral port (see port())
+     * \param on_frame Called on the server thread for each frame a client sends
+     * \param client_queue_bytes Per-client send backlog bound
+     * \throws std::runtime_error if the socket cannot be bound
+     */
+    kiss_tcp_server(const std::string& bind_address,
+                    int port,
+                    frame_fn on_frame,
+                    size_t client_queue_bytes = KISS_TCP_CLIENT_QUEUE_BYTES);
+    ~kiss_tcp_server();
+
+    kiss_tcp_server(const kiss_tcp_server&) = delete;
+    kiss_tcp_server& operator=(const kiss_tcp_server&) = delete;
+
+    //! Port actually bound
+    int port() const { return d_port; }
+
+    //! Queue an already framed/escaped KISS frame for every connected client
+    void broadcast(const uint8_t* kiss_frame, size_t length);
+
+    size_t clients() const { return d_client_count.load(); }
+    uint64_t frames_dropped() const { return d_frames_dropped.load(); }
+
+  private:
+    typedef std::shared_ptr<const std::vector<uint8_t>> frame_ptr;
+
+    struct client {
+        int fd;
+        std::deque<frame_ptr> queue;
+        size_t queued_bytes{ 0 };
+        size_t offset{ 0 }; //!< Bytes of queue.front() already sent
+        bool want_write{ false };
+        kiss_unescaper unescaper{ KISS_TCP_MAX_FRAME };
+    };
+
+    void run();
+    void accept_clients();
+    void read_client(client& c);
+    bool flush_client(client& c); //!< false if the connection failed
+    void update_interest(client& c);
+    void drop_client(int fd);
+    void distribute();
+
+    const frame_fn d_on_frame;
+    const size_t d_client_queue_bytes;
+    int d_listen_fd;
+    int d_epoll_fd;
+    int d_wake_fd;
+    int d_port;
+
+    std::map<int, client> d_clients; //!< Server thread only
+
+    std::mutex d_inbox_mutex;
+    std::vector<frame_ptr> d_inbox;
+
+    std::atomic<bool> d_stop{ false };
+    std::atomic<size_t> d_client_count{ 0 };
+    std::atomic<uint64_t> d_frames_dropped{ 0 };
+    std::thread d_thread;
+};
+
+} // namespace packet_protocols
+} // namespace gr
+
+#endif /* INCLUDED_PACKET_PROTOCOLS_KISS_TCP_SERVER_H */
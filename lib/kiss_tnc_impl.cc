@@ -24,45 +24,111 @@
 #endif
 
 #include "kiss_tnc_impl.h"
+#include <chrono>
 #include <fcntl.h>
 #include <gnuradio/io_signature.h>
 #include <gnuradio/message.h>
 #include <pmt/pmt.h>
+#include <stdexcept>
 #include <sys/ioctl.h>
-#include <termios.h>
 #include <unistd.h>
 
 namespace gr {
 namespace packet_protocols {
 
 kiss_tnc::sptr kiss_tnc::make(const std::string& device, int baud_rate,
-                              bool hardware_flow_control) {
-    return gnuradio::make_block_sptr<kiss_tnc_impl>(device, baud_rate, hardware_flow_control);
+                              bool hardware_flow_control, int tcp_port,
+                              const std::string& tcp_bind_address) {
+    return gnuradio::make_block_sptr<kiss_tnc_impl>(device, baud_rate, hardware_flow_control,
+                                                    tcp_port, tcp_bind_address);
 }
 
-kiss_tnc_impl::kiss_tnc_impl(const std::string& device, int baud_rate, bool hardware_flow_control)
-    : gr::sync_block("kiss_tnc", gr::io_signature::make(1, 1, sizeof(char)),
-                     gr::io_signature::make(1, 1, sizeof(char))),
+kiss_tnc_impl::kiss_tnc_impl(const std::string& device, int baud_rate, bool hardware_flow_control,
+                             int tcp_port, const std::string& tcp_bind_address)
+    : gr::block("kiss_tnc", gr::io_signature::make(1, 1, sizeof(char)),
+                gr::io_signature::make(1, 1, sizeof(char))),
       d_device(device), d_baud_rate(baud_rate), d_hardware_flow_control(hardware_flow_control),
-      d_serial_fd(-1), d_kiss_state(KISS_STATE_IDLE), d_escape_next(false), d_frame_buffer(1024),
-      d_frame_length(0), d_ones_count(0), d_ptt_enabled(false), d_ptt_state(false),
-      d_use_dtr_for_ptt(false) {
-    // Initialize serial port
-    if (!open_serial_port()) {
+      d_serial_fd(-1),
+      d_dispatch(
+          KISS_MAX_FRAME,
+          [this](int port, const uint8_t* data, size_t length) {
+              handle_port_data(port, data, length);
+          },
+          [this](int port, uint8_t command, int value) {
+              handle_port_parameter(port, command, value);
+          },
+          [this](uint8_t type, const uint8_t* data, size_t length) {
+              handle_negotiation(type, data, length);
+          }),
+      d_ptt_enabled(false), d_ptt_state(false), d_use_dtr_for_ptt(false) {
+    // Initialize serial port, or a pseudo-terminal standing in for one
+    if (device == KISS_PTY_DEVICE) {
+        open_pty();
+    } else if (!open_serial_port()) {
         throw std::runtime_error("Failed to open serial port: " + device);
     }
 
-    d_frame_buffer.clear();
-    d_frame_length = 0;
-    
+    // Internal port the RX and TCP threads post to, so that the scheduler runs
+    // general_work() when device bytes or client frames arrive instead of work() polling
+    message_port_register_in(pmt::mp("wake"));
+    set_msg_handler(pmt::mp("wake"), [](const pmt::pmt_t&) {});
+
+    // TX thread: work() only queues, PTT and TXDELAY/TXTAIL are timed off the scheduler thread
+    d_tx.reset(new kiss_tx_engine(d_serial_fd, [this](bool state) { set_ptt(state); }));
+    const kiss_port_params& params = d_dispatch.params(0);
+    d_tx->set_tx_delay(params.tx_delay);
+    d_tx->set_tx_tail(params.tx_tail);
+    d_tx->set_persistence(params.persistence);
+    d_tx->set_slot_time(params.slot_time);
+    d_tx->set_full_duplex(params.full_duplex);
+
+    // KISS-over-TCP clients share the device: their data frames join the TX queue and
+    // every KISS frame read from the device is fanned out to them
+    kiss_rx_reader::frame_fn tap;
+    if (tcp_port > 0) {
+        d_tcp.reset(new kiss_tcp_server(
+            tcp_bind_address, tcp_port,
+            [this](const uint8_t* frame, size_t length) { handle_client_frame(frame, length); }));
+        tap = [this](const uint8_t* frame, size_t length) { d_tcp->broadcast(frame, length); };
+    }
+
+    // RX thread: epoll on the device, bytes handed to general_work() through an SPSC ring
+    d_rx.reset(new kiss_rx_reader(d_serial_fd, KISS_RX_RING_BYTES, tap,
+                                  [this]() { wake_scheduler(); }));
+
     // Register message port for forwarding negotiation frames
     message_port_register_out(pmt::mp("negotiation_out"));
+
+    // Periodic TX queue report (set_tx_stats_interval)
+    message_port_register_out(pmt::mp("tx_stats"));
+
+    // One output per logical KISS port (data PDUs and parameter updates), and an input
+    // for frames received on a port that should go back to the host
+    for (int port = 0; port < KISS_MAX_PORTS; port++) {
+        d_port_out.push_back(pmt::mp("port" + std::to_string(port)));
+        message_port_register_out(d_port_out.back());
+    }
+    message_port_register_in(pmt::mp("port_in"));
+    set_msg_handler(pmt::mp("port_in"), [this](const pmt::pmt_t& msg) { handle_port_in(msg); });
+
+    // Carrier detect from the receive chain gates channel access
+    message_port_register_in(pmt::mp("dcd"));
+    set_msg_handler(pmt::mp("dcd"), [this](const pmt::pmt_t& msg) { handle_dcd(msg); });
 }
 
 kiss_tnc_impl::~kiss_tnc_impl() {
+    stop();
+    // Join the RX, TCP and TX threads (in that order, each feeds the next) before the
+    // descriptor goes away
+    d_rx.reset();
+    d_tcp.reset();
+    d_tx.reset();
     if (d_serial_fd >= 0) {
         close(d_serial_fd);
     }
+    if (d_pty_slave_fd >= 0) {
+        close(d_pty_slave_fd);
+    }
 }
 
 bool kiss_tnc_impl::open_serial_port() {
@@ -71,228 +137,207 @@ bool kiss_tnc_impl::open_serial_port() {
         return false;
     }
 
-    // Configure serial port
-    struct termios tty;
-    if (tcgetattr(d_serial_fd, &tty) != 0) {
+    // Raw 8N1 at the requested rate; a rate the driver cannot reach is an error rather
+    // than a silent fallback
+    d_serial_config.baud_rate = d_baud_rate;
+    d_serial_config.hardware_flow_control = d_hardware_flow_control;
+    try {
+        apply_serial_config(d_serial_config);
+    } catch (...) {
         close(d_serial_fd);
         d_serial_fd = -1;
-        return false;
+        throw;
     }
+    return true;
+}
 
-    // Set baud rate
-    speed_t speed = B9600;
-    switch (d_baud_rate) {
-    case 1200:
-        speed = B1200;
-        break;
-    case 2400:
-        speed = B2400;
-        break;
-    case 4800:
-        speed = B4800;
-        break;
-    case 9600:
-        speed = B9600;
-        break;
-    case 19200:
-        speed = B19200;
-        break;
-    case 38400:
-        speed = B38400;
-        break;
-    case 57600:
-        speed = B57600;
-        break;
-    case 115200:
-        speed = B115200;
-        break;
-    default:
-        speed = B9600;
-        break;
-    }
-
-    cfsetispeed(&tty, speed);
-    cfsetospeed(&tty, speed);
-
-    // Configure 8N1
-    tty.c_cflag &= ~PARENB; // No parity
-    tty.c_cflag &= ~CSTOPB; // 1 stop bit
-    tty.c_cflag &= ~CSIZE;
-    tty.c_cflag |= CS8;            // 8 data bits
-    tty.c_cflag &= ~CRTSCTS;       // Disable RTS/CTS
-    tty.c_cflag |= CREAD | CLOCAL; // Enable reading and ignore modem control lines
-
-    // Raw mode
-    tty.c_lflag &= ~(ICANON | ECHO | ECHOE | ISIG);
-    tty.c_iflag &= ~(IXON | IXOFF | IXANY);
-    tty.c_oflag &= ~OPOST;
-
-    // Set timeouts
-    tty.c_cc[VTIME] = 0; // No timeout
-    tty.c_cc[VMIN] = 0;  // Non-blocking read
-
-    if (tcsetattr(d_serial_fd, TCSANOW, &tty) != 0) {
+void kiss_tnc_impl::open_pty() {
+    const pty_pair pty = open_pty_pair();
+    d_serial_fd = pty.master;
+    d_pty_slave_fd = pty.slave;
+    d_pty_path = pty.slave_path;
+
+    // The slave's termios governs the line: raw, so KISS bytes pass unaltered, and at
+    // the requested rate so rate handling behaves as on a real port
+    d_serial_config.baud_rate = d_baud_rate;
+    d_serial_config.hardware_flow_control = false;
+    try {
+        apply_serial_config(d_serial_config);
+    } catch (...) {
         close(d_serial_fd);
+        close(d_pty_slave_fd);
         d_serial_fd = -1;
-        return false;
+        d_pty_slave_fd = -1;
+        throw;
     }
+    d_logger->info("virtual TNC on {}", d_pty_path);
+}
 
-    return true;
+void kiss_tnc_impl::apply_serial_config(const serial_config& config) {
+    const int line_fd = d_pty_slave_fd >= 0 ? d_pty_slave_fd : d_serial_fd;
+    const serial_status status = configure_serial_port(line_fd, config);
+    d_serial_config = config;
+    d_actual_baud_rate.store(status.baud_rate);
+    d_logger->info("{}: {} baud (requested {}), RTS/CTS {}, low latency {}, VMIN {} VTIME {}",
+                   d_pty_path.empty() ? d_device : d_pty_path, status.baud_rate,
+                   config.baud_rate, config.hardware_flow_control ? "on" : "off",
+                   status.low_latency ? "on" : "off", config.vmin, config.vtime);
 }
 
-int kiss_tnc_impl::work(int noutput_items, gr_vector_const_void_star& input_items,
-                        gr_vector_void_star& output_items) {
+void kiss_tnc_impl::forecast(int noutput_items, gr_vector_int& ninput_items_required) {
+    ninput_items_required[0] = 0;
+}
+
+int kiss_tnc_impl::general_work(int noutput_items, gr_vector_int& ninput_items,
+                                gr_vector_const_void_star& input_items,
+                                gr_vector_void_star& output_items) {
     const char* in = (const char*)input_items[0];
     char* out = (char*)output_items[0];
+    const int ninput = ninput_items[0];
+
+    // Re-armed before anything is read: bytes arriving from here on post a new wake-up.
+    // With nothing to do this returns 0 at once and the scheduler sleeps until input,
+    // a message or a wake-up arrives.
+    d_wake_posted.store(false);
+
+    // Non-data frames from TCP clients are applied here, on the block's own thread
+    if (d_client_frames_pending.load()) {
+        std::deque<std::vector<uint8_t>> frames;
+        {
+            std::lock_guard<std::mutex> lock(d_client_mutex);
+            frames.swap(d_client_frames);
+            d_client_frames_pending.store(false);
+        }
+        for (const auto& frame : frames) {
+            d_dispatch.dispatch(frame.data(), frame.size());
+        }
+    }
+
+    // Process input from GNU Radio
+    d_dispatch.feed(in, static_cast<size_t>(ninput));
+    consume_each(ninput);
 
-    int consumed = 0;
+    // Frames received on logical ports (port_in), then device bytes collected by the RX
+    // thread
     int produced = 0;
+    while (produced < noutput_items && !d_host_out.empty()) {
+        out[produced++] = static_cast<char>(d_host_out.front());
+        d_host_out.pop_front();
+    }
+    produced += static_cast<int>(d_rx->read(reinterpret_cast<uint8_t*>(out) + produced,
+                                            noutput_items - produced));
+    return produced;
+}
 
-    // Process input from GNU Radio
-    for (int i = 0; i < noutput_items; i++) {
-        if (d_kiss_state == KISS_STATE_IDLE && in[i] == KISS_FEND) {
-            d_kiss_state = KISS_STATE_FRAME;
-            d_frame_buffer.clear();
-            d_frame_length = 0;
-            d_escape_next = false;
-        } else if (d_kiss_state == KISS_STATE_FRAME) {
-            if (in[i] == KISS_FEND) {
-                // End of frame
-                if (d_frame_length > 0) {
-                    process_kiss_frame();
-                }
-                d_kiss_state = KISS_STATE_IDLE;
-            } else if (in[i] == KISS_FESC) {
-                d_escape_next = true;
-            } else {
-                uint8_t byte = in[i];
-                if (d_escape_next) {
-                    if (byte == KISS_TFESC) {
-                        byte = KISS_FESC;
-                    } else if (byte == KISS_TFEND) {
-                        byte = KISS_FEND;
-                    }
-                    d_escape_next = false;
-                }
-
-                if (d_frame_length < d_frame_buffer.size()) {
-                    d_frame_buffer[d_frame_length] = byte;
-                    d_frame_length++;
-                }
-            }
-        }
-        consumed++;
+void kiss_tnc_impl::handle_port_data(int port, const uint8_t* data, size_t length) {
+    // Port 0 is queued for the device's TX thread (PTT, TXDELAY and TXTAIL are applied
+    // there); every port is published as a PDU for in-flowgraph modems
+    if (port == 0 && d_serial_fd >= 0) {
+        queue_on_air(data, length);
     }
+    pmt::pmt_t meta = pmt::dict_add(pmt::make_dict(), pmt::mp("port"), pmt::from_long(port));
+    message_port_pub(d_port_out[port], pmt::cons(meta, pmt::init_u8vector(length, data)));
+}
 
-    // Read from serial port and output to GNU Radio
-    if (d_serial_fd >= 0) {
-        char serial_buffer[256];
-        int bytes_read = read(d_serial_fd, serial_buffer, sizeof(serial_buffer));
-
-        if (bytes_read > 0) {
-            for (int i = 0; i < bytes_read && produced < noutput_items; i++) {
-                out[produced] = serial_buffer[i];
-                produced++;
-            }
+void kiss_tnc_impl::handle_port_parameter(int port, uint8_t command, int value) {
+    if (port == 0) {
+        const kiss_port_params& params = d_dispatch.params(0);
+        switch (command) {
+        case KISS_CMD_TXDELAY:
+            d_tx->set_tx_delay(params.tx_delay);
+            break;
+        case KISS_CMD_P:
+            d_tx->set_persistence(params.persistence);
+            break;
+        case KISS_CMD_SLOTTIME:
+            d_tx->set_slot_time(params.slot_time);
+            break;
+        case KISS_CMD_TXTAIL:
+            d_tx->set_tx_tail(params.tx_tail);
+            break;
+        case KISS_CMD_FULLDUPLEX:
+            d_tx->set_full_duplex(params.full_duplex);
+            break;
+        default:
+            break;
         }
     }
 
-    return produced;
+    // Let the port's modem follow its parameters
+    pmt::pmt_t update = pmt::make_dict();
+    update = pmt::dict_add(update, pmt::mp("port"), pmt::from_long(port));
+    update = pmt::dict_add(update, pmt::mp(kiss_parameter_name(command)),
+                           pmt::from_long(value));
+    message_port_pub(d_port_out[port], update);
 }
 
-void kiss_tnc_impl::process_kiss_frame() {
-    if (d_frame_length < 2) {
-        return; // Invalid frame
-    }
-
-    uint8_t command = d_frame_buffer[0] & 0x0F;
-    (void)((d_frame_buffer[0] >> 4) & 0x0F); // port - reserved for future use
-
-    switch (command) {
-    case KISS_CMD_DATA:
-        // Data frame - send to serial port
-        if (d_serial_fd >= 0) {
-            // Key PTT before transmission if enabled
-            if (d_ptt_enabled && !d_ptt_state) {
-                set_ptt(true);
-                // Apply TX delay (in 10ms units)
-                if (d_tx_delay > 0) {
-                    usleep(d_tx_delay * 10000);
-                }
-            }
-            (void)write(d_serial_fd, &d_frame_buffer[1], d_frame_length - 1);
-            // Unkey PTT after transmission if enabled
-            if (d_ptt_enabled && d_ptt_state) {
-                // Apply TX tail (in 10ms units)
-                if (d_tx_tail > 0) {
-                    usleep(d_tx_tail * 10000);
-                }
-                set_ptt(false);
-            }
-        }
-        break;
+void kiss_tnc_impl::handle_negotiation(uint8_t type, const uint8_t* data, size_t length) {
+    pmt::pmt_t command_pmt = pmt::from_long(static_cast<long>(type));
+    pmt::pmt_t data_pmt = pmt::init_u8vector(length, data);
+    message_port_pub(pmt::mp("negotiation_out"), pmt::cons(command_pmt, data_pmt));
+}
 
-    case KISS_CMD_TXDELAY:
-        // Set TX delay
-        if (d_frame_length >= 2) {
-            d_tx_delay = d_frame_buffer[1];
-        }
-        break;
+void kiss_tnc_impl::handle_port_in(const pmt::pmt_t& msg) {
+    if (!pmt::is_pair(msg) || !pmt::is_u8vector(pmt::cdr(msg))) {
+        return;
+    }
+    long port = 0;
+    const pmt::pmt_t meta = pmt::car(msg);
+    if (pmt::is_dict(meta) && pmt::dict_has_key(meta, pmt::mp("port"))) {
+        port = pmt::to_long(pmt::dict_ref(meta, pmt::mp("port"), pmt::from_long(0)));
+    }
 
-    case KISS_CMD_P:
-        // Set persistence
-        if (d_frame_length >= 2) {
-            d_persistence = d_frame_buffer[1];
-        }
-        break;
+    size_t length = 0;
+    const uint8_t* data = pmt::u8vector_elements(pmt::cdr(msg), length);
+    std::vector<uint8_t> frame;
+    if (!d_dispatch.host_frame(port, data, length, frame)) {
+        return;
+    }
+    d_host_out.insert(d_host_out.end(), frame.begin(), frame.end());
+    if (d_tcp) {
+        d_tcp->broadcast(frame.data(), frame.size());
+    }
+}
 
-    case KISS_CMD_SLOTTIME:
-        // Set slot time
-        if (d_frame_length >= 2) {
-            d_slot_time = d_frame_buffer[1];
-        }
-        break;
+void kiss_tnc_impl::handle_dcd(const pmt::pmt_t& msg) {
+    // Accept a bare boolean, a (key . boolean) pair or a dict with a "dcd" entry
+    pmt::pmt_t value = msg;
+    if (pmt::is_dict(msg)) {
+        value = pmt::dict_ref(msg, pmt::mp("dcd"), pmt::PMT_NIL);
+    } else if (pmt::is_pair(msg)) {
+        value = pmt::cdr(msg);
+    }
+    if (pmt::is_bool(value)) {
+        set_dcd(pmt::to_bool(value));
+    }
+}
 
-    case KISS_CMD_TXTAIL:
-        // Set TX tail
-        if (d_frame_length >= 2) {
-            d_tx_tail = d_frame_buffer[1];
-        }
-        break;
+void kiss_tnc_impl::set_dcd(bool busy) { d_tx->set_dcd(busy); }
 
-    case KISS_CMD_FULLDUPLEX:
-        // Set full duplex mode
-        if (d_frame_length >= 2) {
-            d_full_duplex = (d_frame_buffer[1] != 0);
-        }
-        break;
+void kiss_tnc_impl::queue_on_air(const uint8_t* frame, size_t length) {
+    // Link control ahead of interactive traffic ahead of bulk data
+    d_tx->enqueue(std::vector<uint8_t>(frame, frame + length), true,
+                  ax25_tx_priority(frame, length));
+}
 
-    case KISS_CMD_SET_HARDWARE:
-        // Set hardware parameters
-        if (d_frame_length >= 2) {
-            d_hardware_type = d_frame_buffer[1];
-        }
-        break;
-
-    case KISS_CMD_RETURN:
-        // Return to normal mode
-        d_kiss_mode = false;
-        break;
-
-    case KISS_CMD_NEG_REQ:
-    case KISS_CMD_NEG_RESP:
-    case KISS_CMD_NEG_ACK:
-    case KISS_CMD_MODE_CHANGE:
-    case KISS_CMD_QUALITY_FB:
-        // Negotiation frames - forward to message port
-        // These will be handled by modulation_negotiation block
-        if (d_frame_length > 1) {
-            pmt::pmt_t command_pmt = pmt::from_long(static_cast<long>(command));
-            pmt::pmt_t data_pmt = pmt::init_u8vector(d_frame_length - 1, &d_frame_buffer[1]);
-            pmt::pmt_t msg = pmt::cons(command_pmt, data_pmt);
-            message_port_pub(pmt::mp("negotiation_out"), msg);
-        }
-        break;
+void kiss_tnc_impl::handle_client_frame(const uint8_t* frame, size_t length) {
+    if (length >= 2 && frame[0] == KISS_CMD_DATA) {
+        // Port 0 data goes straight to the device; everything else is routed on the
+        // block thread
+        queue_on_air(frame + 1, length - 1);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(d_client_mutex);
+        d_client_frames.emplace_back(frame, frame + length);
+        d_client_frames_pending.store(true);
+    }
+    wake_scheduler();
+}
+
+void kiss_tnc_impl::wake_scheduler() {
+    if (!d_wake_posted.exchange(true)) {
+        _post(pmt::mp("wake"), pmt::PMT_T);
     }
 }
 
@@ -304,54 +349,44 @@ void kiss_tnc_impl::send_kiss_frame(uint8_t command, uint8_t port, const uint8_t
 
     // Build KISS frame
     std::vector<uint8_t> frame;
-    frame.push_back(KISS_FEND);
-    frame.push_back((port << 4) | command);
-
-    // Add data with escaping
-    for (int i = 0; i < length; i++) {
-        if (data[i] == KISS_FEND) {
-            frame.push_back(KISS_FESC);
-            frame.push_back(KISS_TFEND);
-        } else if (data[i] == KISS_FESC) {
-            frame.push_back(KISS_FESC);
-            frame.push_back(KISS_TFESC);
-        } else {
-            frame.push_back(data[i]);
-        }
-    }
-
-    frame.push_back(KISS_FEND);
+    kiss_append_frame(frame, static_cast<uint8_t>((port << 4) | command), data,
+                      static_cast<size_t>(length));
 
-    // Send frame
-    (void)write(d_serial_fd, frame.data(), frame.size());
+    // Send frame (in order with queued data, without keying PTT)
+    d_tx->enqueue(std::move(frame), false);
 }
 
 void kiss_tnc_impl::set_tx_delay(int delay) {
-    d_tx_delay = delay;
+    d_dispatch.params(0).tx_delay = delay;
+    d_tx->set_tx_delay(delay);
     uint8_t cmd_data = delay & 0xFF;
     send_kiss_frame(KISS_CMD_TXDELAY, 0, &cmd_data, 1);
 }
 
 void kiss_tnc_impl::set_persistence(int persistence) {
-    d_persistence = persistence;
+    d_dispatch.params(0).persistence = persistence;
+    d_tx->set_persistence(persistence);
     uint8_t cmd_data = persistence & 0xFF;
     send_kiss_frame(KISS_CMD_P, 0, &cmd_data, 1);
 }
 
 void kiss_tnc_impl::set_slot_time(int slot_time) {
-    d_slot_time = slot_time;
+    d_dispatch.params(0).slot_time = slot_time;
+    d_tx->set_slot_time(slot_time);
     uint8_t cmd_data = slot_time & 0xFF;
     send_kiss_frame(KISS_CMD_SLOTTIME, 0, &cmd_data, 1);
 }
 
 void kiss_tnc_impl::set_tx_tail(int tx_tail) {
-    d_tx_tail = tx_tail;
+    d_dispatch.params(0).tx_tail = tx_tail;
+    d_tx->set_tx_tail(tx_tail);
     uint8_t cmd_data = tx_tail & 0xFF;
     send_kiss_frame(KISS_CMD_TXTAIL, 0, &cmd_data, 1);
 }
 
 void kiss_tnc_impl::set_full_duplex(bool full_duplex) {
-    d_full_duplex = full_duplex;
+    d_dispatch.params(0).full_duplex = full_duplex;
+    d_tx->set_full_duplex(full_duplex);
     uint8_t cmd_data = full_duplex ? 1 : 0;
     send_kiss_frame(KISS_CMD_FULLDUPLEX, 0, &cmd_data, 1);
 }
@@ -367,6 +402,7 @@ bool kiss_tnc_impl::get_ptt() const {
 
 void kiss_tnc_impl::set_ptt_enabled(bool enabled) {
     d_ptt_enabled = enabled;
+    d_tx->set_ptt_enabled(enabled);
     if (!enabled && d_ptt_state) {
         // Unkey PTT if disabling
         set_ptt(false);
@@ -383,11 +419,147 @@ void kiss_tnc_impl::set_ptt_use_dtr(bool use_dtr) {
     }
 }
 
+void kiss_tnc_impl::set_num_ports(int num_ports) {
+    if (num_ports < 1 || num_ports > KISS_MAX_PORTS) {
+        throw std::invalid_argument("kiss_tnc: num_ports must be 1.." +
+                                    std::to_string(KISS_MAX_PORTS));
+    }
+    d_dispatch.set_num_ports(num_ports);
+}
+
+int kiss_tnc_impl::num_ports() const { return d_dispatch.num_ports(); }
+
+uint64_t kiss_tnc_impl::rx_frames() const { return d_rx->frames_received(); }
+
+uint64_t kiss_tnc_impl::rx_overruns() const { return d_rx->overruns(); }
+
+uint64_t kiss_tnc_impl::rx_overrun_bytes() const { return d_rx->overrun_bytes(); }
+
+std::vector<uint64_t> kiss_tnc_impl::rx_latency_histogram() const {
+    return d_rx->latency_histogram();
+}
+
+int kiss_tnc_impl::actual_baud_rate() const { return d_actual_baud_rate.load(); }
+
+void kiss_tnc_impl::set_low_latency(bool low_latency) {
+    serial_config config = d_serial_config;
+    config.low_latency = low_latency;
+    apply_serial_config(config);
+}
+
+void kiss_tnc_impl::set_read_thresholds(int vmin, int vtime) {
+    serial_config config = d_serial_config;
+    config.vmin = vmin;
+    config.vtime = vtime;
+    apply_serial_config(config);
+}
+
+size_t kiss_tnc_impl::tx_bytes_in_flight() const { return d_tx->bytes_in_flight(); }
+
+uint64_t kiss_tnc_impl::tx_frames_dropped() const { return d_tx->frames_dropped(); }
+
+void kiss_tnc_impl::set_tx_queue_limits(int max_frames, int max_bytes) {
+    if (max_frames < 1 || max_bytes < 1) {
+        throw std::invalid_argument("kiss_tnc: TX queue limits must be positive");
+    }
+    d_tx->set_limits(static_cast<size_t>(max_frames), static_cast<size_t>(max_bytes));
+}
+
+void kiss_tnc_impl::set_tx_drop_oldest(bool drop_oldest) {
+    d_tx->set_drop_policy(drop_oldest ? KISS_TX_DROP_OLDEST : KISS_TX_DROP_NEWEST);
+}
+
+void kiss_tnc_impl::set_tx_stats_interval(int interval_ms) {
+    {
+        std::lock_guard<std::mutex> lock(d_stats_mutex);
+        d_tx_stats_interval_ms.store(interval_ms > 0 ? interval_ms : 0);
+    }
+    d_stats_wake.notify_all();
+}
+
+bool kiss_tnc_impl::start() {
+    // The report has its own thread so that an idle block need not run general_work()
+    if (!d_stats_thread.joinable()) {
+        d_stats_stopping = false;
+        d_stats_thread = std::thread([this]() { run_tx_stats(); });
+    }
+    return block::start();
+}
+
+bool kiss_tnc_impl::stop() {
+    if (d_stats_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(d_stats_mutex);
+            d_stats_stopping = true;
+        }
+        d_stats_wake.notify_all();
+        d_stats_thread.join();
+    }
+    return block::stop();
+}
+
+void kiss_tnc_impl::run_tx_stats() {
+    std::unique_lock<std::mutex> lock(d_stats_mutex);
+    while (!d_stats_stopping) {
+        const int interval_ms = d_tx_stats_interval_ms.load();
+        if (interval_ms <= 0) {
+            d_stats_wake.wait(lock);
+            continue;
+        }
+        // A changed interval restarts the period
+        const bool woken = d_stats_wake.wait_for(
+            lock, std::chrono::milliseconds(interval_ms), [this, interval_ms]() {
+                return d_stats_stopping || d_tx_stats_interval_ms.load() != interval_ms;
+            });
+        if (!woken) {
+            lock.unlock();
+            publish_tx_stats();
+            lock.lock();
+        }
+    }
+}
+
+void kiss_tnc_impl::publish_tx_stats() {
+    static const char* const CLASS_NAMES[KISS_TX_CLASSES] = { "control", "interactive",
+                                                              "bulk" };
+    const auto stats = d_tx->class_stats();
+    pmt::pmt_t report = pmt::make_dict();
+    for (int cls = 0; cls < KISS_TX_CLASSES; cls++) {
+        pmt::pmt_t entry = pmt::make_dict();
+        auto add = [&entry](const char* key, const pmt::pmt_t& value) {
+            entry = pmt::dict_add(entry, pmt::mp(key), value);
+        };
+        add("frames", pmt::from_uint64(stats[cls].frames));
+        add("bytes", pmt::from_uint64(stats[cls].bytes));
+        add("sent", pmt::from_uint64(stats[cls].sent));
+        add("dropped", pmt::from_uint64(stats[cls].dropped));
+        add("sojourn_avg_ms", pmt::from_double(stats[cls].sojourn_avg_ns / 1e6));
+        add("sojourn_max_ms", pmt::from_double(stats[cls].sojourn_max_ns / 1e6));
+        report = pmt::dict_add(report, pmt::mp(CLASS_NAMES[cls]), entry);
+    }
+    report = pmt::dict_add(report, pmt::mp("bytes_in_flight"),
+                           pmt::from_uint64(d_tx->bytes_in_flight()));
+    message_port_pub(pmt::mp("tx_stats"), report);
+}
+
+std::string kiss_tnc_impl::pty_path() const { return d_pty_path; }
+
+uint64_t kiss_tnc_impl::ptt_key_count() const { return d_ptt_keys.load(); }
+
+uint64_t kiss_tnc_impl::ptt_unkey_count() const { return d_ptt_unkeys.load(); }
+
 void kiss_tnc_impl::control_ptt_line(bool state) {
     if (d_serial_fd < 0) {
         return;
     }
 
+    if (d_pty_slave_fd >= 0) {
+        // A pseudo-terminal has no modem control lines: TIOCMSET is emulated by
+        // counting, so PTT sequencing can still be checked without a radio
+        (state ? d_ptt_keys : d_ptt_unkeys)++;
+        return;
+    }
+
     int status;
     if (ioctl(d_serial_fd, TIOCMGET, &status) < 0) {
         return;
@@ -409,7 +581,9 @@ void kiss_tnc_impl::control_ptt_line(bool state) {
         }
     }
 
-    ioctl(d_serial_fd, TIOCMSET, &status);
+    if (ioctl(d_serial_fd, TIOCMSET, &status) == 0) {
+        (state ? d_ptt_keys : d_ptt_unkeys)++;
+    }
 }
 
 } /* namespace packet_protocols */
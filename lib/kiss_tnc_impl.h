@@ -22,39 +22,36 @@
 #ifndef INCLUDED_PACKET_PROTOCOLS_KISS_TNC_IMPL_H
 #define INCLUDED_PACKET_PROTOCOLS_KISS_TNC_IMPL_H
 
+#include "kiss_codec.h"
+#include "kiss_dispatcher.h"
+#include "kiss_rx_reader.h"
+#include "kiss_serial.h"
+#include "kiss_tcp_server.h"
+#include "kiss_tx_engine.h"
 #include <gnuradio/packet_protocols/ax25_protocol.h>
 #include <gnuradio/packet_protocols/kiss_tnc.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace gr {
 namespace packet_protocols {
 
-// KISS state machine constants
-enum kiss_state_t { KISS_STATE_IDLE = 0, KISS_STATE_FRAME = 1 };
-
-// KISS command constants
-enum kiss_cmd_t {
-    KISS_CMD_DATA = 0,
-    KISS_CMD_TXDELAY = 1,
-    KISS_CMD_P = 2,
-    KISS_CMD_SLOTTIME = 3,
-    KISS_CMD_TXTAIL = 4,
-    KISS_CMD_FULLDUPLEX = 5,
-    KISS_CMD_SET_HARDWARE = 6,
-    KISS_CMD_NEG_REQ = 0x10,      // Negotiation request
-    KISS_CMD_NEG_RESP = 0x11,     // Negotiation response
-    KISS_CMD_NEG_ACK = 0x12,      // Negotiation acknowledgment
-    KISS_CMD_MODE_CHANGE = 0x13,  // Mode change notification
-    KISS_CMD_QUALITY_FB = 0x14,   // Quality feedback
-    KISS_CMD_RETURN = 15
-};
-
 // KISS frame constants
 const uint8_t KISS_FEND = 0xC0;
 const uint8_t KISS_FESC = 0xDB;
 const uint8_t KISS_TFEND = 0xDC;
 const uint8_t KISS_TFESC = 0xDD;
+const size_t KISS_MAX_FRAME = 1024; //!< Longest frame accepted on the block input
+
+//! Device name that selects a virtual TNC on a pseudo-terminal
+const char* const KISS_PTY_DEVICE = "pty";
 
 /*!
  * \brief KISS TNC Implementation
@@ -68,26 +65,38 @@ class kiss_tnc_impl : public kiss_tnc {
     std::string d_device;                //!< Serial device path
     int d_baud_rate;                     //!< Baud rate
     bool d_hardware_flow_control;        //!< Hardware flow control flag
-    int d_serial_fd;                     //!< Serial file descriptor
-    kiss_state_t d_kiss_state;           //!< Current KISS state
-    bool d_escape_next;                  //!< Escape next byte flag
-    std::vector<uint8_t> d_frame_buffer; //!< Frame buffer
-    uint16_t d_frame_length;             //!< Current frame length
-    uint8_t d_ones_count;                //!< Consecutive ones count
-
-    // KISS parameters
-    int d_tx_delay;          //!< TX delay
-    int d_persistence;       //!< Persistence
-    int d_slot_time;         //!< Slot time
-    int d_tx_tail;           //!< TX tail
-    bool d_full_duplex;      //!< Full duplex mode
-    uint8_t d_hardware_type; //!< Hardware type
-    bool d_kiss_mode;        //!< KISS mode flag
+    int d_serial_fd;                     //!< Serial device, or the PTY master
+    int d_pty_slave_fd{ -1 };            //!< PTY slave, holds the line settings
+    std::string d_pty_path;              //!< PTY slave path, empty for a serial device
+    serial_config d_serial_config;       //!< Settings applied to d_serial_fd
+    std::atomic<int> d_actual_baud_rate{ 0 }; //!< Rate read back from the driver
+    kiss_dispatcher d_dispatch;          //!< Routes host frames; per-port parameters
+    std::vector<pmt::pmt_t> d_port_out;  //!< "port0".."port15" message ports
+    std::deque<uint8_t> d_host_out;      //!< KISS frames from port_in awaiting output
 
     // PTT control
-    bool d_ptt_enabled;      //!< PTT control enabled
-    bool d_ptt_state;        //!< Current PTT state (true = keyed)
-    bool d_use_dtr_for_ptt;  //!< Use DTR for PTT (false = use RTS)
+    bool d_ptt_enabled;             //!< PTT control enabled
+    std::atomic<bool> d_ptt_state;  //!< Current PTT state (true = keyed)
+    std::atomic<bool> d_use_dtr_for_ptt; //!< Use DTR for PTT (false = use RTS)
+    std::atomic<uint64_t> d_ptt_keys{ 0 };   //!< PTT line assertions
+    std::atomic<uint64_t> d_ptt_unkeys{ 0 }; //!< PTT line releases
+
+    // Transmit path: frames are queued here and written by the engine's thread
+    std::unique_ptr<kiss_tx_engine> d_tx;
+    std::atomic<int> d_tx_stats_interval_ms{ 0 }; //!< tx_stats period, 0 = off
+    std::mutex d_stats_mutex;
+    std::condition_variable d_stats_wake; //!< Interval changed or stopping
+    bool d_stats_stopping{ false };
+    std::thread d_stats_thread;           //!< Publishes tx_stats while running
+    // Receive path: device bytes arrive through the reader thread's ring
+    std::unique_ptr<kiss_rx_reader> d_rx;
+    std::atomic<bool> d_wake_posted{ false }; //!< A "wake" message is pending
+
+    // KISS-over-TCP server (tcp_port > 0)
+    std::unique_ptr<kiss_tcp_server> d_tcp;
+    std::mutex d_client_mutex;
+    std::deque<std::vector<uint8_t>> d_client_frames; //!< Client non-data frames
+    std::atomic<bool> d_client_frames_pending{ false };
 
   public:
     /*!
@@ -95,23 +104,36 @@ class kiss_tnc_impl : public kiss_tnc {
      * \param device Serial device path
      * \param baud_rate Baud rate
      * \param hardware_flow_control Hardware flow control flag
+     * \param tcp_port KISS-over-TCP server port (0 = disabled)
+     * \param tcp_bind_address IPv4 address the TCP server listens on
      */
-    kiss_tnc_impl(const std::string& device, int baud_rate, bool hardware_flow_control);
+    kiss_tnc_impl(const std::string& device, int baud_rate, bool hardware_flow_control,
+                  int tcp_port, const std::string& tcp_bind_address);
 
     /*!
      * \brief Destructor
      */
     ~kiss_tnc_impl();
 
+    bool start() override;
+    bool stop() override;
+
+    /*!
+     * \brief Input is optional: device bytes are produced whether or not input arrives
+     */
+    void forecast(int noutput_items, gr_vector_int& ninput_items_required) override;
+
     /*!
      * \brief Main work function
      * \param noutput_items Number of output items
+     * \param ninput_items Number of input items available
      * \param input_items Input items
      * \param output_items Output items
      * \return Number of items produced
      */
-    int work(int noutput_items, gr_vector_const_void_star& input_items,
-             gr_vector_void_star& output_items);
+    int general_work(int noutput_items, gr_vector_int& ninput_items,
+                     gr_vector_const_void_star& input_items,
+                     gr_vector_void_star& output_items) override;
 
     /*!
      * \brief Set TX delay
@@ -143,6 +165,8 @@ class kiss_tnc_impl : public kiss_tnc {
      */
     void set_full_duplex(bool full_duplex) override;
 
+    void set_dcd(bool busy) override;
+
     /*!
      * \brief Set PTT state
      * \param ptt_state PTT state (true = keyed, false = unkeyed)
@@ -167,6 +191,25 @@ class kiss_tnc_impl : public kiss_tnc {
      */
     void set_ptt_use_dtr(bool use_dtr) override;
 
+    void set_num_ports(int num_ports) override;
+    int num_ports() const override;
+
+    uint64_t rx_frames() const override;
+    uint64_t rx_overruns() const override;
+    uint64_t rx_overrun_bytes() const override;
+    std::vector<uint64_t> rx_latency_histogram() const override;
+    int actual_baud_rate() const override;
+    void set_low_latency(bool low_latency) override;
+    void set_read_thresholds(int vmin, int vtime) override;
+    size_t tx_bytes_in_flight() const override;
+    uint64_t tx_frames_dropped() const override;
+    std::string pty_path() const override;
+    uint64_t ptt_key_count() const override;
+    uint64_t ptt_unkey_count() const override;
+    void set_tx_queue_limits(int max_frames, int max_bytes) override;
+    void set_tx_drop_oldest(bool drop_oldest) override;
+    void set_tx_stats_interval(int interval_ms) override;
+
   private:
     /*!
      * \brief Open serial port
@@ -175,9 +218,67 @@ class kiss_tnc_impl : public kiss_tnc {
     bool open_serial_port();
 
     /*!
-     * \brief Process KISS frame
+     * \brief Allocate the pseudo-terminal of a virtual TNC
+     */
+    void open_pty();
+
+    /*!
+     * \brief Configure the open serial port, keeping \p config only if it applied
+     */
+    void apply_serial_config(const serial_config& config);
+
+    /*!
+     * \brief Data frame from the host on \p port: transmit port 0, publish every port
+     */
+    void handle_port_data(int port, const uint8_t* data, size_t length);
+
+    /*!
+     * \brief Parameter command applied to \p port: retime the TX engine for port 0 and
+     * publish the update for the port's modem
+     */
+    void handle_port_parameter(int port, uint8_t command, int value);
+
+    /*!
+     * \brief Negotiation extension frame: forward it on "negotiation_out"
+     */
+    void handle_negotiation(uint8_t type, const uint8_t* data, size_t length);
+
+    /*!
+     * \brief PDU from the port_in message port: KISS-frame it for the host side
+     */
+    void handle_port_in(const pmt::pmt_t& msg);
+
+    /*!
+     * \brief Queue an AX.25 frame for the air in its priority class
+     */
+    void queue_on_air(const uint8_t* frame, size_t length);
+
+    /*!
+     * \brief Publish the TX queue report on "tx_stats"
+     */
+    void publish_tx_stats();
+
+    /*!
+     * \brief tx_stats thread: publish every interval until stop()
+     */
+    void run_tx_stats();
+
+    /*!
+     * \brief Have the scheduler call general_work(): posts to the internal "wake" port
+     *        unless a wake-up is already pending. Any thread.
+     */
+    void wake_scheduler();
+
+    /*!
+     * \brief Carrier detect message from the dcd port
+     */
+    void handle_dcd(const pmt::pmt_t& msg);
+
+    /*!
+     * \brief Frame from a TCP client (server thread): data is queued for TX directly,
+     * anything else is handed to general_work()
      */
-    void process_kiss_frame();
+    void handle_client_frame(const uint8_t* frame, size_t length);
 
     /*!
      * \brief Send KISS frame
@@ -0,0 +1,388 @@
+/*
+ * Copyright 2024 gr-packet-protocols
+ *
+ * This file is part of gr-packet-protocols
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "kiss_tx_engine.h"
+#include <cerrno>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace gr {
+namespace packet_protocols {
+
+kiss_tx_engine::kiss_tx_engine(int fd,
+                               ptt_fn ptt,
+                               size_t max_frames,
+                               size_t max_in_flight,
+                               kiss_csma::clock_fn clock,
+                               kiss_csma::random_fn random)
+    : d_fd(fd), d_ptt(std::move(ptt)), d_max_frames(max_frames),
+      d_max_in_flight(max_in_flight), d_csma(std::move(clock), std::move(random)),
+      d_wake_fd(-1), d_timer_fd(-1) {
+    d_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    d_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (d_wake_fd < 0 || d_timer_fd < 0) {
+        if (d_wake_fd >= 0)
+            close(d_wake_fd);
+        if (d_timer_fd >= 0)
+            close(d_timer_fd);
+        throw std::runtime_error("kiss_tx_engine: failed to create eventfd/timerfd");
+    }
+    d_thread = std::thread(&kiss_tx_engine::run, this);
+}
+
+kiss_tx_engine::~kiss_tx_engine() {
+    d_stop.store(true);
+    wake();
+    d_thread.join();
+    close(d_timer_fd);
+    close(d_wake_fd);
+}
+
+kiss_tx_priority ax25_tx_priority(const uint8_t* frame, size_t length) {
+    // Address field: 7-byte entries until one has the extension bit set
+    size_t control = 0;
+    while (control + 7 <= length && !(frame[control + 6] & 0x01))
+        control += 7;
+    control += 7;
+    if (control >= length)
+        return KISS_TX_BULK;
+
+    const uint8_t c = frame[control];
+    const bool info_frame = !(c & 0x01) || (c & 0xEF) == 0x03; // I or UI
+    if (!info_frame)
+        return KISS_TX_CONTROL;
+    const size_t header = control + 2; // control + PID
+    const size_t info = length > header ? length - header : 0;
+    return info <= KISS_TX_INTERACTIVE_INFO ? KISS_TX_INTERACTIVE : KISS_TX_BULK;
+}
+
+bool kiss_tx_engine::enqueue(std::vector<uint8_t>&& bytes,
+                             bool keyed,
+                             kiss_tx_priority priority) {
+    const int cls = keyed ? static_cast<int>(priority) : KISS_TX_CONTROL;
+    if (cls < 0 || cls >= KISS_TX_CLASSES)
+        throw std::invalid_argument("kiss_tx_engine: invalid priority");
+    const int64_t now = d_csma.now();
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        if (!make_room(cls, bytes.size())) {
+            d_frames_dropped++;
+            d_history[cls].dropped++;
+            return false;
+        }
+        d_bytes_in_flight += bytes.size();
+        d_queued++;
+        if (keyed) {
+            d_queued_bytes[cls] += bytes.size();
+            d_queues[cls].push_back(tx_item{ std::move(bytes), true, cls, now });
+        } else {
+            d_device_queue.push_back(tx_item{ std::move(bytes), false, cls, now });
+        }
+    }
+    wake();
+    return true;
+}
+
+bool kiss_tx_engine::make_room(int priority, size_t size) {
+    while (d_queued >= d_max_frames.load() ||
+           d_bytes_in_flight.load() + size > d_max_in_flight.load()) {
+        // Victim: the lowest class with frames queued, no higher than the arriving one
+        int victim = KISS_TX_CLASSES - 1;
+        while (victim >= priority && d_queues[victim].empty())
+            victim--;
+        if (victim < priority)
+            return false;
+        const bool drop_oldest = d_drop_policy.load() == KISS_TX_DROP_OLDEST;
+        if (victim == priority && !drop_oldest)
+            return false;
+        drop_queued(d_queues[victim], drop_oldest);
+    }
+    return true;
+}
+
+void kiss_tx_engine::drop_queued(std::deque<tx_item>& queue, bool oldest) {
+    const tx_item& item = oldest ? queue.front() : queue.back();
+    d_bytes_in_flight -= item.bytes.size();
+    d_queued_bytes[item.priority] -= item.bytes.size();
+    d_queued--;
+    d_frames_dropped++;
+    d_history[item.priority].dropped++;
+    if (oldest)
+        queue.pop_front();
+    else
+        queue.pop_back();
+}
+
+void kiss_tx_engine::set_limits(size_t max_frames, size_t max_in_flight) {
+    d_max_frames.store(max_frames);
+    d_max_in_flight.store(max_in_flight);
+}
+
+std::array<kiss_tx_class_stats, KISS_TX_CLASSES> kiss_tx_engine::class_stats() const {
+    std::array<kiss_tx_class_stats, KISS_TX_CLASSES> stats;
+    std::lock_guard<std::mutex> lock(d_mutex);
+    for (int cls = 0; cls < KISS_TX_CLASSES; cls++) {
+        stats[cls].frames = d_queues[cls].size();
+        stats[cls].bytes = d_queued_bytes[cls];
+        stats[cls].sent = d_history[cls].sent.load();
+        stats[cls].dropped = d_history[cls].dropped.load();
+        stats[cls].sojourn_avg_ns = d_history[cls].sojourn_avg_ns.load();
+        stats[cls].sojourn_max_ns = d_history[cls].sojourn_max_ns.load();
+    }
+    return stats;
+}
+
+void kiss_tx_engine::set_full_duplex(bool full_duplex) {
+    d_csma.set_full_duplex(full_duplex);
+    wake();
+}
+
+void kiss_tx_engine::set_dcd(bool busy) {
+    d_csma.set_dcd(busy);
+    wake();
+}
+
+void kiss_tx_engine::wake() {
+    const uint64_t one = 1;
+    (void)write(d_wake_fd, &one, sizeof(one));
+}
+
+size_t kiss_tx_engine::queued() const {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    return d_queued;
+}
+
+size_t kiss_tx_engine::take(bool keyed_ok) {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    size_t taken = 0;
+    size_t bytes = 0;
+    // Stops at the first frame that does not fit, so a lower class never overtakes
+    auto move_from = [&](std::deque<tx_item>& queue) {
+        while (!queue.empty()) {
+            if (taken == static_cast<size_t>(KISS_TX_IOV_MAX) ||
+                (taken > 0 && bytes + queue.front().bytes.size() > KISS_TX_BATCH_BYTES))
+                return false;
+            bytes += queue.front().bytes.size();
+            if (queue.front().keyed)
+                d_queued_bytes[queue.front().priority] -= queue.front().bytes.size();
+            d_batch.push_back(std::move(queue.front()));
+            queue.pop_front();
+            d_queued--;
+            taken++;
+        }
+        return true;
+    };
+    if (move_from(d_device_queue) && keyed_ok) {
+        for (auto& queue : d_queues) {
+            if (!move_from(queue))
+                break;
+        }
+    }
+    return taken;
+}
+
+void kiss_tx_engine::retire(const tx_item& item) {
+    d_frames_sent++;
+    if (!item.keyed)
+        return;
+    class_history& history = d_history[item.priority];
+    const int64_t sojourn = d_csma.now() - item.enqueued;
+    const int64_t avg = history.sojourn_avg_ns.load();
+    history.sojourn_avg_ns.store(history.sent.load() == 0 ? sojourn
+                                                          : avg + (sojourn - avg) / 8);
+    if (sojourn > history.sojourn_max_ns.load())
+        history.sojourn_max_ns.store(sojourn);
+    history.sent++;
+}
+
+void kiss_tx_engine::drain_wakeup() {
+    uint64_t count;
+    while (read(d_wake_fd, &count, sizeof(count)) > 0) {
+    }
+}
+
+void kiss_tx_engine::wait_for_work() {
+    struct pollfd pfd = { d_wake_fd, POLLIN, 0 };
+    while (poll(&pfd, 1, -1) < 0 && errno == EINTR) {
+    }
+    drain_wakeup();
+}
+
+bool kiss_tx_engine::sleep_units(int units) {
+    return sleep_ns(static_cast<int64_t>(units) * 10000000LL);
+}
+
+bool kiss_tx_engine::sleep_ns(int64_t ns, bool until_wake) {
+    if (ns <= 0)
+        return !d_stop.load();
+
+    struct itimerspec its = {};
+    its.it_value.tv_sec = static_cast<time_t>(ns / 1000000000LL);
+    its.it_value.tv_nsec = static_cast<long>(ns % 1000000000LL);
+    timerfd_settime(d_timer_fd, 0, &its, nullptr);
+
+    struct pollfd pfds[2] = { { d_timer_fd, POLLIN, 0 }, { d_wake_fd, POLLIN, 0 } };
+    while (!d_stop.load()) {
+        if (poll(pfds, 2, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        if (pfds[0].revents & POLLIN) {
+            uint64_t expirations;
+            (void)read(d_timer_fd, &expirations, sizeof(expirations));
+            return true;
+        }
+        // New frames arriving during the delay are picked up by the batch loop
+        if (pfds[1].revents & POLLIN) {
+            drain_wakeup();
+            if (until_wake)
+                return !d_stop.load();
+        }
+    }
+    return false;
+}
+
+bool kiss_tx_engine::wait_writable() {
+    struct pollfd pfds[2] = { { d_fd, POLLOUT, 0 }, { d_wake_fd, POLLIN, 0 } };
+    while (!d_stop.load()) {
+        if (poll(pfds, 2, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        // POLLERR/POLLHUP also end the wait: the next writev() reports the error
+        if (pfds[0].revents)
+            return true;
+        if (pfds[1].revents & POLLIN)
+            drain_wakeup();
+    }
+    return false;
+}
+
+bool kiss_tx_engine::flush() {
+    struct iovec iov[KISS_TX_IOV_MAX];
+    while (!d_batch.empty()) {
+        int count = 0;
+        for (auto it = d_batch.begin(); it != d_batch.end() && count < KISS_TX_IOV_MAX;
+             ++it, ++count) {
+            const size_t skip = count == 0 ? d_batch_offset : 0;
+            iov[count].iov_base = const_cast<uint8_t*>(it->bytes.data()) + skip;
+            iov[count].iov_len = it->bytes.size() - skip;
+        }
+
+        ssize_t n = writev(d_fd, iov, count);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // Device buffer full: keep the remainder and resume once it drains
+                if (!wait_writable())
+                    return false;
+                continue;
+            }
+            // Device gone or broken: the frames cannot be sent
+            d_write_errors++;
+            for (const auto& item : d_batch) {
+                d_bytes_in_flight -= item.bytes.size();
+                if (item.keyed)
+                    d_history[item.priority].dropped++;
+            }
+            d_bytes_in_flight += d_batch_offset;
+            d_frames_dropped += d_batch.size();
+            d_batch.clear();
+            d_batch_offset = 0;
+            return true;
+        }
+        d_write_calls++;
+        d_bytes_in_flight -= static_cast<size_t>(n);
+
+        // Retire fully written frames; a short write leaves an offset into the front one
+        size_t written = static_cast<size_t>(n);
+        while (!d_batch.empty()) {
+            const size_t remaining = d_batch.front().bytes.size() - d_batch_offset;
+            if (written < remaining) {
+                d_batch_offset += written;
+                break;
+            }
+            written -= remaining;
+            retire(d_batch.front());
+            d_batch.pop_front();
+            d_batch_offset = 0;
+        }
+    }
+    return true;
+}
+
+bool kiss_tx_engine::acquire_channel() {
+    while (!d_stop.load()) {
+        // Device frames need no channel: they go out while on-air frames wait for it
+        if (take(false) > 0) {
+            if (!flush())
+                return false;
+            continue;
+        }
+        const int64_t wait = d_csma.access();
+        if (wait == 0)
+            return true;
+        if (wait == kiss_csma::WAIT_FOR_DCD)
+            wait_for_work(); // woken when DCD changes (or more frames arrive)
+        else if (!sleep_ns(wait, true))
+            return false; // a slot in progress resumes after the wake-up
+    }
+    return false;
+}
+
+void kiss_tx_engine::run() {
+    while (!d_stop.load()) {
+        // Frames for the device itself (not on air) go out as soon as they are queued
+        if (take(false) > 0) {
+            if (!flush())
+                break;
+            continue;
+        }
+        if (queued() == 0) {
+            wait_for_work();
+            continue;
+        }
+
+        // On-air frames wait for the channel
+        if (!acquire_channel())
+            break;
+        bool running = true;
+        if (!d_ptt_enabled.load()) {
+            while (running && take(true) > 0)
+                running = flush();
+            if (!running)
+                break;
+            continue;
+        }
+
+        // Key once, then send everything queued until TXTAIL expires with the queue empty
+        d_ptt(true);
+        d_keyups++;
+        running = sleep_units(d_tx_delay.load());
+        while (running) {
+            while (running && take(true) > 0)
+                running = flush();
+            running = running && sleep_units(d_tx_tail.load());
+            if (queued() == 0)
+                break;
+        }
+        d_ptt(false);
+    }
+}
+
+} // namespace packet_protocols
+} // namespace gr
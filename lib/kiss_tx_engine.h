@@ -0,0 +1,217 @@
+/*
+ * Copyright 2024 gr-packet-protocols
+ *
+ * This file is part of gr-packet-protocols
+ */
+
+#ifndef INCLUDED_PACKET_PROTOCOLS_KISS_TX_ENGINE_H
+#define INCLUDED_PACKET_PROTOCOLS_KISS_TX_ENGINE_H
+
+#include "kiss_csma.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gr {
+namespace packet_protocols {
+
+static const size_t KISS_TX_QUEUE_FRAMES = 64;         //!< Default queue bound (frames)
+static const size_t KISS_TX_MAX_IN_FLIGHT = 64 * 1024; //!< Default unwritten-bytes bound
+static const int KISS_TX_IOV_MAX = 64;                 //!< Frames coalesced per writev()
+static const size_t KISS_TX_BATCH_BYTES = 4096;        //!< Bytes taken per writev() batch
+static const size_t KISS_TX_INTERACTIVE_INFO = 64;     //!< Longest interactive info field
+
+//! Transmit priority classes, highest first
+enum kiss_tx_priority {
+    KISS_TX_CONTROL = 0,     //!< Link control: S frames and U frames other than UI
+    KISS_TX_INTERACTIVE = 1, //!< I and UI frames with a short information field
+    KISS_TX_BULK = 2         //!< Everything else
+};
+static const int KISS_TX_CLASSES = 3;
+
+//! What gives way when a frame arrives at a full queue
+enum kiss_tx_drop_policy {
+    KISS_TX_DROP_NEWEST = 0, //!< Refuse the arriving frame
+    KISS_TX_DROP_OLDEST = 1  //!< Evict the frame that has waited longest
+};
+
+//! Per-class queue state and history
+struct kiss_tx_class_stats {
+    size_t frames{ 0 };          //!< Currently queued
+    size_t bytes{ 0 };           //!< Currently queued
+    uint64_t sent{ 0 };          //!< Completely written to the device
+    uint64_t dropped{ 0 };       //!< Refused, evicted or lost to a write error
+    int64_t sojourn_avg_ns{ 0 }; //!< Smoothed (1/8) enqueue-to-written time
+    int64_t sojourn_max_ns{ 0 }; //!< Longest enqueue-to-written time
+};
+
+/*!
+ * \brief Priority class of an AX.25 frame (address, control, ...) from its control field.
+ *
+ * Supervisory and unnumbered frames other than UI carry the link state (ACKs, polls,
+ * connection setup) and are KISS_TX_CONTROL; I and UI frames are interactive up to
+ * KISS_TX_INTERACTIVE_INFO information bytes and bulk above. A frame whose address
+ * field does not terminate is bulk.
+ */
+kiss_tx_priority ax25_tx_priority(const uint8_t* frame, size_t length);
+
+/*!
+ * \brief KISS transmit engine: bounded frame queue drained by a dedicated thread.
+ *
+ * enqueue() never blocks; when the queue is full, or the frame would push the
+ * bytes in flight (queued or partly written) past their bound, the new frame is
+ * dropped and counted. On-air (keyed) frames first wait for the channel under
+ * p-persistent CSMA (kiss_csma: DCD, P, SLOTTIME, full-duplex bypass). The TX
+ * thread then keys PTT, waits TXDELAY, writes every frame queued by then (and
+ * any that arrive before TXTAIL expires) and unkeys once, so
+ * bursts share a single keyup. Delays are in KISS units of 10 ms and are timed
+ * with a CLOCK_MONOTONIC timerfd; an eventfd wakes the thread for new frames and
+ * shutdown, so destruction does not wait out a pending delay.
+ *
+ * Pending frames are written to the non-blocking device descriptor with one
+ * writev() per batch of up to KISS_TX_IOV_MAX frames. A short write resumes at
+ * the first unwritten byte; on EAGAIN the thread waits in poll() for POLLOUT
+ * rather than discarding the remainder. A hard write error drops the batch.
+ *
+ * On-air frames wait in one FIFO per kiss_tx_priority class and are taken highest
+ * class first, at most KISS_TX_BATCH_BYTES per writev(), so a link-control frame
+ * queued behind a bulk transfer waits for at most one batch. When a bound is reached
+ * the arriving frame evicts frames of lower classes; within its own class the drop
+ * policy decides between refusing it and evicting the oldest frame. Device frames
+ * (unkeyed) bypass the classes and go out first.
+ */
+class kiss_tx_engine
+{
+  public:
+    typedef std::function<void(bool)> ptt_fn;
+
+    /*!
+     * \param fd Non-blocking device descriptor written by the TX thread (not owned)
+     * \param ptt Called from the TX thread to key (true) / unkey (false) the transmitter
+     * \param max_frames Queue bound; further frames are dropped
+     * \param max_in_flight Bound on bytes accepted but not yet written
+     */
+    kiss_tx_engine(int fd,
+                   ptt_fn ptt,
+                   size_t max_frames = KISS_TX_QUEUE_FRAMES,
+                   size_t max_in_flight = KISS_TX_MAX_IN_FLIGHT,
+                   kiss_csma::clock_fn clock = kiss_csma::clock_fn(),
+                   kiss_csma::random_fn random = kiss_csma::random_fn());
+    ~kiss_tx_engine();
+
+    kiss_tx_engine(const kiss_tx_engine&) = delete;
+    kiss_tx_engine& operator=(const kiss_tx_engine&) = delete;
+
+    /*!
+     * \brief Queue \p bytes for transmission.
+     * \param keyed true for on-air data (PTT/TXDELAY/TXTAIL apply), false for
+     *        frames written straight to the device (e.g. KISS parameter frames)
+     * \param priority Class of an on-air frame
+     * \return false if the queue or byte bound was reached and the frame was dropped
+     */
+    bool enqueue(std::vector<uint8_t>&& bytes,
+                 bool keyed,
+                 kiss_tx_priority priority = KISS_TX_BULK);
+
+    void set_limits(size_t max_frames, size_t max_in_flight);
+    void set_drop_policy(kiss_tx_drop_policy policy) { d_drop_policy.store(policy); }
+
+    void set_tx_delay(int units) { d_tx_delay.store(units); }
+    void set_tx_tail(int units) { d_tx_tail.store(units); }
+    void set_ptt_enabled(bool enabled) { d_ptt_enabled.store(enabled); }
+    void set_persistence(int persistence) { d_csma.set_persistence(persistence); }
+    void set_slot_time(int units) { d_csma.set_slot_time(units); }
+    void set_full_duplex(bool full_duplex);
+    //! Carrier detect from the receiver; a frame waiting for a clear channel is woken
+    void set_dcd(bool busy);
+
+    size_t queued() const;
+    uint64_t frames_sent() const { return d_frames_sent.load(); }
+    uint64_t frames_dropped() const { return d_frames_dropped.load(); }
+    uint64_t keyups() const { return d_keyups.load(); }
+    size_t bytes_in_flight() const { return d_bytes_in_flight.load(); }
+    uint64_t write_calls() const { return d_write_calls.load(); }
+    uint64_t write_errors() const { return d_write_errors.load(); }
+    uint64_t slots_deferred() const { return d_csma.slots_deferred(); }
+    uint64_t busy_deferrals() const { return d_csma.busy_deferrals(); }
+    std::array<kiss_tx_class_stats, KISS_TX_CLASSES> class_stats() const;
+
+  private:
+    struct tx_item {
+        std::vector<uint8_t> bytes;
+        bool keyed;
+        int priority;     //!< kiss_tx_priority; device frames count as control
+        int64_t enqueued; //!< Clock reading at enqueue()
+    };
+
+    struct class_history {
+        std::atomic<uint64_t> sent{ 0 };
+        std::atomic<uint64_t> dropped{ 0 };
+        std::atomic<int64_t> sojourn_avg_ns{ 0 };
+        std::atomic<int64_t> sojourn_max_ns{ 0 };
+    };
+
+    void run();
+    //! Evict for a frame of \p priority and \p size; false if it must be refused
+    bool make_room(int priority, size_t size);
+    void drop_queued(std::deque<tx_item>& queue, bool oldest);
+    //! Move device frames, and on-air frames highest class first if \p keyed_ok, to the
+    //! write batch
+    size_t take(bool keyed_ok);
+    void retire(const tx_item& item); //!< Account a completely written frame
+    bool flush();              //!< Write the whole batch; false if stopped while waiting
+    bool wait_writable();      //!< false if stopped while waiting
+    bool acquire_channel();    //!< CSMA, sending device frames meanwhile; false if stopped
+    void wake();
+    void wait_for_work();
+    bool sleep_units(int units); //!< false if stopped while waiting
+    //! false if stopped while waiting; with until_wake, new frames also end the wait
+    bool sleep_ns(int64_t ns, bool until_wake = false);
+    void drain_wakeup();
+
+    const int d_fd;
+    ptt_fn d_ptt;
+    std::atomic<size_t> d_max_frames;
+    std::atomic<size_t> d_max_in_flight;
+    std::atomic<int> d_drop_policy{ KISS_TX_DROP_NEWEST };
+
+    mutable std::mutex d_mutex;
+    std::deque<tx_item> d_device_queue;            //!< Unkeyed frames
+    std::deque<tx_item> d_queues[KISS_TX_CLASSES]; //!< On-air frames by class
+    size_t d_queued_bytes[KISS_TX_CLASSES] = {};
+    size_t d_queued{ 0 }; //!< Frames in all queues
+    class_history d_history[KISS_TX_CLASSES];
+
+    // TX thread only: frames taken from the queue, front one partly written
+    std::deque<tx_item> d_batch;
+    size_t d_batch_offset{ 0 };
+
+    kiss_csma d_csma;
+
+    std::atomic<int> d_tx_delay{ 0 };
+    std::atomic<int> d_tx_tail{ 0 };
+    std::atomic<bool> d_ptt_enabled{ false };
+    std::atomic<bool> d_stop{ false };
+
+    std::atomic<uint64_t> d_frames_sent{ 0 };
+    std::atomic<uint64_t> d_frames_dropped{ 0 };
+    std::atomic<uint64_t> d_keyups{ 0 };
+    std::atomic<size_t> d_bytes_in_flight{ 0 };
+    std::atomic<uint64_t> d_write_calls{ 0 };
+    std::atomic<uint64_t> d_write_errors{ 0 };
+
+    int d_wake_fd;  //!< eventfd: new frames / shutdown
+    int d_timer_fd; //!< timerfd for TXDELAY / TXTAIL
+    std::thread d_thread;
+};
+
+} // namespace packet_protocols
+} // namespace gr
+
+#endif /* INCLUDED_PACKET_PROTOCOLS_KISS_TX_ENGINE_H */
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2024 gr-packet-protocols
+ *
+ * This file is part of gr-packet-protocols
+ */
+
+#ifndef INCLUDED_PACKET_PROTOCOLS_SPSC_RING_H
+#define INCLUDED_PACKET_PROTOCOLS_SPSC_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace gr {
+namespace packet_protocols {
+
+/*!
+ * \brief Lock-free single-producer / single-consumer ring.
+ *
+ * Capacity is rounded up to a power of two. Head and tail are free-running
+ * counters, each written by one side only; the producer publishes with a
+ * release store that the consumer acquires (and vice versa), so no locks are
+ * needed as long as exactly one thread pushes and one thread pops.
+ */
+template <typename T>
+class spsc_ring
+{
+  public:
+    explicit spsc_ring(size_t capacity)
+    {
+        size_t size = 1;
+        while (size < capacity)
+            size <<= 1;
+        d_buffer.resize(size);
+        d_mask = size - 1;
+    }
+
+    size_t capacity() const { return d_buffer.size(); }
+
+    size_t size() const
+    {
+        return d_head.load(std::memory_order_acquire) - d_tail.load(std::memory_order_acquire);
+    }
+
+    //! Producer: copy up to \p count items in, returns the number accepted
+    size_t push(const T* data, size_t count)
+    {
+        const size_t head = d_head.load(std::memory_order_relaxed);
+        const size_t tail = d_tail.load(std::memory_order_acquire);
+        const size_t n = std::min(count, capacity() - (head - tail));
+        for (size_t i = 0; i < n; i++)
+            d_buffer[(head + i) & d_mask] = data[i];
+        d_head.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    bool push(const T& item) { return push(&item, 1) == 1; }
+
+    //! Consumer: copy up to \p count items out, returns the number taken
+    size_t pop(T* out, size_t count)
+    {
+        const size_t tail = d_tail.load(std::memory_order_relaxed);
+        const size_t head = d_head.load(std::memory_order_acquire);
+        const size_t n = std::min(count, head - tail);
+        for (size_t i = 0; i < n; i++)
+            out[i] = d_buffer[(tail + i) & d_mask];
+        d_tail.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    bool pop(T& item) { return pop(&item, 1) == 1; }
+
+    //! Consumer: oldest item without removing it, or nullptr if empty
+    const T* front() const
+    {
+        const size_t tail = d_tail.load(std::memory_order_relaxed);
+        if (d_head.load(std::memory_order_acquire) == tail)
+            return nullptr;
+        return &d_buffer[tail & d_mask];
+    }
+
+  private:
+    std::vector<T> d_buffer;
+    size_t d_mask;
+    alignas(64) std::atomic<size_t> d_head{ 0 }; //!< Written by the producer
+    alignas(64) std::atomic<size_t> d_tail{ 0 }; //!< Written by the consumer
+};
+
+} // namespace packet_protocols
+} // namespace gr
+
+#endif /* INCLUDED_PACKET_PROTOCOLS_SPSC_RING_H */
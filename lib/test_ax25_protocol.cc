@@ -0,0 +1,959 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * AX.25 connected mode between two TNCs over a scripted channel: the send window closes
+ * after k unacknowledged I-frames and RR reopens it, REJ goes back to N(R) and resends
+ * exactly the frames from there, T1 expiry resends the unacknowledged window with P=1
+ * and drops the link after N2 tries, and a modulo-128 link keeps 100 frames in flight
+ * with two-byte control fields and sequence numbers wrapping past 127. With SREJ the
+ * receiver buffers frames behind a gap and requests only the missing ones, and the
+ * sender resends exactly those. The TX queue puts supervisory frames ahead of queued
+ * I-frames, drains in bursts of N, and holds back I-frames that do not fit without loss.
+ * The connection table grows to thousands of links, refuses SABM with DM when full, and
+ * keeps finding every remaining link after half of them disconnect. On a simulated clock
+ * T1 resends exactly when due, T2 acknowledges received frames, T3 polls an idle link and
+ * the answer stops it, an unanswered poll drops the link after N2 tries, and T3 of
+ * thousands of links fires at the exact millisecond after cascading down the wheel.
+ * Adaptive T1 adds the airtime of outstanding frames, converges on the measured round
+ * trip, backs off on expiry and ignores retransmitted frames until a fresh sample.
+ * Received frames are acknowledged by one RR per half window, a reply I-frame carries
+ * N(R) in place of the RR, and a poll is answered at once. The frame view parses a
+ * digipeated frame in place, agrees with the copying parse and rejects a broken E-bit
+ * chain, a single address, ten addresses, missing PID or FCS and oversized info fields.
+ * XID after SABME/UA, in the AX.25 v2.2 format with the I-field in bits, leaves both
+ * ends on the smaller window and I-field and the larger T1 and N2; SABM links, disabled
+ * negotiation and a peer answering FRMR keep the configured values, and an XID command
+ * from another v2.2 station is applied and answered.
+ * A message longer than N1 is split into full I-frames with PID 0x08 and reassembled
+ * into one; segments beyond the window follow as RR opens it, also on a modulo-8 link
+ * with k = 4, and a partial message is dropped once reassembly_timeout passes.
+ */
+
+#include <gnuradio/packet_protocols/ax25_protocol.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+
+typedef std::vector<uint8_t> bytes;
+
+void fail(const char* what) {
+    std::fprintf(stderr, "%s\n", what);
+    std::exit(1);
+}
+
+struct station {
+    ax25_tnc_t tnc;
+    ax25_address_t addr;
+    std::vector<std::string> received;
+
+    station(const char* call, uint8_t window) {
+        ax25_init(&tnc);
+        ax25_set_address(&addr, call, 0, false);
+        tnc.config.my_address = addr;
+        tnc.config.window_size = window;
+    }
+    ~station() { ax25_cleanup(&tnc); }
+};
+
+//! Frames the station transmits, in bursts of at most max_frames, until none is left
+std::vector<bytes> drain(station& s, int max_frames = 16) {
+    std::vector<bytes> out;
+    std::vector<uint8_t> burst(4 * AX25_MAX_FRAME_BYTES);
+    std::vector<uint16_t> lengths(max_frames);
+    int count;
+    while ((count = ax25_tx_drain(&s.tnc, burst.data(), burst.size(), lengths.data(),
+                                  max_frames)) > 0) {
+        size_t offset = 0;
+        for (int i = 0; i < count; i++) {
+            const auto begin = burst.begin() + offset;
+            out.push_back(bytes(begin, begin + lengths[i]));
+            offset += lengths[i];
+        }
+    }
+    return out;
+}
+
+void deliver(station& to, const bytes& frame) {
+    if (ax25_parse_frame(frame.data(), frame.size(), &to.tnc.rx_frame) != 0)
+        fail("parse failed");
+    if ((to.tnc.rx_frame.control & 0x01) != 0x00) {
+        ax25_process_frame(&to.tnc, &to.tnc.rx_frame);
+        return;
+    }
+    to.tnc.frame_ready = true;
+    ax25_address_t from;
+    uint8_t data[AX25_MAX_INFO];
+    uint16_t length = sizeof(data);
+    if (ax25_receive_data(&to.tnc, &from, data, &length) != 0)
+        return;
+    do {
+        if (length > 0) // 0: a segment, collected below once its message is complete
+            to.received.push_back(std::string(data, data + length));
+        length = sizeof(data);
+    } while (ax25_receive_pending(&to.tnc, &from, data, &length) == 0);
+    static std::vector<uint8_t> message(AX25_MAX_MESSAGE);
+    uint32_t message_length = message.size();
+    while (ax25_receive_message(&to.tnc, &from, message.data(), &message_length) == 0) {
+        to.received.push_back(
+            std::string(message.begin(), message.begin() + message_length));
+        message_length = message.size();
+    }
+    ax25_transmit_pending(&to.tnc);
+}
+
+void deliver_all(station& to, const std::vector<bytes>& frames) {
+    for (const bytes& frame : frames)
+        deliver(to, frame);
+}
+
+void link_up(station& a, station& b, bool extended) {
+    if (ax25_connect_extended(&a.tnc, &b.addr, extended) != 0)
+        fail("connect failed");
+    deliver_all(b, drain(a)); // SABM(E)
+    deliver_all(a, drain(b)); // UA
+    deliver_all(b, drain(a)); // XID command (SABME only)
+    deliver_all(a, drain(b)); // XID response
+    if (ax25_window_space(&a.tnc, &b.addr) < 1 || ax25_window_space(&b.tnc, &a.addr) < 1)
+        fail("link not established");
+}
+
+void send(station& from, const station& to, const std::string& payload) {
+    if (ax25_send_data(&from.tnc, &to.addr, reinterpret_cast<const uint8_t*>(payload.data()),
+                       payload.size()) != 0)
+        fail("send refused");
+}
+
+void ack(station& receiver, station& sender) {
+    ax25_send_supervisory(&receiver.tnc, &sender.addr, AX25_CTRL_RR);
+    deliver_all(sender, drain(receiver));
+}
+
+// N(S) of an encoded I-frame with two addresses
+int frame_ns(const bytes& frame, bool extended) {
+    return extended ? frame[14] >> 1 : (frame[14] >> 1) & 0x07;
+}
+
+void check_window() {
+    station a("N0AAA", 4), b("N0BBB", 4);
+    link_up(a, b, false);
+
+    for (int i = 0; i < 4; i++)
+        send(a, b, "frame " + std::to_string(i));
+    if (ax25_window_space(&a.tnc, &b.addr) != 0)
+        fail("window not closed after k frames");
+    if (ax25_send_data(&a.tnc, &b.addr, reinterpret_cast<const uint8_t*>("x"), 1) == 0)
+        fail("frame accepted beyond the window");
+
+    std::vector<bytes> frames = drain(a);
+    if (frames.size() != 4 || frame_ns(frames[3], false) != 3)
+        fail("window not transmitted in sequence");
+    deliver_all(b, frames);
+    if (b.received.size() != 4 || b.received[3] != "frame 3")
+        fail("in-sequence frames not delivered");
+
+    ack(b, a);
+    if (ax25_window_space(&a.tnc, &b.addr) != 4)
+        fail("RR did not reopen the window");
+
+    // The configured window is clamped to 7 on a modulo-8 link
+    station c("N0CCC", 100), d("N0DDD", 100);
+    link_up(c, d, false);
+    if (ax25_window_space(&c.tnc, &d.addr) != AX25_WINDOW_MAX)
+        fail("modulo-8 window not clamped");
+}
+
+void check_reject() {
+    station a("N0AAA", 4), b("N0BBB", 4);
+    link_up(a, b, false);
+    for (int i = 0; i < 4; i++)
+        send(a, b, std::to_string(i));
+    std::vector<bytes> frames = drain(a);
+
+    // Frame 1 is lost: frame 2 triggers one REJ, frame 3 is discarded silently
+    deliver(b, frames[0]);
+    deliver(b, frames[2]);
+    std::vector<bytes> reject = drain(b);
+    deliver(b, frames[3]);
+    if (reject.size() != 1 || (reject[0][14] & 0x0F) != AX25_CTRL_REJ ||
+        (reject[0][14] >> 5) != 1 || !drain(b).empty())
+        fail("expected exactly one REJ with N(R) = 1");
+
+    deliver_all(a, reject);
+    std::vector<bytes> resent = drain(a);
+    if (resent.size() != 3 || frame_ns(resent[0], false) != 1)
+        fail("REJ did not go back to N(R)");
+    deliver_all(b, resent);
+    if (b.received != std::vector<std::string>({ "0", "1", "2", "3" }))
+        fail("retransmission not delivered in order");
+    if (ax25_window_space(&a.tnc, &b.addr) != 1)
+        fail("N(R) of the REJ not acknowledged");
+}
+
+void check_t1() {
+    station a("N0AAA", 4), b("N0BBB", 4);
+    a.tnc.config.max_retries = 2;
+    link_up(a, b, false);
+    send(a, b, "lost 0");
+    send(a, b, "lost 1");
+    drain(a);
+
+    if (ax25_t1_expired(&a.tnc, &b.addr) != 0)
+        fail("T1 expiry failed");
+    std::vector<bytes> resent = drain(a);
+    if (resent.size() != 2 || frame_ns(resent[0], false) != 0 ||
+        !(resent[0][14] & AX25_CTRL_PF) || (resent[1][14] & AX25_CTRL_PF))
+        fail("T1 must resend the window with P set on the first frame");
+
+    deliver_all(b, resent);
+    ack(b, a);
+    if (ax25_t1_expired(&a.tnc, &b.addr) != 0 || !drain(a).empty())
+        fail("T1 fired with nothing outstanding");
+
+    send(a, b, "never acknowledged");
+    drain(a);
+    if (ax25_t1_expired(&a.tnc, &b.addr) != 0 || ax25_t1_expired(&a.tnc, &b.addr) != 0)
+        fail("link dropped before N2");
+    if (ax25_t1_expired(&a.tnc, &b.addr) != 1 || ax25_window_space(&a.tnc, &b.addr) != -1)
+        fail("link not dropped after N2");
+}
+
+void check_extended() {
+    station a("N0AAA", 100), b("N0BBB", 100);
+    link_up(a, b, true);
+    if (ax25_window_space(&a.tnc, &b.addr) != 100)
+        fail("extended window not applied");
+
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 100; i++)
+            send(a, b, std::to_string(round * 100 + i));
+        std::vector<bytes> frames = drain(a);
+        if (frames.size() != 100)
+            fail("extended window not transmitted");
+        if (frame_ns(frames[99], true) != (round * 100 + 99) % AX25_MODULO_EXTENDED)
+            fail("modulo-128 N(S) wrong");
+        deliver_all(b, frames);
+        ack(b, a);
+        if (ax25_window_space(&a.tnc, &b.addr) != 100)
+            fail("extended RR did not reopen the window");
+    }
+    if (b.received.size() != 300 || b.received[299] != "299")
+        fail("extended frames not delivered in order");
+}
+
+void check_srej() {
+    station a("N0AAA", 8), b("N0BBB", 8);
+    link_up(a, b, true);
+    for (int i = 0; i < 8; i++)
+        send(a, b, std::to_string(i));
+    std::vector<bytes> frames = drain(a);
+
+    // Frames 2 and 5 are lost: 3 requests 2, 6 requests 5, the rest only wait
+    std::vector<bytes> requests;
+    for (int i : { 0, 1, 3, 4, 6, 7 }) {
+        deliver(b, frames[i]);
+        for (const bytes& frame : drain(b))
+            requests.push_back(frame);
+    }
+    if (b.received != std::vector<std::string>({ "0", "1" }))
+        fail("frames behind the gap delivered early");
+    if (requests.size() != 2 || requests[0][14] != AX25_CTRL_SREJ ||
+        (requests[0][15] >> 1) != 2 || (requests[1][15] >> 1) != 5)
+        fail("expected SREJ for 2 and 5 only");
+
+    deliver_all(a, requests);
+    std::vector<bytes> resent = drain(a);
+    if (resent.size() != 2 || frame_ns(resent[0], true) != 2 ||
+        frame_ns(resent[1], true) != 5)
+        fail("SREJ must resend exactly the requested frames");
+    deliver_all(b, resent);
+    const std::vector<std::string> all = { "0", "1", "2", "3", "4", "5", "6", "7" };
+    if (b.received != all)
+        fail("buffered frames not delivered in order");
+
+    ack(b, a);
+    if (ax25_window_space(&a.tnc, &b.addr) != 8)
+        fail("window not reopened after SREJ recovery");
+}
+
+void check_tx_queue() {
+    station a("N0AAA", 10), b("N0BBB", 10);
+    link_up(a, b, true);
+
+    // Ten maximum-size frames exceed the data ring; the rest wait in the window
+    const std::string big(AX25_MAX_INFO - 1, 'x');
+    for (int i = 0; i < 10; i++)
+        send(a, b, std::to_string(i) + big);
+    if (ax25_tx_queued(&a.tnc) >= 10)
+        fail("data ring larger than expected");
+
+    // An RR queued after them is transmitted first
+    ax25_send_supervisory(&a.tnc, &b.addr, AX25_CTRL_RR);
+    std::vector<uint8_t> burst(4 * AX25_MAX_FRAME_BYTES);
+    uint16_t lengths[2];
+    int frames = 0;
+    int count;
+    while ((count = ax25_tx_drain(&a.tnc, burst.data(), burst.size(), lengths, 2)) > 0) {
+        if (count > 2)
+            fail("drain exceeded max_frames");
+        size_t offset = 0;
+        for (int i = 0; i < count; i++, frames++) {
+            const auto begin = burst.begin() + offset;
+            const bytes frame(begin, begin + lengths[i]);
+            offset += lengths[i];
+            if ((frames == 0) != ((frame[14] & 0x03) == AX25_FRAME_S))
+                fail("supervisory frame not sent ahead of I-frames");
+            deliver(b, frame);
+        }
+    }
+    if (frames != 11 || b.received.size() != 10 || b.received[9][0] != '9')
+        fail("frames held back by the full queue were lost or reordered");
+}
+
+// Encoded U frame from src to dst
+bytes u_frame(const ax25_address_t& src, const ax25_address_t& dst, uint8_t control) {
+    ax25_frame_t frame;
+    uint8_t data[AX25_MAX_FRAME_BYTES];
+    uint16_t length = sizeof(data);
+    if (ax25_create_frame(&frame, &src, &dst, control, 0, nullptr, 0) != 0 ||
+        ax25_encode_frame(&frame, data, &length) != 0)
+        fail("frame encoding failed");
+    return bytes(data, data + length);
+}
+
+// Deliver a U frame and return the control byte of the single response
+uint8_t exchange(station& server, const ax25_address_t& remote, uint8_t control) {
+    deliver(server, u_frame(remote, server.addr, control));
+    std::vector<bytes> response = drain(server);
+    if (response.size() != 1)
+        fail("expected one response");
+    return response[0][14] & 0xEF;
+}
+
+void check_connection_table() {
+    const int limit = 3000;
+    station server("N0SRV", 4);
+    server.tnc.config.max_connections = limit;
+    std::vector<ax25_address_t> remotes(limit + limit / 2 + 1);
+    for (size_t i = 0; i < remotes.size(); i++) {
+        const std::string call = "R" + std::to_string(10000 + i / 16);
+        ax25_set_address(&remotes[i], call.c_str(), i % 16, true);
+    }
+
+    for (int i = 0; i < limit; i++) {
+        if (exchange(server, remotes[i], AX25_CTRL_SABM) != AX25_CTRL_UA)
+            fail("SABM not accepted below the limit");
+    }
+    if (server.tnc.num_connections != limit)
+        fail("connection count wrong");
+    if (exchange(server, remotes[limit], AX25_CTRL_SABM) != AX25_CTRL_DM)
+        fail("full table must answer DM");
+
+    // Drop every other link; lookups must still find the rest
+    for (int i = 0; i < limit; i += 2)
+        exchange(server, remotes[i], AX25_CTRL_DISC);
+    for (int i = 0; i < limit; i++) {
+        if (ax25_window_space(&server.tnc, &remotes[i]) != (i % 2 ? 4 : -1))
+            fail("lookup wrong after disconnects");
+    }
+
+    // Freed entries are reused for new links
+    for (int i = limit; i < limit + limit / 2; i++) {
+        if (exchange(server, remotes[i], AX25_CTRL_SABM) != AX25_CTRL_UA)
+            fail("freed entry not reused");
+    }
+    if (server.tnc.num_connections != limit || server.tnc.connection_capacity != limit)
+        fail("table grew past the limit");
+    for (int i = 1; i < limit + limit / 2; i += 2) {
+        if (ax25_window_space(&server.tnc, &remotes[i]) != 4)
+            fail("link lost after reuse");
+    }
+}
+
+struct sim_clock {
+    uint64_t now = 0;
+};
+
+uint64_t read_clock(void* context) { return static_cast<sim_clock*>(context)->now; }
+
+void advance(sim_clock& clock, station& a, station& b, uint64_t now) {
+    clock.now = now;
+    ax25_tick(&a.tnc, now);
+    ax25_tick(&b.tnc, now);
+}
+
+void check_timers() {
+    sim_clock clock;
+    station a("N0AAA", 8), b("N0BBB", 8);
+    for (station* s : { &a, &b }) {
+        ax25_set_clock(&s->tnc, read_clock, &clock);
+        s->tnc.config.bit_rate = 0; // T1 without airtime
+    }
+    link_up(a, b, false);
+
+    // Both frames are lost; T1 (3 s) resends them with a poll
+    send(a, b, "lost 0");
+    send(a, b, "lost 1");
+    drain(a);
+    advance(clock, a, b, 2999);
+    if (!drain(a).empty())
+        fail("T1 fired early");
+    advance(clock, a, b, 3000);
+    std::vector<bytes> resent = drain(a);
+    if (resent.size() != 2 || !(resent[0][14] & AX25_CTRL_PF))
+        fail("T1 did not resend the window with a poll");
+
+    // The poll is answered at once, the frame after it waits for T2 (1 s)
+    deliver_all(b, resent);
+    std::vector<bytes> rr = drain(b);
+    if (rr.size() != 1 || rr[0][14] != (AX25_CTRL_RR | AX25_CTRL_PF | 1 << 5))
+        fail("polling I-frame not answered at once");
+    deliver_all(a, rr);
+    send(a, b, "delayed");
+    deliver_all(b, drain(a));
+    advance(clock, a, b, 3999);
+    if (!drain(b).empty())
+        fail("T2 acknowledged early");
+    advance(clock, a, b, 4000);
+    rr = drain(b);
+    if (rr.size() != 1 || rr[0][14] != (AX25_CTRL_RR | 3 << 5))
+        fail("T2 did not acknowledge both frames");
+    deliver_all(a, rr);
+
+    // Nothing heard for T3 (30 s): the receiver polls, the answer stops its T1
+    advance(clock, a, b, 32999);
+    if (!drain(a).empty() || !drain(b).empty())
+        fail("idle link polled early");
+    advance(clock, a, b, 33000);
+    std::vector<bytes> poll = drain(b);
+    if (poll.size() != 1 || poll[0][14] != (AX25_CTRL_RR | AX25_CTRL_PF | 3 << 5) ||
+        !(poll[0][6] & 0x80) || (poll[0][13] & 0x80))
+        fail("T3 did not poll with an RR command");
+    deliver_all(a, poll);
+    std::vector<bytes> answer = drain(a);
+    if (answer.size() != 1 || !(answer[0][14] & AX25_CTRL_PF) || !(answer[0][13] & 0x80))
+        fail("poll not answered with an RR response with F set");
+    deliver_all(b, answer);
+    advance(clock, a, b, 62999);
+    if (!drain(a).empty() || !drain(b).empty())
+        fail("answered poll repeated");
+
+    // Channel lost: one T3 poll and N2 T1 polls, then the link is dropped. The frame
+    // acknowledged by T2 measured 1 s, so T1 is SRTT + 4 * RTTVAR = 3 s, doubling on
+    // every expiry.
+    std::vector<uint64_t> polls;
+    for (uint64_t t = 63000; t < 108000; t += 500) {
+        advance(clock, a, b, t);
+        if (!drain(a).empty())
+            polls.push_back(t);
+        drain(b);
+    }
+    if (polls != std::vector<uint64_t>({ 63000, 66000, 72000, 84000 }) ||
+        ax25_window_space(&a.tnc, &b.addr) != AX25_WINDOW_MAX)
+        fail("link dropped before N2 polls");
+    advance(clock, a, b, 108000);
+    if (ax25_window_space(&a.tnc, &b.addr) != -1)
+        fail("link not dropped after N2 polls");
+}
+
+void check_timer_scale() {
+    const int links = 3000;
+    const uint64_t t3 = 300000; // Beyond 64^3 ms: starts on the top level of the wheel
+    sim_clock clock;
+    station server("N0SRV", 4);
+    server.tnc.config.max_connections = links;
+    server.tnc.config.t3_timeout = t3;
+    server.tnc.config.t1_timeout = 2 * t3; // No poll repeated within the test
+    ax25_set_clock(&server.tnc, read_clock, &clock);
+
+    // Links come up 7 ms apart
+    std::vector<ax25_address_t> remotes(links);
+    for (int i = 0; i < links; i++) {
+        const std::string call = "R" + std::to_string(10000 + i / 16);
+        ax25_set_address(&remotes[i], call.c_str(), i % 16, true);
+        clock.now = 7 * i;
+        ax25_tick(&server.tnc, clock.now);
+        if (exchange(server, remotes[i], AX25_CTRL_SABM) != AX25_CTRL_UA)
+            fail("link not accepted");
+    }
+
+    // Each T3 fires at its own millisecond, none early
+    int fired = 0;
+    for (uint64_t now = t3 - 1; now <= t3 + 7 * links; now += 50) {
+        clock.now = now;
+        fired += ax25_tick(&server.tnc, now);
+        drain(server);
+        const int due = now < t3 ? 0 : std::min<int>(links, (now - t3) / 7 + 1);
+        if (fired != due)
+            fail("T3 of idle links fired at the wrong time");
+    }
+}
+
+// One frame from a to b on a channel where it takes airtime ms, acknowledged by T2 of b
+void round_trip(sim_clock& clock, station& a, station& b, const std::string& payload,
+                uint64_t airtime) {
+    send(a, b, payload);
+    std::vector<bytes> frames = drain(a);
+    advance(clock, a, b, clock.now + airtime);
+    deliver_all(b, frames);
+    advance(clock, a, b, clock.now + b.tnc.config.t2_timeout);
+    deliver_all(a, drain(b));
+}
+
+void check_adaptive_t1() {
+    sim_clock clock;
+    station a("N0AAA", 4), b("N0BBB", 4);
+    for (station* s : { &a, &b }) {
+        ax25_set_clock(&s->tnc, read_clock, &clock);
+        s->tnc.config.bit_rate = 9600;
+        s->tnc.config.t1_min = 100;
+        s->tnc.config.t2_timeout = 200;
+    }
+    link_up(a, b, false);
+
+    // Before any measurement: the configured T1 plus the airtime of what is outstanding
+    if (ax25_t1_duration(&a.tnc, &b.addr) != 3000)
+        fail("initial T1 not the configured one");
+    const std::string big(1000, 'x');
+    send(a, b, big);
+    if (ax25_t1_duration(&a.tnc, &b.addr) != 3000 + (1000 + 21) * 8000 / 9600 + 1)
+        fail("airtime of the outstanding frame not added");
+
+    // 850 ms on the air and 200 ms of T2: SRTT converges on the 200 ms round trip
+    std::vector<bytes> frames = drain(a);
+    advance(clock, a, b, 851);
+    deliver_all(b, frames);
+    advance(clock, a, b, 1051);
+    deliver_all(a, drain(b));
+    if (ax25_t1_duration(&a.tnc, &b.addr) != 200 + 4 * 100)
+        fail("first sample must give SRTT + 4 * SRTT / 2");
+    for (int i = 0; i < 20; i++)
+        round_trip(clock, a, b, big, 851);
+    const int converged = ax25_t1_duration(&a.tnc, &b.addr);
+    if (converged < 200 || converged > 220)
+        fail("T1 did not converge on the round trip");
+
+    // A lost frame is resent after exactly T1, then after 2 * T1
+    send(a, b, "lost");
+    drain(a);
+    const uint64_t start = clock.now;
+    const int t1 = ax25_t1_duration(&a.tnc, &b.addr);
+    advance(clock, a, b, start + t1 - 1);
+    if (!drain(a).empty())
+        fail("adaptive T1 fired early");
+    advance(clock, a, b, start + t1);
+    if (drain(a).size() != 1)
+        fail("adaptive T1 did not fire");
+    advance(clock, a, b, start + 3 * t1);
+    std::vector<bytes> resent = drain(a);
+    if (resent.size() != 1)
+        fail("T1 not backed off to twice its value");
+
+    // Karn: the acknowledged retransmission gives no sample and T1 stays backed off
+    deliver_all(b, resent);
+    advance(clock, a, b, clock.now + 200);
+    deliver_all(a, drain(b));
+    if (ax25_t1_duration(&a.tnc, &b.addr) < 4 * 200)
+        fail("retransmitted frame used as a sample");
+    round_trip(clock, a, b, "fresh", 26);
+    if (ax25_t1_duration(&a.tnc, &b.addr) > 250)
+        fail("fresh sample did not end the backoff");
+
+    // Bounds
+    a.tnc.config.t1_max = 1000;
+    for (int i = 0; i < 4; i++)
+        send(a, b, std::string(2000, 'y'));
+    if (ax25_t1_duration(&a.tnc, &b.addr) != 1000)
+        fail("T1 not clamped to t1_max");
+    a.tnc.config.t1_max = 60000;
+    a.tnc.config.t1_min = 8000;
+    if (ax25_t1_duration(&a.tnc, &b.addr) != 8000)
+        fail("T1 not clamped to t1_min");
+}
+
+// Supervisory frames among the frames a station transmits
+int count_supervisory(const std::vector<bytes>& frames) {
+    int count = 0;
+    for (const bytes& frame : frames)
+        count += (frame[14] & 0x03) == 0x01 ? 1 : 0;
+    return count;
+}
+
+void check_delayed_ack() {
+    sim_clock clock;
+    station a("N0AAA", 8), b("N0BBB", 8);
+    for (station* s : { &a, &b })
+        ax25_set_clock(&s->tnc, read_clock, &clock);
+    link_up(a, b, true);
+
+    // Three frames wait for T2; the fourth fills half the window and is acknowledged at
+    // once by a single RR
+    for (int i = 0; i < 3; i++)
+        send(a, b, "data");
+    deliver_all(b, drain(a));
+    if (!drain(b).empty())
+        fail("frames acknowledged before half the window");
+    send(a, b, "data");
+    deliver_all(b, drain(a));
+    std::vector<bytes> rr = drain(b);
+    if (rr.size() != 1 || rr[0][14] != AX25_CTRL_RR || rr[0][15] >> 1 != 4)
+        fail("half a window not acknowledged by one RR");
+    deliver_all(a, rr);
+    if (ax25_window_space(&a.tnc, &b.addr) != 8)
+        fail("RR did not reopen the window");
+
+    // A reply sent before T2 carries N(R), and T2 then has nothing left to send
+    send(a, b, "question");
+    deliver_all(b, drain(a));
+    send(b, a, "answer");
+    std::vector<bytes> reply = drain(b);
+    if (reply.size() != 1 || (reply[0][14] & 0x01) != 0 || reply[0][15] >> 1 != 5)
+        fail("reply did not carry N(R)");
+    deliver_all(a, reply);
+    if (ax25_window_space(&a.tnc, &b.addr) != 8)
+        fail("piggybacked N(R) not applied");
+    advance(clock, a, b, b.tnc.config.t2_timeout);
+    if (!drain(b).empty())
+        fail("T2 acknowledged a frame already acknowledged by the reply");
+
+    // Bulk transfer: one RR per half window instead of one per frame
+    int sent = 0, acknowledgements = 0;
+    while (sent < 64) {
+        while (sent < 64 && ax25_window_space(&a.tnc, &b.addr) > 0) {
+            send(a, b, "bulk");
+            sent++;
+        }
+        deliver_all(b, drain(a));
+        std::vector<bytes> acks = drain(b);
+        acknowledgements += count_supervisory(acks);
+        deliver_all(a, acks);
+    }
+    if (b.received.size() != 4 + 1 + 64 || acknowledgements != 64 / 4)
+        fail("bulk transfer not acknowledged once per half window");
+}
+
+void check_frame_view() {
+    ax25_address_t src, dst, digis[2];
+    ax25_set_address(&src, "N0AAA", 1, false);
+    ax25_set_address(&dst, "APRS", 0, true);
+    ax25_set_address(&digis[0], "WIDE1", 1, true); // H set: already repeated
+    ax25_set_address(&digis[1], "WIDE2", 2, false);
+    ax25_frame_t frame;
+    ax25_create_frame(&frame, &src, &dst, AX25_CTRL_UI, AX25_PID_NONE,
+                      reinterpret_cast<const uint8_t*>("payload"), 7);
+    frame.addresses[2] = digis[0];
+    frame.addresses[3] = digis[1];
+    frame.num_addresses = 4;
+    uint8_t data[AX25_MAX_FRAME_BYTES];
+    uint16_t length = sizeof(data);
+    if (ax25_encode_frame(&frame, data, &length) != 0)
+        fail("frame encoding failed");
+
+    // The view points into data; addresses are read in place
+    ax25_frame_view_t view;
+    if (ax25_parse_frame_view(data, length, &view) != 0 || view.num_addresses != 4 ||
+        view.control != AX25_CTRL_UI || view.pid != AX25_PID_NONE ||
+        view.info != data + 4 * AX25_ADDR_LEN + 2 || view.info_length != 7 ||
+        view.fcs != ax25_calculate_fcs(data, length - 2))
+        fail("frame view fields wrong");
+    ax25_address_t repeated;
+    if (!ax25_view_address_equal(&view, 1, &src) ||
+        ax25_view_address_equal(&view, 0, &src) ||
+        ax25_view_address(&view, 2, &repeated) != 0 || !repeated.has_been_repeated ||
+        ax25_view_next_digipeater(&view) != 3)
+        fail("frame view addresses wrong");
+
+    // The copying parse gives the same frame
+    ax25_frame_t copy;
+    if (ax25_parse_frame(data, length, &copy) != 0 || copy.num_addresses != 4 ||
+        !ax25_address_equal(&copy.addresses[3], &digis[1]) || copy.info_length != 7 ||
+        std::string(copy.info, copy.info + 7) != "payload")
+        fail("copying parse differs from the view");
+
+    // E-bit chain and lengths
+    bytes broken(data, data + 4 * AX25_ADDR_LEN + 4); // Control, PID and FCS, no info
+    broken[4 * AX25_ADDR_LEN - 1] &= 0xFE;
+    if (ax25_parse_frame_view(broken.data(), broken.size(), &view) == 0)
+        fail("address chain running past the frame accepted");
+    broken.assign(data, data + length);
+    broken[AX25_ADDR_LEN - 1] |= 0x01;
+    if (ax25_parse_frame_view(broken.data(), broken.size(), &view) == 0)
+        fail("frame with a single address accepted");
+    if (ax25_parse_frame_view(data, 4 * AX25_ADDR_LEN + 3, &view) == 0)
+        fail("UI frame without PID and FCS accepted");
+    bytes long_path(10 * AX25_ADDR_LEN, 0x40);
+    long_path.back() = 0x61;
+    long_path.insert(long_path.end(), { AX25_CTRL_DM, 0, 0 });
+    if (ax25_parse_frame_view(long_path.data(), long_path.size(), &view) == 0)
+        fail("ten addresses accepted");
+    bytes oversized(data, data + 4 * AX25_ADDR_LEN + 2);
+    oversized.resize(oversized.size() + AX25_MAX_INFO + 2 + 2, 'x');
+    if (ax25_parse_frame_view(oversized.data(), oversized.size(), &view) == 0)
+        fail("oversized information field accepted");
+    oversized.resize(oversized.size() - 1);
+    if (ax25_parse_frame_view(oversized.data(), oversized.size(), &view) != 0)
+        fail("largest information field refused");
+}
+
+void check_xid() {
+    station a("N0AAA", 127), b("N0BBB", 32);
+    b.tnc.config.max_frame_length = 256;
+    b.tnc.config.t1_timeout = 5000;
+    b.tnc.config.max_retries = 6;
+    if (ax25_connect_extended(&a.tnc, &b.addr, true) != 0)
+        fail("connect failed");
+    deliver_all(b, drain(a));
+    deliver_all(a, drain(b));
+
+    // After UA the connecting station offers its own values in an XID command
+    std::vector<bytes> command = drain(a);
+    if (command.size() != 1 || command[0][14] != AX25_CTRL_XID_PF ||
+        !(command[0][6] & 0x80) || (command[0][13] & 0x80))
+        fail("no XID command after UA");
+    // FI, GI and GL, then I-field RX in bits, window RX, T1 and N2
+    const bytes offer = { 0x82, 0x80, 0x00, 0x0E, 0x06, 0x02, 0x40, 0x00,
+                          0x08, 0x01, 0x7F, 0x09, 0x02, 0x0B, 0xB8, 0x0A,
+                          0x01, 0x03 };
+    if (bytes(command[0].begin() + 15, command[0].end() - 2) != offer)
+        fail("XID command not in the AX.25 v2.2 format");
+    if (ax25_window_space(&a.tnc, &b.addr) != 127)
+        fail("window changed before the XID response");
+
+    // The peer applies the smaller k and N1 and the larger T1 and N2, and returns them
+    deliver_all(b, command);
+    if (ax25_window_space(&b.tnc, &a.addr) != 32 || ax25_max_info(&b.tnc, &a.addr) != 256)
+        fail("XID command not applied");
+    std::vector<bytes> response = drain(b);
+    ax25_frame_t frame;
+    ax25_xid_frame_t xid;
+    uint8_t retries[16];
+    uint8_t length = sizeof(retries);
+    if (response.size() != 1 ||
+        ax25_parse_frame(response[0].data(), response[0].size(), &frame) != 0 ||
+        ax25_parse_xid_frame(&frame, &xid) != 0 || !xid.is_response ||
+        ax25_get_xid_param(&xid, AX25_XID_PARAM_RETRY_COUNT, retries, &length) != 0 ||
+        length != 1 || retries[0] != 6)
+        fail("XID response does not carry the agreed values");
+    uint8_t ifield[16];
+    length = sizeof(ifield);
+    if (xid.format_id != AX25_XID_FMT_EXTENDED || xid.group_id != AX25_XID_GROUP_PARAMS ||
+        ax25_get_xid_param(&xid, AX25_XID_PARAM_IFIELD_RX, ifield, &length) != 0 ||
+        length != 2 || ifield[0] != 0x08 || ifield[1] != 0x00)
+        fail("XID response I-field not in bits");
+    deliver_all(a, response);
+    if (ax25_window_space(&a.tnc, &b.addr) != 32 || ax25_max_info(&a.tnc, &b.addr) != 256)
+        fail("XID response not applied");
+    if (ax25_t1_duration(&a.tnc, &b.addr) != 5000 ||
+        ax25_t1_duration(&b.tnc, &a.addr) != 5000)
+        fail("larger T1 not agreed");
+    const std::string too_long(257, 'x');
+    if (ax25_send_data(&a.tnc, &b.addr, reinterpret_cast<const uint8_t*>(too_long.data()),
+                       too_long.size()) == 0)
+        fail("I-field longer than the agreed N1 accepted");
+    send(a, b, std::string(256, 'x'));
+    deliver_all(b, drain(a));
+    if (b.received.size() != 1 || b.received[0].size() != 256)
+        fail("largest agreed I-field not delivered");
+
+    // SABM links and disabled negotiation keep the configured values
+    station c("N0CCC", 127), d("N0DDD", 32);
+    link_up(c, d, false);
+    if (ax25_window_space(&c.tnc, &d.addr) != AX25_WINDOW_MAX)
+        fail("XID exchanged on a SABM link");
+    station e("N0EEE", 127), f("N0FFF", 32);
+    e.tnc.config.xid_negotiation = false;
+    link_up(e, f, true);
+    if (ax25_window_space(&e.tnc, &f.addr) != 127 ||
+        ax25_window_space(&f.tnc, &e.addr) != 32)
+        fail("XID exchanged with negotiation disabled");
+
+    // An XID command as another v2.2 station sends it, with classes of procedures and
+    // HDLC optional functions ahead of the negotiated values
+    const bytes spec = { 0x82, 0x80, 0x00, 0x17, 0x02, 0x02, 0x21, 0x00, 0x03, 0x03,
+                         0x86, 0xA8, 0x02, 0x06, 0x02, 0x04, 0x00, 0x08, 0x01, 0x04,
+                         0x09, 0x02, 0x27, 0x10, 0x0A, 0x01, 0x0A };
+    ax25_address_t from = f.addr, to = e.addr;
+    to.ssid |= 0x80; // Command
+    if (ax25_create_frame(&frame, &from, &to, AX25_CTRL_XID_PF, AX25_PID_NONE,
+                          spec.data(), spec.size()) != 0)
+        fail("XID frame not created");
+    uint8_t data[AX25_MAX_FRAME_BYTES];
+    uint16_t data_length = sizeof(data);
+    if (ax25_encode_frame(&frame, data, &data_length) != 0)
+        fail("XID frame not encoded");
+    deliver(e, bytes(data, data + data_length));
+    if (ax25_window_space(&e.tnc, &f.addr) != 4 || ax25_max_info(&e.tnc, &f.addr) != 128 ||
+        ax25_t1_duration(&e.tnc, &f.addr) != 10000)
+        fail("AX.25 v2.2 XID command not applied");
+    response = drain(e);
+    length = sizeof(retries);
+    if (response.size() != 1 ||
+        ax25_parse_frame(response[0].data(), response[0].size(), &frame) != 0 ||
+        ax25_parse_xid_frame(&frame, &xid) != 0 || !xid.is_response ||
+        ax25_get_xid_param(&xid, AX25_XID_PARAM_RETRY_COUNT, retries, &length) != 0 ||
+        length != 1 || retries[0] != 10)
+        fail("no response to the AX.25 v2.2 XID command");
+
+    // A peer that rejects XID with FRMR keeps the link on the configured values
+    station g("N0GGG", 127), h("N0HHH", 32);
+    if (ax25_connect_extended(&g.tnc, &h.addr, true) != 0)
+        fail("connect failed");
+    deliver_all(h, drain(g));
+    deliver_all(g, drain(h));
+    if (drain(g).size() != 1)
+        fail("no XID command after UA");
+    deliver(g, u_frame(h.addr, g.addr, AX25_CTRL_FRMR));
+    if (ax25_window_space(&g.tnc, &h.addr) != 127)
+        fail("FRMR to XID dropped the link");
+}
+
+void check_segmentation() {
+    // Segment sizes: N1 - 2 octets in the first, N1 - 1 in every later one
+    if (ax25_segment_count(254, 256) != 1 || ax25_segment_count(255, 256) != 2 ||
+        ax25_segment_count(254 + 127 * 255, 256) != AX25_MAX_SEGMENTS ||
+        ax25_segment_count(255 + 127 * 255, 256) != -1)
+        fail("segment count wrong");
+
+    // Split and reassemble without a TNC; a missing segment discards the message
+    std::vector<uint8_t> message(10000);
+    for (size_t i = 0; i < message.size(); i++)
+        message[i] = static_cast<uint8_t>(i * 7);
+    const int count = ax25_segment_count(message.size(), 256);
+    ax25_reassembly_t reassembly = {};
+    std::vector<uint8_t> info(256);
+    for (int i = 0; i < count; i++) {
+        uint16_t length = info.size();
+        if (ax25_segment(message.data(), message.size(), AX25_PID_NONE, 256, i,
+                         info.data(), &length) != 0 ||
+            ax25_reassembly_add(&reassembly, info.data(), length) != (i + 1 == count))
+            fail("segment not reassembled");
+    }
+    if (reassembly.pid != AX25_PID_NONE ||
+        std::vector<uint8_t>(reassembly.data, reassembly.data + reassembly.length) !=
+            message)
+        fail("reassembled message differs");
+    for (int i : { 0, 2 }) {
+        uint16_t length = info.size();
+        ax25_segment(message.data(), message.size(), AX25_PID_NONE, 256, i, info.data(),
+                     &length);
+        if (ax25_reassembly_add(&reassembly, info.data(), length) != (i == 0 ? 0 : -1))
+            fail("segment out of order accepted");
+    }
+    ax25_reassembly_reset(&reassembly);
+
+    // Over a link with N1 = 256: maximally sized I-frames, one message delivered
+    sim_clock clock;
+    station a("N0AAA", 32), b("N0BBB", 32);
+    b.tnc.config.max_frame_length = 256;
+    for (station* s : { &a, &b })
+        ax25_set_clock(&s->tnc, read_clock, &clock);
+    link_up(a, b, true);
+    const std::string text(5000, 'm');
+    if (ax25_send_message(&a.tnc, &b.addr, reinterpret_cast<const uint8_t*>(text.data()),
+                          text.size()) != 0)
+        fail("message refused");
+    std::vector<bytes> frames = drain(a);
+    const size_t full = 2 * AX25_ADDR_LEN + 2 + 1 + 256 + 2; // Modulo-128 I-frame, N1 256
+    if (frames.size() != 20 || frames[0].size() != full || frames[18].size() != full ||
+        frames[0][16] != AX25_PID_SEGMENT)
+        fail("message not split into full segments");
+    deliver_all(b, frames);
+    if (b.received != std::vector<std::string>({ text }))
+        fail("message not reassembled");
+    deliver_all(a, drain(b));
+
+    // A message needing more segments than the window holds: the rest follow as N(R)
+    // opens the window, and nothing else is taken until the last one is buffered
+    const std::string huge(40 * 255, 'h');
+    ack(b, a);
+    if (ax25_window_space(&a.tnc, &b.addr) != 32 ||
+        ax25_send_message(&a.tnc, &b.addr, reinterpret_cast<const uint8_t*>(huge.data()),
+                          huge.size()) != 0)
+        fail("message larger than the window refused");
+    frames = drain(a);
+    if (frames.size() != 32 || ax25_window_space(&a.tnc, &b.addr) != 0 ||
+        ax25_send_message(&a.tnc, &b.addr, reinterpret_cast<const uint8_t*>(text.data()),
+                          text.size()) == 0 ||
+        ax25_send_data(&a.tnc, &b.addr, reinterpret_cast<const uint8_t*>("x"), 1) == 0)
+        fail("segments beyond the window not held back");
+    deliver_all(b, frames);
+    ack(b, a);
+    frames = drain(a);
+    if (frames.size() != 9 || ax25_window_space(&a.tnc, &b.addr) != 32 - 9)
+        fail("held segments not released by N(R)");
+    deliver_all(b, frames);
+    if (b.received != std::vector<std::string>({ text, huge }))
+        fail("message larger than the window not reassembled");
+    ack(b, a);
+
+    // A message whose segments stop arriving is dropped after reassembly_timeout
+    if (ax25_send_message(&a.tnc, &b.addr, reinterpret_cast<const uint8_t*>(text.data()),
+                          text.size()) != 0)
+        fail("message refused");
+    frames = drain(a);
+    frames.resize(3);
+    deliver_all(b, frames);
+    auto slots_used = [&b]() {
+        int used = 0;
+        for (const ax25_reassembly_t& r : b.tnc.reassembly)
+            used += r.connection != AX25_NO_CONNECTION ? 1 : 0;
+        return used;
+    };
+    if (slots_used() != 1)
+        fail("partial message not held");
+    clock.now = b.tnc.config.reassembly_timeout - 1;
+    ax25_tick(&b.tnc, clock.now);
+    if (slots_used() != 1)
+        fail("partial message dropped early");
+    clock.now = b.tnc.config.reassembly_timeout + 1;
+    ax25_tick(&b.tnc, clock.now);
+    if (slots_used() != 0 || b.received.size() != 2)
+        fail("partial message not dropped after reassembly_timeout");
+
+    // Modulo 8 with k = 4 and N1 = 256: a 3000-octet message takes three windows
+    station c("N0CCC", 4), d("N0DDD", 4);
+    for (station* s : { &c, &d })
+        s->tnc.config.max_frame_length = 256;
+    link_up(c, d, false);
+    std::string long_text(3000, ' ');
+    for (size_t i = 0; i < long_text.size(); i++)
+        long_text[i] = static_cast<char>('a' + i % 26);
+    if (ax25_send_message(&c.tnc, &d.addr,
+                          reinterpret_cast<const uint8_t*>(long_text.data()),
+                          long_text.size()) != 0)
+        fail("message longer than k * N1 refused");
+    int windows = 0;
+    for (; windows < 4 && d.received.empty(); windows++) {
+        frames = drain(c);
+        if (frames.size() != 4)
+            fail("window not filled with segments");
+        deliver_all(d, frames);
+        ack(d, c);
+    }
+    if (windows != 3 || d.received != std::vector<std::string>({ long_text }) ||
+        ax25_window_space(&c.tnc, &d.addr) != 4)
+        fail("message longer than k * N1 not delivered");
+}
+
+} // namespace
+
+int main() {
+    check_window();
+    check_reject();
+    check_t1();
+    check_extended();
+    check_srej();
+    check_tx_queue();
+    check_connection_table();
+    check_timers();
+    check_timer_scale();
+    check_adaptive_t1();
+    check_delayed_ack();
+    check_frame_view();
+    check_xid();
+    check_segmentation();
+    return 0;
+}
@@ -0,0 +1,198 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * HDLC carrier detect: a flag preamble asserts DCD within the configured number of
+ * flags, a frame (with or without bit stuffing) keeps it up, a single seven-ones error
+ * inside a frame does not drop it whether binary or text follows, a second error in the
+ * same text frame does, idle marking drops it exactly one hold-off after the first
+ * invalid run, a carrier without flags drops it at the flag timeout, and random noise
+ * almost never asserts it and drops it soon after a frame.
+ */
+
+#include "hdlc_dcd.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using gr::packet_protocols::HDLC_DCD_DEFAULT_FLAG_TIMEOUT;
+using gr::packet_protocols::HDLC_DCD_DEFAULT_HOLD_OFF;
+using gr::packet_protocols::hdlc_dcd;
+
+namespace {
+
+void fail(const char* what) {
+    std::fprintf(stderr, "%s\n", what);
+    std::exit(1);
+}
+
+void append_flags(std::vector<bool>& bits, int count) {
+    for (int i = 0; i < count; i++) {
+        for (bool b : { false, true, true, true, true, true, true, false })
+            bits.push_back(b);
+    }
+}
+
+// LSB-first octets with a zero stuffed after every five consecutive ones
+void append_stuffed(std::vector<bool>& bits, const std::vector<uint8_t>& data) {
+    int ones = 0;
+    for (uint8_t byte : data) {
+        for (int i = 0; i < 8; i++) {
+            const bool b = (byte >> i) & 1;
+            bits.push_back(b);
+            ones = b ? ones + 1 : 0;
+            if (ones == 5) {
+                bits.push_back(false);
+                ones = 0;
+            }
+        }
+    }
+}
+
+//! Feed bits; return the index of the first bit where DCD differs from `from`, or -1
+long run(hdlc_dcd& dcd, const std::vector<bool>& bits, bool from) {
+    for (size_t i = 0; i < bits.size(); i++) {
+        dcd.process(bits[i]);
+        if (dcd.dcd() != from)
+            return static_cast<long>(i);
+    }
+    return -1;
+}
+
+void check_frame() {
+    hdlc_dcd dcd;
+    std::vector<bool> bits;
+    append_flags(bits, 8);
+    if (run(dcd, bits, false) != 4 * 8 - 1)
+        fail("DCD not asserted on the fourth flag");
+
+    // Plain text never stuffs, binary data stuffs often; neither may drop DCD
+    bits.clear();
+    append_stuffed(bits, std::vector<uint8_t>(200, 'A'));
+    append_stuffed(bits, std::vector<uint8_t>(200, 0xFF));
+    append_flags(bits, 2);
+    if (run(dcd, bits, true) != -1)
+        fail("DCD dropped during a frame");
+
+    // Idle marking after the frame: drops one hold-off after the seventh one
+    dcd.set_hold_off(40);
+    bits.assign(200, true);
+    if (run(dcd, bits, true) != 6 + 40)
+        fail("hold-off not applied after loss of signal");
+}
+
+void check_bit_error() {
+    hdlc_dcd dcd;
+    std::vector<bool> bits;
+    append_flags(bits, 4);
+    run(dcd, bits, false);
+    if (!dcd.dcd())
+        fail("preamble not detected");
+
+    // A corrupted stuff bit gives seven ones; the frame data that follows stuffs again
+    bits.assign(7, true);
+    bits.push_back(false);
+    append_stuffed(bits, std::vector<uint8_t>(8, 0x3F));
+    append_flags(bits, 1);
+    if (run(dcd, bits, true) != -1)
+        fail("single invalid run dropped DCD");
+    if (dcd.invalid_runs() != 1 || dcd.valid_stuffs() < 2)
+        fail("stuffing statistics wrong");
+}
+
+void check_text_after_error() {
+    hdlc_dcd dcd;
+    std::vector<bool> bits;
+    append_flags(bits, 4);
+    run(dcd, bits, false);
+
+    // Text never stuffs: the data itself, free of invalid runs, must hold DCD
+    const std::string text = "The quick brown fox jumps over the lazy dog";
+    const std::vector<uint8_t> ascii(text.begin(), text.end());
+    bits.assign(7, true);
+    bits.push_back(false);
+    append_stuffed(bits, ascii);
+    append_stuffed(bits, ascii);
+    append_flags(bits, 1);
+    if (run(dcd, bits, true) != -1)
+        fail("text after an invalid run dropped DCD");
+    if (dcd.valid_stuffs() != 0)
+        fail("text stuffed");
+
+    // A second error in the same frame is not held by the data again
+    bits.assign(7, true);
+    bits.push_back(false);
+    append_stuffed(bits, ascii);
+    if (run(dcd, bits, true) != 6 + HDLC_DCD_DEFAULT_HOLD_OFF)
+        fail("second invalid run in a frame held by data");
+
+    // Two flags in a row start a new frame, which may be held once more
+    bits.clear();
+    append_flags(bits, 4);
+    run(dcd, bits, false);
+    bits.assign(7, true);
+    bits.push_back(false);
+    append_stuffed(bits, ascii);
+    if (run(dcd, bits, true) != -1)
+        fail("data hold not re-armed by flags");
+}
+
+void check_flag_timeout() {
+    hdlc_dcd dcd;
+    dcd.set_flag_timeout(1000);
+    std::vector<bool> bits;
+    append_flags(bits, 4);
+    run(dcd, bits, false);
+
+    // Valid data without a flag, as from a stuck transmitter, drops at the timeout
+    bits.clear();
+    append_stuffed(bits, std::vector<uint8_t>(200, 'A'));
+    if (run(dcd, bits, true) != 1000 - 1)
+        fail("DCD not dropped at the flag timeout");
+}
+
+void check_noise() {
+    std::minstd_rand engine(12345);
+    hdlc_dcd dcd;
+    const int total = 2000000;
+    int asserted = 0;
+    for (int i = 0; i < total; i++) {
+        dcd.process((engine() >> 8) & 1);
+        asserted += dcd.dcd() ? 1 : 0;
+    }
+    if (asserted > total / 1000)
+        fail("noise asserts DCD too often");
+    if (dcd.flags() == 0 || dcd.invalid_runs() == 0)
+        fail("noise statistics not counted");
+
+    // Noise after a frame drops DCD within a few hold-offs of the first invalid run
+    long total_bits = 0;
+    for (int frame = 0; frame < 1000; frame++) {
+        hdlc_dcd after;
+        std::vector<bool> bits;
+        append_flags(bits, 4);
+        run(after, bits, false);
+        long held = 0;
+        while (after.dcd() && held < HDLC_DCD_DEFAULT_FLAG_TIMEOUT) {
+            after.process((engine() >> 8) & 1);
+            held++;
+        }
+        if (after.dcd())
+            fail("noise held DCD past the flag timeout");
+        total_bits += held;
+    }
+    if (total_bits / 1000 > 2000)
+        fail("noise holds DCD too long after a frame");
+}
+
+} // namespace
+
+int main() {
+    check_frame();
+    check_bit_error();
+    check_text_after_error();
+    check_flag_timeout();
+    check_noise();
+    return 0;
+}
@@ -0,0 +1,362 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * IL2P framing: the 13-byte type 1 header must round-trip every field through scrambling and
+ * RS(15,13), correct a single-byte error, and payload blocks must round-trip and correct
+ * per-block errors for both FEC modes and all payload sizes up to IL2P_MAX_PAYLOAD_SIZE.
+ * Blocks must be balanced (sizes differ by at most one byte, larger blocks first) and the
+ * concurrent il2p_payload_decoder must agree with the sequential decode, including failures.
+ * AX.25 I, S, U and UI frames between two stations must translate into type 1 headers
+ * carrying only the information field, anything else into a type 0 header carrying the
+ * whole frame, and every frame must be rebuilt byte for byte after header coding.
+ * The IL2P+CRC trailer must return every CRC with any one bit of each byte flipped.
+ * The two header examples of the IL2P specification (as reproduced in Dire Wolf's
+ * il2p_test.c) must encode and decode bit for bit, which pins the header bit layout, the
+ * x^9 + x^4 + 1 scrambler and the first-root-0 RS parity to other implementations.
+ * With --timing, a full-size payload with an error in every block is also decoded
+ * sequentially and in parallel and the time per frame of each is reported.
+ */
+
+#include "il2p_frame.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace gr::packet_protocols;
+
+namespace {
+
+void fail(const char* what, size_t a, size_t b) {
+    std::fprintf(stderr, "%s (%zu, %zu)\n", what, a, b);
+    std::exit(1);
+}
+
+void check_header() {
+    il2p_block_codec codec;
+    il2p_header_fields in;
+    in.dest_callsign = "APRS";
+    in.dest_ssid = 7;
+    in.src_callsign = "N0CALL";
+    in.src_ssid = 15;
+    in.ui = true;
+    in.pid_code = il2p_pid_to_code(0xCC);
+    in.control = 0x55;
+    in.max_fec = true;
+    in.payload_length = 1023;
+
+    uint8_t encoded[IL2P_ENCODED_HEADER_SIZE];
+    if (!il2p_encode_header(codec, in, encoded))
+        fail("header encode failed", 0, 0);
+
+    for (int pos = -1; pos < IL2P_ENCODED_HEADER_SIZE; pos++) {
+        uint8_t rx[IL2P_ENCODED_HEADER_SIZE];
+        std::copy(encoded, encoded + IL2P_ENCODED_HEADER_SIZE, rx);
+        if (pos >= 0)
+            rx[pos] ^= 0xA5;
+        il2p_header_fields out;
+        if (!il2p_decode_header(codec, rx, out))
+            fail("header decode failed at error position", static_cast<size_t>(pos + 1), 0);
+        if (out.dest_callsign != in.dest_callsign || out.src_callsign != in.src_callsign ||
+            out.dest_ssid != in.dest_ssid || out.src_ssid != in.src_ssid || out.ui != in.ui ||
+            out.pid_code != in.pid_code || out.control != in.control ||
+            out.max_fec != in.max_fec || out.payload_length != in.payload_length)
+            fail("header field mismatch at error position", static_cast<size_t>(pos + 1), 0);
+    }
+}
+
+void check_crc_trailer() {
+    for (uint32_t crc = 0; crc <= 0xFFFF; crc++) {
+        uint8_t trailer[IL2P_CRC_SIZE];
+        il2p_encode_crc(static_cast<uint16_t>(crc), trailer);
+        if (il2p_decode_crc(trailer) != crc)
+            fail("CRC trailer not decoded", crc, 0);
+        for (int bit = 0; bit < 8; bit++) {
+            uint8_t rx[IL2P_CRC_SIZE];
+            for (int i = 0; i < IL2P_CRC_SIZE; i++)
+                rx[i] = static_cast<uint8_t>(trailer[i] ^ (1u << ((bit + i) % 8)));
+            if (il2p_decode_crc(rx) != crc)
+                fail("CRC trailer bit error missed", crc, static_cast<size_t>(bit));
+        }
+    }
+}
+
+void check_spec_headers() {
+    il2p_block_codec codec;
+
+    // Example 1, an AX.25 S frame: RR command from KK4HEJ-7 to KA2DEW-2, N(R) = 5, P set
+    const std::vector<uint8_t> s_frame = { 0x96, 0x82, 0x64, 0x88, 0x8A, 0xAE, 0xE4, 0x96,
+                                           0x96, 0x68, 0x90, 0x8A, 0x94, 0x6F, 0xB1 };
+    const uint8_t s_header[IL2P_HEADER_SIZE] = { 0x2B, 0xA1, 0x12, 0x24, 0x25, 0x77, 0x6B,
+                                                 0x2B, 0x54, 0x68, 0x25, 0x2A, 0x27 };
+    const uint8_t s_encoded[IL2P_ENCODED_HEADER_SIZE] = { 0x26, 0x57, 0x4D, 0x57, 0xF1,
+                                                          0x96, 0xCC, 0x85, 0x42, 0xE7,
+                                                          0x24, 0xF7, 0x2E, 0x8A, 0x97 };
+    il2p_header_fields fields;
+    const uint8_t* payload = nullptr;
+    size_t payload_length = 0;
+    if (!il2p_header_from_ax25(s_frame.data(), s_frame.size(), fields, payload,
+                               payload_length) ||
+        !fields.type1 || payload_length != 0)
+        fail("spec S frame not translated to a type 1 header", payload_length, 0);
+    uint8_t header[IL2P_HEADER_SIZE] = {};
+    if (!il2p_pack_header(fields, header) ||
+        !std::equal(header, header + IL2P_HEADER_SIZE, s_header))
+        fail("spec S frame header differs", 0, 0);
+    uint8_t encoded[IL2P_ENCODED_HEADER_SIZE];
+    if (!il2p_encode_header(codec, fields, encoded) ||
+        !std::equal(encoded, encoded + IL2P_ENCODED_HEADER_SIZE, s_encoded))
+        fail("spec S frame header coded differently", 0, 0);
+    std::vector<uint8_t> rebuilt;
+    if (!il2p_decode_header(codec, s_encoded, fields) ||
+        !il2p_ax25_from_header(fields, nullptr, 0, rebuilt) || rebuilt != s_frame)
+        fail("spec S frame not decoded", rebuilt.size(), 0);
+
+    // Example 2, from KK4HEJ-15 to CQ: decoded with a corrupted byte, then coded again
+    const uint8_t u_encoded[IL2P_ENCODED_HEADER_SIZE] = { 0x6A, 0xEA, 0x9C, 0xC2, 0x01,
+                                                          0x11, 0xFC, 0x14, 0x1F, 0xDA,
+                                                          0x6E, 0xF2, 0x53, 0x91, 0xBD };
+    uint8_t rx[IL2P_ENCODED_HEADER_SIZE];
+    std::copy(u_encoded, u_encoded + IL2P_ENCODED_HEADER_SIZE, rx);
+    rx[4] ^= 0xFF;
+    if (!il2p_decode_header(codec, rx, fields) || !fields.type1 ||
+        fields.dest_callsign != "CQ" || fields.dest_ssid != 0 ||
+        fields.src_callsign != "KK4HEJ" || fields.src_ssid != 15 ||
+        fields.payload_length != 0)
+        fail("spec example 2 header not decoded", fields.src_ssid, fields.payload_length);
+    if (!il2p_encode_header(codec, fields, encoded) ||
+        !std::equal(encoded, encoded + IL2P_ENCODED_HEADER_SIZE, u_encoded))
+        fail("spec example 2 header coded differently", 0, 0);
+}
+
+void append_address(std::vector<uint8_t>& frame, const char* callsign, int ssid, bool c,
+                    bool last) {
+    const std::string padded = std::string(callsign) + "      ";
+    for (int i = 0; i < 6; i++)
+        frame.push_back(static_cast<uint8_t>(padded[i] << 1));
+    frame.push_back(
+        static_cast<uint8_t>((c ? 0x80 : 0) | 0x60 | (ssid << 1) | (last ? 1 : 0)));
+}
+
+std::vector<uint8_t>
+ax25_frame(bool command, uint8_t control, int pid, const char* info) {
+    std::vector<uint8_t> frame;
+    append_address(frame, "APRS", 0, command, false);
+    append_address(frame, "N0CALL", 9, !command, true);
+    frame.push_back(control);
+    if (pid >= 0)
+        frame.push_back(static_cast<uint8_t>(pid));
+    frame.insert(frame.end(), info, info + std::string(info).size());
+    return frame;
+}
+
+// Translate, code the header, decode it and rebuild; returns the header type used
+bool check_translation(const std::vector<uint8_t>& frame, size_t info_length) {
+    il2p_block_codec codec;
+    il2p_header_fields fields;
+    fields.max_fec = true;
+    const uint8_t* payload = nullptr;
+    size_t payload_length = 0;
+    if (!il2p_header_from_ax25(
+            frame.data(), frame.size(), fields, payload, payload_length))
+        fail("AX.25 frame not translated", frame.size(), 0);
+    if (payload_length != (fields.type1 ? info_length : frame.size()) || !fields.max_fec)
+        fail("unexpected IL2P payload", frame.size(), payload_length);
+
+    uint8_t encoded[IL2P_ENCODED_HEADER_SIZE];
+    il2p_header_fields decoded;
+    std::vector<uint8_t> rebuilt;
+    if (!il2p_encode_header(codec, fields, encoded) ||
+        !il2p_decode_header(codec, encoded, decoded) ||
+        !il2p_ax25_from_header(decoded, payload, payload_length, rebuilt) ||
+        rebuilt != frame)
+        fail("AX.25 frame not rebuilt", frame.size(), fields.type1 ? 1 : 0);
+    return fields.type1;
+}
+
+void check_ax25_translation() {
+    struct {
+        bool command;
+        uint8_t control;
+        int pid;
+        const char* info;
+        bool type1;
+    } cases[] = {
+        { true, 0xB6, 0xF0, "I frame N(R)=5 P N(S)=3", true },
+        { true, 0x44, 0xCC, "", true },               // I frame, IP
+        { true, 0x01 | (6 << 5) | 0x10, -1, "", true }, // RR command with P
+        { false, 0x09 | (2 << 5), -1, "", true },       // REJ response
+        { true, 0x0D, -1, "", true },                   // SREJ command
+        { true, 0x3F, -1, "", true },                   // SABM with P
+        { false, 0x73, -1, "", true },                  // UA with F
+        { false, 0x0F, -1, "", true },                  // DM
+        { true, 0x53, -1, "", true },                   // DISC with P
+        { false, 0x87, -1, "\x11\x22\x33", true },     // FRMR with its information field
+        { true, 0xBF, -1, "\x82\x80\x00\x00", true }, // XID with P
+        { true, 0xE3, -1, "test", true },               // TEST
+        { true, 0x03, 0xF0, "UI beacon", true },
+        { false, 0x13, 0xF0, "UI response with F", true },
+        { true, 0x6F, -1, "", false },                  // SABME has no IL2P opcode
+        { true, 0x03, 0x42, "no PID code", false },
+        { false, 0x10, 0xF0, "I frame response", false },
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const auto& c = cases[i];
+        const std::vector<uint8_t> frame =
+            ax25_frame(c.command, c.control, c.pid, c.info);
+        if (check_translation(frame, std::string(c.info).size()) != c.type1)
+            fail("wrong IL2P header type", i, c.type1 ? 1 : 0);
+    }
+
+    // Digipeaters and callsigns outside SIXBIT only fit a type 0 header
+    std::vector<uint8_t> frame;
+    append_address(frame, "APRS", 0, true, false);
+    append_address(frame, "N0CALL", 9, false, false);
+    append_address(frame, "WIDE1", 1, false, true);
+    frame.push_back(0x03);
+    frame.push_back(0xF0);
+    if (check_translation(frame, 0))
+        fail("digipeated frame sent with a type 1 header", frame.size(), 0);
+    frame = ax25_frame(true, 0x03, 0xF0, "x");
+    frame[7] = 'n' << 1;
+    if (check_translation(frame, 1))
+        fail("lower-case callsign sent with a type 1 header", frame.size(), 0);
+
+    // Not an AX.25 frame: no E bit, or no control field
+    il2p_header_fields fields;
+    const uint8_t* payload = nullptr;
+    size_t payload_length = 0;
+    const std::vector<uint8_t> text(20, 'A' << 1);
+    if (il2p_header_from_ax25(text.data(), text.size(), fields, payload, payload_length))
+        fail("frame without an address end translated", text.size(), 0);
+    frame = ax25_frame(true, 0x03, -1, "");
+    frame.pop_back();
+    if (il2p_header_from_ax25(
+            frame.data(), frame.size(), fields, payload, payload_length))
+        fail("frame without control translated", frame.size(), 0);
+}
+
+void check_layout(size_t length, bool max_fec) {
+    const il2p_payload_layout layout = il2p_compute_payload_layout(length, max_fec);
+    const int max_block = max_fec ? 239 : 247;
+    if (layout.block_count != static_cast<int>((length + max_block - 1) / max_block))
+        fail("unexpected block count", length, static_cast<size_t>(layout.block_count));
+
+    size_t total = 0;
+    for (int b = 0; b < layout.block_count; b++) {
+        const size_t n = layout.data_size(b);
+        if (layout.data_offset(b) != total)
+            fail("block offset mismatch", length, static_cast<size_t>(b));
+        if (n != length / layout.block_count + (b < static_cast<int>(length % layout.block_count)))
+            fail("unbalanced block", length, static_cast<size_t>(b));
+        if (n + static_cast<size_t>(layout.parity_per_block) > 255)
+            fail("block exceeds RS(255) codeword", length, n);
+        total += n;
+    }
+    if (total != length)
+        fail("blocks do not cover the payload", length, total);
+}
+
+void check_payload(size_t length, bool max_fec, il2p_payload_decoder& parallel) {
+    il2p_block_codec codec;
+    std::vector<uint8_t> data(length);
+    for (size_t i = 0; i < length; i++)
+        data[i] = static_cast<uint8_t>((i * 29 + length) & 0xFF);
+
+    il2p_payload_layout layout = il2p_compute_payload_layout(length, max_fec);
+    if (layout.block_count > IL2P_MAX_PAYLOAD_BLOCKS)
+        fail("too many payload blocks", length, static_cast<size_t>(layout.block_count));
+
+    std::vector<uint8_t> encoded;
+    il2p_encode_payload(codec, layout, data.data(), encoded);
+    if (encoded.size() != layout.encoded_length)
+        fail("encoded payload length mismatch", length, encoded.size());
+
+    // One corrupted byte at the start of every block
+    size_t pos = 0;
+    for (int b = 0; b < layout.block_count; b++) {
+        encoded[pos] ^= 0x3C;
+        pos += layout.data_size(b) + static_cast<size_t>(layout.parity_per_block);
+    }
+
+    std::vector<uint8_t> decoded;
+    if (!il2p_decode_payload(codec, layout, encoded.data(), decoded) || decoded != data)
+        fail("payload round-trip failed", length, max_fec ? 1 : 0);
+    decoded.clear();
+    if (!parallel.decode(layout, encoded.data(), decoded) || decoded != data)
+        fail("parallel payload round-trip failed", length, max_fec ? 1 : 0);
+
+    // Wipe the last block beyond its correction capability: both decoders must reject it
+    const int last = layout.block_count - 1;
+    const size_t last_len = layout.data_size(last) + static_cast<size_t>(layout.parity_per_block);
+    for (size_t i = 0; i < last_len; i += 2)
+        encoded[layout.encoded_offset(last) + i] ^= static_cast<uint8_t>(0x5A + i);
+    const bool sequential_ok = il2p_decode_payload(codec, layout, encoded.data(), decoded);
+    const bool parallel_ok = parallel.decode(layout, encoded.data(), decoded);
+    if (sequential_ok != parallel_ok)
+        fail("parallel and sequential decode disagree", length, max_fec ? 1 : 0);
+}
+
+void report_payload_timing(il2p_payload_decoder& parallel) {
+    const int rounds = 200;
+    il2p_block_codec codec;
+    std::vector<uint8_t> data(IL2P_MAX_PAYLOAD_SIZE);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = static_cast<uint8_t>(i * 13);
+    const il2p_payload_layout layout = il2p_compute_payload_layout(data.size(), true);
+    std::vector<uint8_t> encoded;
+    il2p_encode_payload(codec, layout, data.data(), encoded);
+    for (int b = 0; b < layout.block_count; b++)
+        encoded[layout.encoded_offset(b)] ^= 0x3C;
+
+    typedef std::chrono::steady_clock clock;
+    std::vector<uint8_t> decoded;
+    const clock::time_point sequential_start = clock::now();
+    for (int i = 0; i < rounds; i++) {
+        decoded.clear();
+        if (!il2p_decode_payload(codec, layout, encoded.data(), decoded) ||
+            decoded != data)
+            fail("sequential timing decode failed", data.size(), static_cast<size_t>(i));
+    }
+    const clock::time_point parallel_start = clock::now();
+    for (int i = 0; i < rounds; i++) {
+        decoded.clear();
+        if (!parallel.decode(layout, encoded.data(), decoded) || decoded != data)
+            fail("parallel timing decode failed", data.size(), static_cast<size_t>(i));
+    }
+    const clock::time_point end = clock::now();
+
+    typedef std::chrono::duration<double, std::micro> micros;
+    std::printf("%zu-byte payload, %d blocks: sequential %.1f us, parallel %.1f us "
+                "per frame\n",
+                data.size(), layout.block_count,
+                micros(parallel_start - sequential_start).count() / rounds,
+                micros(end - parallel_start).count() / rounds);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    check_header();
+    check_spec_headers();
+    check_crc_trailer();
+    check_ax25_translation();
+    for (size_t length = 1; length <= IL2P_MAX_PAYLOAD_SIZE; length++) {
+        check_layout(length, false);
+        check_layout(length, true);
+    }
+
+    il2p_payload_decoder parallel;
+    for (size_t length = 1; length <= IL2P_MAX_PAYLOAD_SIZE; length += (length < 300 ? 1 : 17)) {
+        check_payload(length, false, parallel);
+        check_payload(length, true, parallel);
+    }
+    check_payload(IL2P_MAX_PAYLOAD_SIZE, false, parallel);
+    check_payload(IL2P_MAX_PAYLOAD_SIZE, true, parallel);
+    if (argc > 1 && std::strcmp(argv[1], "--timing") == 0)
+        report_payload_timing(parallel);
+    return 0;
+}
@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Bulk KISS codec: escaping must match a byte-at-a-time reference for payloads with no,
+ * sparse and dense FEND/FESC content, and the streaming unescaper must recover every
+ * frame unchanged however the encoded stream is split into chunks, including an escape
+ * split across chunks, shared FENDs, and oversized frames.
+ */
+
+#include "kiss_codec.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace gr::packet_protocols;
+
+namespace {
+
+typedef std::vector<uint8_t> bytes;
+
+void fail(const char* what) {
+    std::fprintf(stderr, "%s\n", what);
+    std::exit(1);
+}
+
+bytes reference_frame(uint8_t type, const bytes& data) {
+    bytes out = { 0xC0 };
+    bytes content = { type };
+    content.insert(content.end(), data.begin(), data.end());
+    for (uint8_t b : content) {
+        if (b == 0xC0) {
+            out.push_back(0xDB);
+            out.push_back(0xDC);
+        } else if (b == 0xDB) {
+            out.push_back(0xDB);
+            out.push_back(0xDD);
+        } else {
+            out.push_back(b);
+        }
+    }
+    out.push_back(0xC0);
+    return out;
+}
+
+bytes random_payload(std::mt19937& rng, size_t length, int special_percent) {
+    bytes data(length);
+    for (auto& b : data) {
+        const int roll = static_cast<int>(rng() % 100);
+        if (roll < special_percent)
+            b = (rng() & 1) ? 0xC0 : 0xDB;
+        else
+            b = static_cast<uint8_t>(rng());
+    }
+    return data;
+}
+
+void check_encode() {
+    std::mt19937 rng(1);
+    for (int density : { 0, 1, 10, 50, 100 }) {
+        for (size_t length : { 0, 1, 2, 15, 16, 17, 255, 1500 }) {
+            const bytes data = random_payload(rng, length, density);
+            const uint8_t type = static_cast<uint8_t>(rng());
+            bytes framed;
+            kiss_append_frame(framed, type, data.data(), data.size());
+            if (framed != reference_frame(type, data))
+                fail("encoded frame differs from reference");
+            if (framed.size() > kiss_encoded_size_max(length))
+                fail("encoded frame exceeds kiss_encoded_size_max");
+        }
+    }
+    // Type 0xC0 (port 12 data) must not terminate the frame early
+    bytes framed;
+    kiss_append_frame(framed, 0xC0, nullptr, 0);
+    if (framed != bytes{ 0xC0, 0xDB, 0xDC, 0xC0 })
+        fail("FEND type byte not escaped");
+}
+
+void check_decode_chunked() {
+    std::mt19937 rng(2);
+    std::vector<bytes> frames;
+    bytes stream;
+    for (int f = 0; f < 300; f++) {
+        const uint8_t type = static_cast<uint8_t>(f & 0xF0);
+        const bytes data = random_payload(rng, 1 + rng() % 600, f % 3 == 0 ? 0 : 5);
+        bytes content = { type };
+        content.insert(content.end(), data.begin(), data.end());
+        frames.push_back(content);
+        kiss_append_frame(stream, type, data.data(), data.size());
+        if (f % 4 == 0)
+            stream.pop_back(); // share the FEND with the next frame
+        if (f % 7 == 0)
+            stream.insert(stream.end(), { 0xC0, 0xC0 }); // idle fill
+    }
+    stream.push_back(0xC0);
+
+    const size_t chunk_limits[] = { 1, 2, 7, 64, stream.size() };
+    for (size_t max_chunk : chunk_limits) {
+        kiss_unescaper unescaper(1024);
+        std::vector<bytes> received;
+        size_t in_place = 0;
+        size_t offset = 0;
+        while (offset < stream.size()) {
+            const size_t n = std::min(stream.size() - offset, 1 + rng() % max_chunk);
+            const uint8_t* chunk = stream.data() + offset;
+            unescaper.feed(chunk, n, [&](const uint8_t* frame, size_t length) {
+                if (frame >= chunk && frame < chunk + n)
+                    in_place++;
+                received.emplace_back(frame, frame + length);
+            });
+            offset += n;
+        }
+        if (received != frames)
+            fail("unescaped frames differ");
+        if (max_chunk == stream.size() && in_place == 0)
+            fail("escape-free frames were copied");
+    }
+}
+
+void check_decode_edges() {
+    kiss_unescaper unescaper(8);
+    std::vector<bytes> received;
+    auto collect = [&](const uint8_t* frame, size_t length) {
+        received.emplace_back(frame, frame + length);
+    };
+
+    // Bytes before the first FEND are noise; FESC split from its TFEND
+    const bytes a = { 0x11, 0x22, 0xC0, 0x00, 0x01, 0xDB };
+    const bytes b = { 0xDC, 0x02, 0xC0 };
+    unescaper.feed(a.data(), a.size(), collect);
+    unescaper.feed(b.data(), b.size(), collect);
+    // Oversized frame is dropped, the following one survives
+    const bytes c = { 0x00, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0xC0, 0x00, 0xDB, 0xDD, 0xC0 };
+    unescaper.feed(c.data(), c.size(), collect);
+
+    const std::vector<bytes> expected = { { 0x00, 0x01, 0xC0, 0x02 }, { 0x00, 0xDB } };
+    if (received != expected)
+        fail("edge-case frames differ");
+    if (unescaper.frames_oversized() != 1)
+        fail("oversized frame not counted");
+}
+
+} // namespace
+
+int main() {
+    check_encode();
+    check_decode_chunked();
+    check_decode_edges();
+    return 0;
+}
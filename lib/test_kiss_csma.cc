@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * p-persistent CSMA against a mock clock and scripted random draws: a draw <= P transmits,
+ * a larger one defers by exactly one SLOTTIME with no further draw before the slot ends,
+ * carrier detect blocks access and voids a pending slot, full duplex and SLOTTIME 0 bypass
+ * the procedure, and the built-in generator gives the expected mean deferral for P.
+ */
+
+#include "kiss_csma.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+
+using gr::packet_protocols::kiss_csma;
+
+namespace {
+
+const int64_t MS = 1000000;
+
+void fail(const char* what) {
+    std::fprintf(stderr, "%s\n", what);
+    std::exit(1);
+}
+
+struct mock {
+    int64_t now = 0;
+    std::deque<uint8_t> draws;
+    int drawn = 0;
+
+    kiss_csma::clock_fn clock() {
+        return [this] { return now; };
+    }
+    kiss_csma::random_fn random() {
+        return [this] {
+            if (draws.empty())
+                fail("unexpected random draw");
+            drawn++;
+            const uint8_t value = draws.front();
+            draws.pop_front();
+            return value;
+        };
+    }
+};
+
+void check_slot_schedule() {
+    mock m;
+    kiss_csma csma(m.clock(), m.random());
+    csma.set_persistence(63);
+    csma.set_slot_time(10); // 100 ms
+    m.draws = { 200, 64, 63 };
+
+    if (csma.access() != 100 * MS)
+        fail("draw above P did not defer one slot");
+    m.now = 40 * MS;
+    if (csma.access() != 60 * MS || m.drawn != 1)
+        fail("drew again before the slot ended");
+    m.now = 100 * MS;
+    if (csma.access() != 100 * MS)
+        fail("P + 1 must defer");
+    m.now = 200 * MS;
+    if (csma.access() != 0)
+        fail("draw equal to P must transmit");
+    if (csma.slots_deferred() != 2 || m.drawn != 3)
+        fail("deferral count wrong");
+}
+
+void check_dcd() {
+    mock m;
+    kiss_csma csma(m.clock(), m.random());
+    csma.set_persistence(0);
+    csma.set_slot_time(10);
+    m.draws = { 9 };
+    if (csma.access() != 100 * MS)
+        fail("expected a deferral");
+
+    // Carrier mid-slot: wait for it, then draw immediately once it clears
+    m.now = 50 * MS;
+    csma.set_dcd(true);
+    if (csma.access() != kiss_csma::WAIT_FOR_DCD || csma.access() != kiss_csma::WAIT_FOR_DCD)
+        fail("busy channel not reported");
+    if (csma.busy_deferrals() != 1)
+        fail("busy period counted more than once");
+    csma.set_dcd(false);
+    m.now = 60 * MS;
+    m.draws = { 0 };
+    if (csma.access() != 0 || m.drawn != 2)
+        fail("pending slot not voided by carrier");
+
+    csma.set_dcd(true);
+    csma.set_full_duplex(true);
+    if (csma.access() != 0)
+        fail("full duplex must ignore DCD");
+}
+
+void check_no_slot_time() {
+    mock m;
+    kiss_csma csma(m.clock(), m.random());
+    csma.set_persistence(0);
+    csma.set_slot_time(0);
+    if (csma.access() != 0 || m.drawn != 0)
+        fail("SLOTTIME 0 must transmit without drawing");
+}
+
+void check_default_generator() {
+    // P = 127 succeeds with probability 1/2 per slot: one deferral per frame on average
+    int64_t now = 0;
+    kiss_csma csma([&now] { return now; });
+    csma.set_persistence(127);
+    csma.set_slot_time(1);
+    const int frames = 20000;
+    for (int f = 0; f < frames; f++) {
+        int64_t wait;
+        while ((wait = csma.access()) != 0)
+            now += wait;
+    }
+    const double mean = static_cast<double>(csma.slots_deferred()) / frames;
+    if (mean < 0.9 || mean > 1.1)
+        fail("default generator does not match P");
+}
+
+} // namespace
+
+int main() {
+    check_slot_schedule();
+    check_dcd();
+    check_no_slot_time();
+    check_default_generator();
+    return 0;
+}
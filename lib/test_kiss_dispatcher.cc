@@ -0,0 +1,190 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * KISS frame dispatch of kiss_tnc, without a serial device: data frames reach the port
+ * in their high nibble and parameter commands update only that port's parameters, frames
+ * for unrouted ports and commands without an argument are dropped, host frames for
+ * port_in carry the port nibble and are refused for unrouted ports, the negotiation types
+ * 0x10-0x14 are matched on the whole type byte and only while port 1 is not routed, 0xFF
+ * leaves KISS mode, and FEND/FESC in the block's signed char input are recognised.
+ */
+
+#include "kiss_dispatcher.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace gr::packet_protocols;
+
+namespace {
+
+typedef std::vector<uint8_t> bytes;
+
+void fail(const char* what) {
+    std::fprintf(stderr, "%s\n", what);
+    std::exit(1);
+}
+
+struct recorder {
+    struct data {
+        int port;
+        bytes payload;
+    };
+    struct parameter {
+        int port;
+        std::string name;
+        int value;
+    };
+    struct negotiation {
+        uint8_t type;
+        bytes payload;
+    };
+    std::vector<data> data_frames;
+    std::vector<parameter> parameters;
+    std::vector<negotiation> negotiations;
+    kiss_dispatcher dispatch;
+
+    recorder()
+        : dispatch(
+              1024,
+              [this](int port, const uint8_t* d, size_t length) {
+                  data_frames.push_back({ port, bytes(d, d + length) });
+              },
+              [this](int port, uint8_t command, int value) {
+                  parameters.push_back({ port, kiss_parameter_name(command), value });
+              },
+              [this](uint8_t type, const uint8_t* d, size_t length) {
+                  negotiations.push_back({ type, bytes(d, d + length) });
+              }) {}
+
+    void frame(const bytes& f) { dispatch.dispatch(f.data(), f.size()); }
+};
+
+void check_port_routing() {
+    recorder r;
+    r.dispatch.set_num_ports(4);
+    r.frame({ 0x00, 'a' });
+    r.frame({ 0x30, 'd', 'e' });
+    r.frame({ 0x40, 'x' }); // Port 4 is not routed
+    r.frame({ 0x20 });      // Data frame without data
+    if (r.data_frames.size() != 2 || r.data_frames[0].port != 0 ||
+        r.data_frames[0].payload != bytes({ 'a' }) || r.data_frames[1].port != 3 ||
+        r.data_frames[1].payload != bytes({ 'd', 'e' }))
+        fail("data frames not routed by port nibble");
+}
+
+void check_port_parameters() {
+    recorder r;
+    r.dispatch.set_num_ports(3);
+    r.frame({ 0x21, 30 });  // TXDELAY on port 2
+    r.frame({ 0x22, 128 }); // P on port 2
+    r.frame({ 0x03, 5 });   // SLOTTIME on port 0
+    r.frame({ 0x14, 2 });   // TXTAIL on port 1
+    r.frame({ 0x15, 1 });   // FULLDUPLEX on port 1
+    r.frame({ 0x26, 7 });   // SETHARDWARE on port 2
+    r.frame({ 0x21 });      // Missing argument
+    r.frame({ 0x31, 99 });  // Port 3 is not routed
+    r.frame({ 0x27, 1 });   // Not a parameter
+
+    const kiss_port_params defaults;
+    const kiss_port_params& p0 = r.dispatch.params(0);
+    const kiss_port_params& p1 = r.dispatch.params(1);
+    const kiss_port_params& p2 = r.dispatch.params(2);
+    if (p2.tx_delay != 30 || p2.persistence != 128 || p2.hardware != 7 ||
+        p2.slot_time != defaults.slot_time)
+        fail("port 2 parameters wrong");
+    if (p0.slot_time != 5 || p0.tx_delay != defaults.tx_delay)
+        fail("port 0 parameters wrong");
+    if (p1.tx_tail != 2 || !p1.full_duplex || p1.tx_delay != defaults.tx_delay)
+        fail("port 1 parameters wrong");
+    if (r.dispatch.params(3).tx_delay != defaults.tx_delay)
+        fail("unrouted port changed");
+
+    const char* names[] = { "tx_delay", "persistence", "slot_time",
+                            "tx_tail",  "full_duplex", "hardware" };
+    const int ports[] = { 2, 2, 0, 1, 1, 2 };
+    const int values[] = { 30, 128, 5, 2, 1, 7 };
+    if (r.parameters.size() != 6)
+        fail("wrong number of parameter updates");
+    for (size_t i = 0; i < 6; i++) {
+        if (r.parameters[i].name != names[i] || r.parameters[i].port != ports[i] ||
+            r.parameters[i].value != values[i])
+            fail("parameter update does not name its port and value");
+    }
+    if (!r.data_frames.empty())
+        fail("parameter command delivered as data");
+}
+
+void check_host_frames() {
+    recorder r;
+    r.dispatch.set_num_ports(2);
+    const bytes data = { 'h', 0xC0, 0xDB };
+    bytes out;
+    if (!r.dispatch.host_frame(1, data.data(), data.size(), out) ||
+        out != bytes({ 0xC0, 0x10, 'h', 0xDB, 0xDC, 0xDB, 0xDD, 0xC0 }))
+        fail("port_in frame not KISS-framed with its port nibble");
+    if (r.dispatch.host_frame(2, data.data(), data.size(), out) ||
+        r.dispatch.host_frame(-1, data.data(), data.size(), out) || out.size() != 8)
+        fail("port_in frame for an unrouted port accepted");
+}
+
+void check_type_matching() {
+    // With a single port the extension types are negotiation frames
+    recorder r;
+    for (uint8_t type = 0x10; type <= 0x14; type++)
+        r.frame({ type, 'n' });
+    r.frame({ 0x15, 1 }); // Port 1 FULLDUPLEX, not part of the extension
+    r.frame({ 0x10 });    // Negotiation frame without data
+    if (r.negotiations.size() != 5 || r.negotiations[0].type != 0x10 ||
+        r.negotiations[4].type != 0x14 || r.negotiations[2].payload != bytes({ 'n' }))
+        fail("negotiation types not matched on the whole type byte");
+    if (!r.parameters.empty() || !r.data_frames.empty())
+        fail("unrouted port 1 frame dispatched");
+
+    // Once port 1 is routed the same bytes are its data and parameter commands
+    recorder routed;
+    routed.dispatch.set_num_ports(2);
+    routed.frame({ 0x10, 'n' });
+    routed.frame({ 0x11, 20 });
+    if (!routed.negotiations.empty() || routed.data_frames.size() != 1 ||
+        routed.data_frames[0].port != 1 || routed.parameters.size() != 1 ||
+        routed.dispatch.params(1).tx_delay != 20)
+        fail("port 1 frames taken for negotiation");
+
+    // 0xFF is matched exactly: 0xF0 is port 15 data, 0xFF leaves KISS mode
+    recorder all;
+    all.dispatch.set_num_ports(KISS_MAX_PORTS);
+    all.frame({ 0xF0, 'z' });
+    if (!all.dispatch.kiss_mode() || all.data_frames.size() != 1 ||
+        all.data_frames[0].port != 15)
+        fail("port 15 data not routed");
+    all.frame({ 0xFF });
+    if (all.dispatch.kiss_mode() || all.data_frames.size() != 1)
+        fail("return command not recognised");
+}
+
+void check_signed_input() {
+    // The block input is a char stream; FEND (0xC0) and FESC (0xDB) are negative there
+    recorder r;
+    const std::vector<char> in = { '\xC0', '\x00', 'a',    '\xDB', '\xDC', 'b',
+                                   '\xDB', '\xDD', '\xC0', '\x01', '\x10', '\xC0' };
+    r.dispatch.feed(in.data(), 5);
+    r.dispatch.feed(in.data() + 5, in.size() - 5);
+    if (r.data_frames.size() != 1 ||
+        r.data_frames[0].payload != bytes({ 'a', 0xC0, 'b', 0xDB }))
+        fail("FEND/FESC not recognised in char input");
+    if (r.parameters.size() != 1 || r.dispatch.params(0).tx_delay != 0x10)
+        fail("frame after a FEND not dispatched");
+}
+
+} // namespace
+
+int main() {
+    check_port_routing();
+    check_port_parameters();
+    check_host_frames();
+    check_type_matching();
+    check_signed_input();
+    return 0;
+}
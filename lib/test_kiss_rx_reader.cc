@@ -0,0 +1,177 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * KISS RX reader: bytes written to the device fd must come out of read() unchanged and in
+ * order, every KISS frame must be counted and land in the latency histogram once it has been
+ * consumed, the frame tap must see each on-wire frame exactly and skip a run without FEND
+ * longer than any frame, the data callback must signal new bytes without wait_readable(),
+ * and a ring that is not drained must report overruns instead of blocking.
+ */
+
+#include "kiss_rx_reader.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using gr::packet_protocols::kiss_rx_reader;
+
+namespace {
+
+void fail(const char* what) {
+    std::fprintf(stderr, "%s\n", what);
+    std::exit(1);
+}
+
+void make_pipe(int fds[2]) {
+    if (pipe2(fds, O_NONBLOCK) != 0)
+        fail("pipe2 failed");
+}
+
+template <typename Pred>
+void wait_until(Pred pred) {
+    const auto start = std::chrono::steady_clock::now();
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() - start > std::chrono::seconds(5))
+            fail("timed out");
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void check_stream_and_frames() {
+    int fds[2];
+    make_pipe(fds);
+    std::vector<uint8_t> sent;
+    std::mutex tap_mutex;
+    std::vector<uint8_t> tapped;
+    {
+        kiss_rx_reader reader(fds[0], gr::packet_protocols::KISS_RX_RING_BYTES,
+                              [&](const uint8_t* frame, size_t length) {
+                                  std::lock_guard<std::mutex> lock(tap_mutex);
+                                  tapped.insert(tapped.end(), frame, frame + length);
+                              });
+        const int frames = 200;
+        for (int f = 0; f < frames; f++) {
+            std::vector<uint8_t> frame = { 0xC0, 0x00 };
+            for (int i = 0; i < 20 + f % 50; i++)
+                frame.push_back(static_cast<uint8_t>((f * 7 + i) & 0x7F));
+            frame.push_back(0xC0);
+            if (write(fds[1], frame.data(), frame.size()) != static_cast<ssize_t>(frame.size()))
+                fail("pipe write failed");
+            sent.insert(sent.end(), frame.begin(), frame.end());
+        }
+
+        std::vector<uint8_t> received;
+        uint8_t buffer[97];
+        wait_until([&] {
+            reader.wait_readable(10);
+            const size_t n = reader.read(buffer, sizeof(buffer));
+            received.insert(received.end(), buffer, buffer + n);
+            return received.size() >= sent.size();
+        });
+        if (received != sent)
+            fail("RX stream mismatch");
+        if (reader.frames_received() != static_cast<uint64_t>(frames))
+            fail("frame count mismatch");
+        const std::vector<uint64_t> hist = reader.latency_histogram();
+        if (std::accumulate(hist.begin(), hist.end(), uint64_t(0)) !=
+            static_cast<uint64_t>(frames))
+            fail("latency histogram does not cover every frame");
+        if (reader.overruns() != 0)
+            fail("unexpected overrun");
+        std::lock_guard<std::mutex> lock(tap_mutex);
+        if (tapped != sent)
+            fail("frame tap mismatch");
+    }
+    close(fds[0]);
+    close(fds[1]);
+}
+
+void check_tap_cap() {
+    int fds[2];
+    make_pipe(fds);
+    std::mutex tap_mutex;
+    std::vector<std::vector<uint8_t>> tapped;
+    {
+        kiss_rx_reader reader(fds[0], gr::packet_protocols::KISS_RX_RING_BYTES,
+                              [&](const uint8_t* frame, size_t length) {
+                                  std::lock_guard<std::mutex> lock(tap_mutex);
+                                  tapped.emplace_back(frame, frame + length);
+                              });
+        // A FEND, then noise with no FEND for longer than any frame, then a frame
+        std::vector<uint8_t> sent(1, 0xC0);
+        sent.insert(sent.end(), 3 * gr::packet_protocols::KISS_RX_MAX_TAP_FRAME, 0x55);
+        const std::vector<uint8_t> frame = { 0xC0, 0x00, 'o', 'k', 0xC0 };
+        sent.insert(sent.end(), frame.begin(), frame.end());
+        if (write(fds[1], sent.data(), sent.size()) != static_cast<ssize_t>(sent.size()))
+            fail("pipe write failed");
+
+        size_t received = 0;
+        uint8_t buffer[4096];
+        wait_until([&] {
+            reader.wait_readable(10);
+            received += reader.read(buffer, sizeof(buffer));
+            return received >= sent.size();
+        });
+        if (reader.frames_received() != 2)
+            fail("frame count mismatch after a long run");
+        std::lock_guard<std::mutex> lock(tap_mutex);
+        if (tapped.size() != 1 || tapped[0] != frame)
+            fail("overlong run tapped, or frame after it missed");
+    }
+    close(fds[0]);
+    close(fds[1]);
+}
+
+void check_data_callback() {
+    int fds[2];
+    make_pipe(fds);
+    std::atomic<int> notified{ 0 };
+    {
+        kiss_rx_reader reader(fds[0], gr::packet_protocols::KISS_RX_RING_BYTES,
+                              kiss_rx_reader::frame_fn(), [&] { notified++; });
+        const uint8_t frame[] = { 0xC0, 0x00, 'w', 0xC0 };
+        if (write(fds[1], frame, sizeof(frame)) != static_cast<ssize_t>(sizeof(frame)))
+            fail("pipe write failed");
+        wait_until([&] { return notified.load() > 0; });
+        if (reader.available() != sizeof(frame))
+            fail("data callback ran before the bytes were in the ring");
+    }
+    close(fds[0]);
+    close(fds[1]);
+}
+
+void check_overrun() {
+    int fds[2];
+    make_pipe(fds);
+    {
+        kiss_rx_reader reader(fds[0], 64);
+        std::vector<uint8_t> burst(1000, 0x55);
+        if (write(fds[1], burst.data(), burst.size()) != static_cast<ssize_t>(burst.size()))
+            fail("pipe write failed");
+        wait_until([&] { return reader.bytes_received() == burst.size(); });
+        if (reader.overruns() == 0 || reader.overrun_bytes() != burst.size() - 64)
+            fail("overrun not reported");
+        uint8_t buffer[128];
+        if (reader.read(buffer, sizeof(buffer)) != 64)
+            fail("ring should hold exactly its capacity");
+    }
+    close(fds[0]);
+    close(fds[1]);
+}
+
+} // namespace
+
+int main() {
+    check_stream_and_frames();
+    check_tap_cap();
+    check_data_callback();
+    check_overrun();
+    return 0;
+}
@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * Serial configuration on a pseudo-terminal: standard and non-standard (BOTHER) rates
+ * must read back as requested, the line must be fully raw (no CR/NL translation, so
+ * binary KISS data passes unchanged), RTS/CTS and VMIN/VTIME must be applied, and invalid
+ * settings must throw instead of falling back to a default rate. open_pty_pair() must give
+ * a virtual device whose slave path carries binary KISS data both ways once configured.
+ */
+
+#include "kiss_serial.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdexcept>
+#include <termios.h>
+#include <unistd.h>
+
+using namespace gr::packet_protocols;
+
+namespace {
+
+void fail(const char* what) {
+    std::fprintf(stderr, "%s\n", what);
+    std::exit(1);
+}
+
+void check_rates(int slave) {
+    for (int rate : { 1200, 9600, 115200, 230400, 921600, 3000000, 250000, 1843200 }) {
+        serial_config config;
+        config.baud_rate = rate;
+        if (configure_serial_port(slave, config).baud_rate != rate)
+            fail("rate did not read back as requested");
+    }
+}
+
+void check_raw_line(int master, int slave) {
+    serial_config config;
+    config.baud_rate = 115200;
+    config.hardware_flow_control = true;
+    config.vmin = 4;
+    config.vtime = 2;
+    configure_serial_port(slave, config);
+
+    struct termios tio;
+    tcgetattr(slave, &tio);
+    if (tio.c_iflag & (ICRNL | INLCR | IGNCR | ISTRIP | IXON))
+        fail("input translation left enabled");
+    if ((tio.c_oflag & OPOST) || (tio.c_lflag & (ICANON | ECHO | ISIG)))
+        fail("line not raw");
+    if ((tio.c_cflag & CSIZE) != CS8 || !(tio.c_cflag & CRTSCTS))
+        fail("8N1 / RTS/CTS not applied");
+    if (tio.c_cc[VMIN] != 4 || tio.c_cc[VTIME] != 2)
+        fail("VMIN/VTIME not applied");
+
+    config.vmin = 0;
+    config.vtime = 0;
+    configure_serial_port(slave, config);
+    const unsigned char sent[] = { 0xC0, 0x00, 0x0D, 0x0A, 0x0D, 0xC0 };
+    if (write(master, sent, sizeof(sent)) != static_cast<ssize_t>(sizeof(sent)))
+        fail("pty write failed");
+    unsigned char got[sizeof(sent)] = {};
+    size_t n = 0;
+    while (n < sizeof(sent)) {
+        struct pollfd pfd = { slave, POLLIN, 0 };
+        if (poll(&pfd, 1, 1000) <= 0)
+            fail("pty read timed out");
+        const ssize_t r = read(slave, got + n, sizeof(sent) - n);
+        if (r > 0)
+            n += static_cast<size_t>(r);
+    }
+    for (size_t i = 0; i < sizeof(sent); i++) {
+        if (got[i] != sent[i])
+            fail("CR/LF bytes altered on the way in");
+    }
+}
+
+void check_invalid(int slave) {
+    serial_config config;
+    for (int rate : { 0, -9600 }) {
+        config.baud_rate = rate;
+        try {
+            configure_serial_port(slave, config);
+            fail("invalid rate accepted");
+        } catch (const std::invalid_argument&) {
+        }
+    }
+    config.baud_rate = 9600;
+    config.vmin = 256;
+    try {
+        configure_serial_port(slave, config);
+        fail("VMIN out of range accepted");
+    } catch (const std::invalid_argument&) {
+    }
+    try {
+        configure_serial_port(-1, serial_config());
+        fail("bad descriptor accepted");
+    } catch (const std::runtime_error&) {
+    }
+}
+
+void check_pty_pair() {
+    const pty_pair pty = open_pty_pair();
+    if (pty.master < 0 || pty.slave < 0 || pty.slave_path.empty())
+        fail("pty pair incomplete");
+    serial_config config;
+    config.baud_rate = 250000;
+    if (configure_serial_port(pty.slave, config).baud_rate != 250000)
+        fail("pty slave rate did not read back");
+
+    // The host opens the slave path; the block keeps its own slave descriptor
+    const int host = open(pty.slave_path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (host < 0)
+        fail("cannot open the pty slave path");
+    const unsigned char frame[] = { 0xC0, 0x00, 0x0D, 0xDB, 0xDC, 0x0A, 0xC0 };
+    for (int direction = 0; direction < 2; direction++) {
+        const int from = direction == 0 ? pty.master : host;
+        const int to = direction == 0 ? host : pty.master;
+        if (write(from, frame, sizeof(frame)) != static_cast<ssize_t>(sizeof(frame)))
+            fail("pty write failed");
+        unsigned char got[sizeof(frame)] = {};
+        size_t n = 0;
+        while (n < sizeof(frame)) {
+            struct pollfd pfd = { to, POLLIN, 0 };
+            if (poll(&pfd, 1, 1000) <= 0)
+                fail("pty read timed out");
+            const ssize_t r = read(to, got + n, sizeof(frame) - n);
+            if (r > 0)
+                n += static_cast<size_t>(r);
+        }
+        for (size_t i = 0; i < sizeof(frame); i++) {
+            if (got[i] != frame[i])
+                fail("frame altered crossing the pty");
+        }
+    }
+    close(host);
+    close(pty.slave);
+    close(pty.master);
+}
+
+} // namespace
+
+int main() {
+    const int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+        fail("cannot allocate a pseudo-terminal");
+    const int slave = open(ptsname(master), O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (slave < 0)
+        fail("cannot open pty slave");
+
+    check_rates(slave);
+    check_raw_line(master, slave);
+    check_invalid(slave);
+    check_pty_pair();
+
+    close(slave);
+    close(master);
+    return 0;
+}
@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * KISS TCP server over loopback: every connected client must receive every broadcast frame
+ * byte-exact and in order, frames sent by clients (with FEND/FESC escapes) must reach the
+ * frame callback unescaped, and a client that stops reading must lose frames at its queue
+ * bound without stalling delivery to others.
+ */
+
+#include "kiss_tcp_server.h"
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using gr::packet_protocols::kiss_tcp_server;
+
+namespace {
+
+void fail(const char* what) {
+    std::fprintf(stderr, "%s\n", what);
+    std::exit(1);
+}
+
+int connect_client(int port, int rcvbuf = 0) {
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (rcvbuf > 0)
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0)
+        fail("connect failed");
+    return fd;
+}
+
+template <typename Pred>
+void wait_until(Pred pred) {
+    const auto start = std::chrono::steady_clock::now();
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() - start > std::chrono::seconds(5))
+            fail("timed out");
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+std::vector<uint8_t> read_exactly(int fd, size_t length) {
+    std::vector<uint8_t> data(length);
+    size_t got = 0;
+    while (got < length) {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        if (poll(&pfd, 1, 5000) <= 0)
+            fail("client read timed out");
+        const ssize_t n = recv(fd, data.data() + got, length - got, 0);
+        if (n <= 0)
+            fail("client connection closed");
+        got += static_cast<size_t>(n);
+    }
+    return data;
+}
+
+std::vector<uint8_t> kiss_frame(int seq, size_t length) {
+    std::vector<uint8_t> frame = { 0xC0, 0x00 };
+    for (size_t i = 0; i < length; i++)
+        frame.push_back(static_cast<uint8_t>((seq * 13 + i) & 0x7F));
+    frame.push_back(0xC0);
+    return frame;
+}
+
+void check_fan_out_and_client_tx() {
+    std::mutex mutex;
+    std::vector<std::vector<uint8_t>> received;
+    kiss_tcp_server server("127.0.0.1", 0, [&](const uint8_t* frame, size_t length) {
+        std::lock_guard<std::mutex> lock(mutex);
+        received.emplace_back(frame, frame + length);
+    });
+
+    const int clients = 4;
+    int fds[clients];
+    for (int i = 0; i < clients; i++)
+        fds[i] = connect_client(server.port());
+    wait_until([&] { return server.clients() == clients; });
+
+    std::vector<uint8_t> expected;
+    for (int f = 0; f < 100; f++) {
+        const std::vector<uint8_t> frame = kiss_frame(f, 40 + f);
+        server.broadcast(frame.data(), frame.size());
+        expected.insert(expected.end(), frame.begin(), frame.end());
+    }
+    for (int i = 0; i < clients; i++) {
+        if (read_exactly(fds[i], expected.size()) != expected)
+            fail("client stream mismatch");
+    }
+
+    // Client -> server: escaped FEND/FESC inside data, two frames in one write
+    const uint8_t tx[] = { 0xC0, 0x00, 0x01, 0xDB, 0xDC, 0x02, 0xDB, 0xDD, 0xC0,
+                           0xC0, 0x01, 0x32, 0xC0 };
+    if (send(fds[2], tx, sizeof(tx), 0) != static_cast<ssize_t>(sizeof(tx)))
+        fail("client send failed");
+    wait_until([&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return received.size() == 2;
+    });
+    if (received[0] != std::vector<uint8_t>{ 0x00, 0x01, 0xC0, 0x02, 0xDB } ||
+        received[1] != std::vector<uint8_t>{ 0x01, 0x32 })
+        fail("client frames not unescaped correctly");
+
+    close(fds[0]);
+    wait_until([&] { return server.clients() == clients - 1; });
+    for (int i = 1; i < clients; i++)
+        close(fds[i]);
+}
+
+void check_slow_client() {
+    kiss_tcp_server server("127.0.0.1", 0, [](const uint8_t*, size_t) {}, 8192);
+    const int slow = connect_client(server.port(), 4096);
+    wait_until([&] { return server.clients() == 1; });
+
+    const std::vector<uint8_t> big = kiss_frame(1, 1024);
+    for (int f = 0; f < 4000; f++)
+        server.broadcast(big.data(), big.size());
+    wait_until([&] { return server.frames_dropped() > 0; });
+
+    // The stalled client must not hold up a new one
+    const int fast = connect_client(server.port());
+    wait_until([&] { return server.clients() == 2; });
+    const std::vector<uint8_t> small = kiss_frame(7, 10);
+    server.broadcast(small.data(), small.size());
+    if (read_exactly(fast, small.size()) != small)
+        fail("fresh client did not receive frame behind stalled client");
+    close(fast);
+    close(slow);
+}
+
+} // namespace
+
+int main() {
+    check_fan_out_and_client_tx();
+    check_slow_client();
+    return 0;
+}
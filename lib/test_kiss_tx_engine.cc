@@ -0,0 +1,399 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * KISS TX engine: enqueue() must not block on TXDELAY, frames go out in order, a burst is sent
+ * under a single PTT keyup after TXDELAY and coalesced into one writev(), the frame and
+ * byte bounds drop excess frames, a device that stops accepting bytes delays frames
+ * without losing or reordering them, a write error drops the batch, on-air frames wait
+ * while carrier is detected unless full duplex, device frames go out while they wait, and
+ * destruction during a long TXDELAY returns promptly with PTT released. Priority classes:
+ * AX.25 frames are classified by their control field, higher classes are sent first, a
+ * full queue evicts lower classes before refusing, the drop policy applies within a
+ * class, and depth, drops and sojourn time are reported per class.
+ */
+
+#include "kiss_tx_engine.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <mutex>
+#include <string>
+#include <poll.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace gr::packet_protocols;
+using steady = std::chrono::steady_clock;
+
+namespace {
+
+void fail(const char* what) {
+    std::fprintf(stderr, "%s\n", what);
+    std::exit(1);
+}
+
+// Stands in for the serial device: the engine writes a non-blocking pipe, a reader thread
+// collects what arrives (unless paused, so the pipe can be left to fill up)
+struct recorder {
+    int fds[2];
+    std::mutex mutex;
+    std::vector<uint8_t> bytes;
+    std::vector<bool> ptt;
+    steady::time_point keyed_at, first_byte_at;
+    std::atomic<bool> paused{ false };
+    std::atomic<bool> stop{ false };
+    std::thread reader;
+
+    explicit recorder(int pipe_size = 0) {
+        if (pipe2(fds, O_NONBLOCK) != 0)
+            fail("pipe2 failed");
+        if (pipe_size > 0)
+            fcntl(fds[1], F_SETPIPE_SZ, pipe_size);
+        reader = std::thread([this] {
+            uint8_t buffer[1024];
+            while (!stop.load()) {
+                struct pollfd pfd = { fds[0], POLLIN, 0 };
+                if (paused.load() || poll(&pfd, 1, 5) <= 0) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    continue;
+                }
+                const ssize_t n = read(fds[0], buffer, sizeof(buffer));
+                if (n <= 0)
+                    continue;
+                std::lock_guard<std::mutex> lock(mutex);
+                if (bytes.empty())
+                    first_byte_at = steady::now();
+                bytes.insert(bytes.end(), buffer, buffer + n);
+            }
+        });
+    }
+    ~recorder() {
+        stop.store(true);
+        reader.join();
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    int device() const { return fds[1]; }
+    size_t received() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return bytes.size();
+    }
+    kiss_tx_engine::ptt_fn keyer() {
+        return [this](bool state) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (state)
+                keyed_at = steady::now();
+            ptt.push_back(state);
+        };
+    }
+};
+
+double ms_since(steady::time_point start) {
+    return std::chrono::duration<double, std::milli>(steady::now() - start).count();
+}
+
+template <typename Pred>
+void wait_until(Pred pred) {
+    const auto start = steady::now();
+    while (!pred()) {
+        if (ms_since(start) > 5000)
+            fail("timed out waiting for TX thread");
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void check_unkeyed_order() {
+    recorder rec;
+    kiss_tx_engine engine(rec.device(), rec.keyer());
+    std::vector<uint8_t> expected;
+    for (uint8_t i = 0; i < 10; i++) {
+        const std::vector<uint8_t> frame = { i, static_cast<uint8_t>(i + 1) };
+        expected.insert(expected.end(), frame.begin(), frame.end());
+        engine.enqueue(std::vector<uint8_t>(frame), true);
+    }
+    wait_until([&] { return engine.frames_sent() == 10 && rec.received() == 20; });
+    std::lock_guard<std::mutex> lock(rec.mutex);
+    if (rec.bytes != expected)
+        fail("frames out of order");
+    if (!rec.ptt.empty())
+        fail("PTT keyed while PTT control disabled");
+    if (engine.bytes_in_flight() != 0)
+        fail("bytes in flight after everything was written");
+}
+
+void check_batched_keyup() {
+    recorder rec;
+    kiss_tx_engine engine(rec.device(), rec.keyer());
+    engine.set_ptt_enabled(true);
+    engine.set_tx_delay(5); // 50 ms
+    engine.set_tx_tail(2);  // 20 ms
+
+    const auto start = steady::now();
+    for (uint8_t i = 0; i < 8; i++)
+        engine.enqueue(std::vector<uint8_t>(100, i), true);
+    if (ms_since(start) > 20)
+        fail("enqueue blocked");
+
+    wait_until([&] { return engine.frames_sent() == 8 && rec.received() == 800; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(60)); // TXTAIL + unkey
+    std::lock_guard<std::mutex> lock(rec.mutex);
+    if (engine.keyups() != 1 || rec.ptt != std::vector<bool>{ true, false })
+        fail("burst not sent under a single keyup");
+    if (engine.write_calls() != 1)
+        fail("burst queued during TXDELAY not coalesced into one writev");
+    if (std::chrono::duration<double, std::milli>(rec.first_byte_at - rec.keyed_at).count() < 45)
+        fail("TXDELAY not applied before first frame");
+}
+
+void check_bounds() {
+    recorder rec;
+    {
+        kiss_tx_engine engine(rec.device(), rec.keyer(), 2);
+        engine.set_ptt_enabled(true);
+        engine.set_tx_delay(20); // hold the thread in TXDELAY while the queue fills
+        int accepted = 0;
+        for (int i = 0; i < 10; i++)
+            accepted += engine.enqueue(std::vector<uint8_t>(4, 0), true) ? 1 : 0;
+        if (accepted > 3 || engine.frames_dropped() != static_cast<uint64_t>(10 - accepted))
+            fail("queue bound not enforced");
+    }
+    {
+        kiss_tx_engine engine(rec.device(), rec.keyer(), 64, 1000);
+        engine.set_ptt_enabled(true);
+        engine.set_tx_delay(20);
+        int accepted = 0;
+        for (int i = 0; i < 10; i++)
+            accepted += engine.enqueue(std::vector<uint8_t>(300, 0), true) ? 1 : 0;
+        if (accepted != 3 || engine.bytes_in_flight() != 900)
+            fail("bytes-in-flight bound not enforced");
+    }
+}
+
+void check_device_backpressure() {
+    recorder rec(4096);
+    rec.paused.store(true);
+    kiss_tx_engine engine(rec.device(), rec.keyer());
+
+    std::vector<uint8_t> expected;
+    for (int f = 0; f < 40; f++) {
+        std::vector<uint8_t> frame(1000);
+        for (size_t i = 0; i < frame.size(); i++)
+            frame[i] = static_cast<uint8_t>(f * 31 + i);
+        expected.insert(expected.end(), frame.begin(), frame.end());
+        if (!engine.enqueue(std::move(frame), true))
+            fail("frame rejected below the bounds");
+    }
+    // The pipe holds a fraction of the burst: the rest must wait, not be dropped
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    if (engine.frames_sent() >= 40 || engine.bytes_in_flight() == 0)
+        fail("full device did not hold frames back");
+    if (engine.frames_dropped() != 0 || engine.write_errors() != 0)
+        fail("frames lost while device was full");
+
+    rec.paused.store(false);
+    wait_until(
+        [&] { return engine.frames_sent() == 40 && rec.received() == expected.size(); });
+    std::lock_guard<std::mutex> lock(rec.mutex);
+    if (rec.bytes != expected)
+        fail("stream corrupted across partial writes");
+    if (engine.bytes_in_flight() != 0)
+        fail("bytes in flight after device drained");
+}
+
+void check_write_error() {
+    int fds[2];
+    if (pipe2(fds, O_NONBLOCK) != 0)
+        fail("pipe2 failed");
+    close(fds[0]); // writes now fail with EPIPE
+    {
+        kiss_tx_engine engine(fds[1], [](bool) {});
+        for (int i = 0; i < 3; i++)
+            engine.enqueue(std::vector<uint8_t>(10, 0), true);
+        wait_until([&] { return engine.frames_dropped() == 3; });
+        if (engine.write_errors() == 0 || engine.bytes_in_flight() != 0)
+            fail("write error not accounted");
+    }
+    close(fds[1]);
+}
+
+void check_channel_access() {
+    recorder rec;
+    kiss_tx_engine engine(rec.device(), rec.keyer());
+    engine.set_dcd(true);
+    engine.enqueue(std::vector<uint8_t>(4, 1), true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    if (engine.frames_sent() != 0)
+        fail("frame sent while carrier detected");
+    engine.set_dcd(false);
+    wait_until([&] { return engine.frames_sent() == 1; });
+
+    // Full duplex transmits regardless of carrier
+    engine.set_dcd(true);
+    engine.set_full_duplex(true);
+    engine.enqueue(std::vector<uint8_t>(4, 2), true);
+    wait_until([&] { return engine.frames_sent() == 2; });
+    if (engine.busy_deferrals() != 1)
+        fail("busy deferral not counted");
+}
+
+void check_device_frames_while_deferred() {
+    // An on-air frame waiting for the channel must not hold back device frames
+    recorder rec;
+    kiss_tx_engine engine(rec.device(), rec.keyer(), KISS_TX_QUEUE_FRAMES,
+                          KISS_TX_MAX_IN_FLIGHT, kiss_csma::clock_fn(),
+                          [] { return uint8_t(255); });
+    engine.set_dcd(true);
+    engine.enqueue(std::vector<uint8_t>(4, 1), true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    engine.enqueue(std::vector<uint8_t>(3, 2), false);
+    wait_until([&] { return rec.received() == 3; });
+    if (engine.frames_sent() != 1)
+        fail("device frame not sent while carrier detected");
+
+    // The same while a p-persistence slot is waited out (P = 0 never wins the draw)
+    engine.set_persistence(0);
+    engine.set_slot_time(100);
+    engine.set_dcd(false);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const steady::time_point queued = steady::now();
+    engine.enqueue(std::vector<uint8_t>(3, 3), false);
+    wait_until([&] { return rec.received() == 6; });
+    if (ms_since(queued) > 500 || engine.frames_sent() != 2)
+        fail("device frame held back by the slot time");
+}
+
+std::vector<uint8_t> ax25_frame(uint8_t control, size_t info) {
+    std::vector<uint8_t> frame(14, 0x40);
+    frame[13] = 0x61; // end of address field
+    frame.push_back(control);
+    if (!(control & 0x01) || (control & 0xEF) == 0x03) {
+        frame.push_back(0xF0);
+        frame.insert(frame.end(), info, 'x');
+    }
+    return frame;
+}
+
+void check_classification() {
+    const struct {
+        uint8_t control;
+        size_t info;
+        kiss_tx_priority expected;
+    } cases[] = {
+        { 0x01, 0, KISS_TX_CONTROL },        // RR
+        { 0x09, 0, KISS_TX_CONTROL },        // REJ
+        { 0x3F, 0, KISS_TX_CONTROL },        // SABM, poll
+        { 0x73, 0, KISS_TX_CONTROL },        // UA, final
+        { 0x03, 20, KISS_TX_INTERACTIVE },   // UI
+        { 0x10, 64, KISS_TX_INTERACTIVE },   // I, poll
+        { 0x00, 65, KISS_TX_BULK },          // I
+        { 0x13, 200, KISS_TX_BULK },         // UI, poll
+    };
+    for (const auto& c : cases) {
+        const std::vector<uint8_t> frame = ax25_frame(c.control, c.info);
+        if (ax25_tx_priority(frame.data(), frame.size()) != c.expected)
+            fail("AX.25 frame misclassified");
+    }
+    const std::vector<uint8_t> unterminated(30, 0x40);
+    if (ax25_tx_priority(unterminated.data(), unterminated.size()) != KISS_TX_BULK)
+        fail("unterminated address field not bulk");
+}
+
+void check_priority_order() {
+    recorder rec;
+    kiss_tx_engine engine(rec.device(), rec.keyer());
+    engine.set_ptt_enabled(true);
+    engine.set_tx_delay(10); // everything below is queued while TXDELAY runs
+    engine.enqueue(std::vector<uint8_t>(2, 'b'), true, KISS_TX_BULK);
+    engine.enqueue(std::vector<uint8_t>(2, 'B'), true, KISS_TX_BULK);
+    engine.enqueue(std::vector<uint8_t>(2, 'i'), true, KISS_TX_INTERACTIVE);
+    engine.enqueue(std::vector<uint8_t>(2, 'c'), true, KISS_TX_CONTROL);
+
+    const auto stats = engine.class_stats();
+    if (stats[KISS_TX_BULK].frames != 2 || stats[KISS_TX_BULK].bytes != 4 ||
+        stats[KISS_TX_CONTROL].frames != 1)
+        fail("queue depth not reported per class");
+
+    wait_until([&] { return rec.received() == 8; });
+    {
+        std::lock_guard<std::mutex> lock(rec.mutex);
+        if (std::string(rec.bytes.begin(), rec.bytes.end()) != "cciibbBB")
+            fail("frames not sent highest class first");
+    }
+    const auto sent = engine.class_stats();
+    if (sent[KISS_TX_BULK].sent != 2 || sent[KISS_TX_BULK].frames != 0)
+        fail("sent frames not accounted");
+    if (sent[KISS_TX_CONTROL].sojourn_max_ns < 90 * 1000000LL)
+        fail("sojourn time does not include TXDELAY");
+}
+
+void check_drop_policy() {
+    recorder rec;
+    for (auto policy : { KISS_TX_DROP_NEWEST, KISS_TX_DROP_OLDEST }) {
+        kiss_tx_engine engine(rec.device(), rec.keyer(), 3);
+        engine.set_drop_policy(policy);
+        engine.set_ptt_enabled(true);
+        engine.set_tx_delay(20);
+        for (uint8_t i = 1; i <= 3; i++)
+            engine.enqueue(std::vector<uint8_t>(1, i), true, KISS_TX_BULK);
+        const bool accepted =
+            engine.enqueue(std::vector<uint8_t>(1, 4), true, KISS_TX_BULK);
+        if (accepted != (policy == KISS_TX_DROP_OLDEST))
+            fail("drop policy not applied within a class");
+
+        // A control frame always displaces bulk rather than being refused
+        if (!engine.enqueue(std::vector<uint8_t>(1, 0), true, KISS_TX_CONTROL))
+            fail("control frame refused while bulk was queued");
+        const auto stats = engine.class_stats();
+        if (stats[KISS_TX_BULK].dropped != 2 || stats[KISS_TX_BULK].frames != 2 ||
+            stats[KISS_TX_CONTROL].frames != 1 || engine.frames_dropped() != 2)
+            fail("evictions not accounted");
+    }
+
+    // Nothing lower to evict: the higher class keeps its frames
+    kiss_tx_engine engine(rec.device(), rec.keyer(), 1);
+    engine.set_ptt_enabled(true);
+    engine.set_tx_delay(20);
+    engine.enqueue(std::vector<uint8_t>(1, 0), true, KISS_TX_CONTROL);
+    if (engine.enqueue(std::vector<uint8_t>(1, 1), true, KISS_TX_BULK))
+        fail("bulk frame displaced a control frame");
+}
+
+void check_prompt_shutdown() {
+    recorder rec;
+    steady::time_point start;
+    {
+        kiss_tx_engine engine(rec.device(), rec.keyer());
+        engine.set_ptt_enabled(true);
+        engine.set_tx_delay(255); // 2.55 s
+        engine.enqueue(std::vector<uint8_t>(4, 0), true);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        start = steady::now();
+    }
+    if (ms_since(start) > 500)
+        fail("destructor waited out TXDELAY");
+    if (rec.ptt.empty() || rec.ptt.back())
+        fail("PTT left keyed at shutdown");
+}
+
+} // namespace
+
+int main() {
+    std::signal(SIGPIPE, SIG_IGN);
+    check_unkeyed_order();
+    check_batched_keyup();
+    check_bounds();
+    check_device_backpressure();
+    check_write_error();
+    check_channel_access();
+    check_device_frames_while_deferred();
+    check_classification();
+    check_priority_order();
+    check_drop_policy();
+    check_prompt_shutdown();
+    return 0;
+}
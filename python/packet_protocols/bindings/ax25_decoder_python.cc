@@ -41,5 +41,20 @@ void bind_ax25_decoder(py::module& m)
         .def(py::init(&ax25_decoder::make), D(ax25_decoder, make))
 
 
+        .def("set_dcd_flags",
+             &ax25_decoder::set_dcd_flags,
+             py::arg("flags"),
+             D(ax25_decoder, set_dcd_flags))
+
+
+        .def("set_dcd_hold_off",
+             &ax25_decoder::set_dcd_hold_off,
+             py::arg("bits"),
+             D(ax25_decoder, set_dcd_hold_off))
+
+
+        .def("dcd", &ax25_decoder::dcd, D(ax25_decoder, dcd))
+
+
         ;
 }
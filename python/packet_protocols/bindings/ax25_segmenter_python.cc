@@ -0,0 +1,58 @@
+/*
+ * Copyright 2025 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+/***********************************************************************************/
+/* This file is automatically generated using bindtool and can be manually edited  */
+/* The following lines can be configured to regenerate this file during cmake      */
+/* If manual edits are made, the following tags should be modified accordingly.    */
+/* BINDTOOL_GEN_AUTOMATIC(0)                                                       */
+/* BINDTOOL_USE_PYGCCXML(0)                                                        */
+/* BINDTOOL_HEADER_FILE(ax25_segmenter.h)                                          */
+/* BINDTOOL_HEADER_FILE_HASH(f212d3189c6f6ca0640fd6669a1ba011)                     */
+/***********************************************************************************/
+
+#include <pybind11/complex.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+namespace py = pybind11;
+
+#include <gnuradio/packet_protocols/ax25_segmenter.h>
+// pydoc.h is automatically generated in the build directory
+#include <ax25_segmenter_pydoc.h>
+
+void bind_ax25_segmenter(py::module& m)
+{
+
+    using ax25_segmenter = ::gr::packet_protocols::ax25_segmenter;
+
+
+    py::class_<ax25_segmenter,
+               gr::block,
+               gr::basic_block,
+               std::shared_ptr<ax25_segmenter>>(m, "ax25_segmenter", D(ax25_segmenter))
+
+        .def(py::init(&ax25_segmenter::make),
+             py::arg("max_info") = 256,
+             py::arg("max_messages") = 8,
+             py::arg("timeout_ms") = 60000,
+             D(ax25_segmenter, make))
+
+
+        .def("messages_reassembled",
+             &ax25_segmenter::messages_reassembled,
+             D(ax25_segmenter, messages_reassembled))
+
+
+        .def("messages_dropped",
+             &ax25_segmenter::messages_dropped,
+             D(ax25_segmenter, messages_dropped))
+
+        ;
+}
@@ -22,3 +22,12 @@ static const char* __doc_gr_packet_protocols_ax25_decoder_ax25_decoder_0 = R"doc
 
 
 static const char* __doc_gr_packet_protocols_ax25_decoder_make = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_ax25_decoder_set_dcd_flags = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_ax25_decoder_set_dcd_hold_off = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_ax25_decoder_dcd = R"doc()doc";
@@ -0,0 +1,35 @@
+/*
+ * Copyright 2025 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+#include "pydoc_macros.h"
+#define D(...) DOC(gr, packet_protocols, __VA_ARGS__)
+/*
+  This file contains placeholders for docstrings for the Python bindings.
+  Do not edit! These were automatically extracted during the binding process
+  and will be overwritten during the build process
+ */
+
+
+static const char* __doc_gr_packet_protocols_ax25_segmenter = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_ax25_segmenter_ax25_segmenter_0 = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_ax25_segmenter_ax25_segmenter_1 = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_ax25_segmenter_make = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_ax25_segmenter_messages_reassembled =
+    R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_ax25_segmenter_messages_dropped =
+    R"doc()doc";
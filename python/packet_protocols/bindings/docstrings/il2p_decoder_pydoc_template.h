@@ -22,3 +22,12 @@ static const char* __doc_gr_packet_protocols_il2p_decoder_il2p_decoder_0 = R"doc
 
 
 static const char* __doc_gr_packet_protocols_il2p_decoder_make = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_il2p_decoder_set_check_crc = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_il2p_decoder_set_dcd_hold_off = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_il2p_decoder_dcd = R"doc()doc";
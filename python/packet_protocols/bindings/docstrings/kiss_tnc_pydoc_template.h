@@ -42,6 +42,9 @@ static const char* __doc_gr_packet_protocols_kiss_tnc_set_tx_tail = R"doc()doc";
 static const char* __doc_gr_packet_protocols_kiss_tnc_set_full_duplex = R"doc()doc";
 
 
+static const char* __doc_gr_packet_protocols_kiss_tnc_set_dcd = R"doc()doc";
+
+
 static const char* __doc_gr_packet_protocols_kiss_tnc_set_ptt = R"doc()doc";
 
 
@@ -52,3 +55,54 @@ static const char* __doc_gr_packet_protocols_kiss_tnc_set_ptt_enabled = R"doc()d
 
 
 static const char* __doc_gr_packet_protocols_kiss_tnc_set_ptt_use_dtr = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_kiss_tnc_actual_baud_rate = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_kiss_tnc_set_low_latency = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_kiss_tnc_set_read_thresholds = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_kiss_tnc_set_num_ports = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_kiss_tnc_num_ports = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_kiss_tnc_rx_frames = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_kiss_tnc_rx_overruns = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_kiss_tnc_rx_overrun_bytes = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_kiss_tnc_rx_latency_histogram = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_kiss_tnc_tx_bytes_in_flight = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_kiss_tnc_tx_frames_dropped = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_kiss_tnc_pty_path = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_kiss_tnc_ptt_key_count = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_kiss_tnc_ptt_unkey_count = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_kiss_tnc_set_tx_queue_limits = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_kiss_tnc_set_tx_drop_oldest = R"doc()doc";
+
+
+static const char* __doc_gr_packet_protocols_kiss_tnc_set_tx_stats_interval = R"doc()doc";
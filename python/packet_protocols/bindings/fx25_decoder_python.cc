@@ -41,5 +41,20 @@ void bind_fx25_decoder(py::module& m)
         .def(py::init(&fx25_decoder::make), D(fx25_decoder, make))
 
 
+        .def("set_dcd_flags",
+             &fx25_decoder::set_dcd_flags,
+             py::arg("flags"),
+             D(fx25_decoder, set_dcd_flags))
+
+
+        .def("set_dcd_hold_off",
+             &fx25_decoder::set_dcd_hold_off,
+             py::arg("bits"),
+             D(fx25_decoder, set_dcd_hold_off))
+
+
+        .def("dcd", &fx25_decoder::dcd, D(fx25_decoder, dcd))
+
+
         ;
 }
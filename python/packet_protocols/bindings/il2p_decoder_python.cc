@@ -38,7 +38,24 @@ void bind_il2p_decoder(py::module& m)
                gr::basic_block,
                std::shared_ptr<il2p_decoder>>(m, "il2p_decoder", D(il2p_decoder))
 
-        .def(py::init(&il2p_decoder::make), D(il2p_decoder, make))
+        .def(py::init(&il2p_decoder::make),
+             py::arg("check_crc") = true,
+             D(il2p_decoder, make))
+
+
+        .def("set_check_crc",
+             &il2p_decoder::set_check_crc,
+             py::arg("check_crc"),
+             D(il2p_decoder, set_check_crc))
+
+
+        .def("set_dcd_hold_off",
+             &il2p_decoder::set_dcd_hold_off,
+             py::arg("bits"),
+             D(il2p_decoder, set_dcd_hold_off))
+
+
+        .def("dcd", &il2p_decoder::dcd, D(il2p_decoder, dcd))
 
 
         ;
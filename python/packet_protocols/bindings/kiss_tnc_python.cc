@@ -14,7 +14,7 @@
 /* BINDTOOL_GEN_AUTOMATIC(0)                                                       */
 /* BINDTOOL_USE_PYGCCXML(0)                                                        */
 /* BINDTOOL_HEADER_FILE(kiss_tnc.h)                                        */
-/* BINDTOOL_HEADER_FILE_HASH(28b3f3b2d5cee9e3353a4cd8e695af0f)                     */
+/* BINDTOOL_HEADER_FILE_HASH(d3b6d8fb538ccae432ba9ca420027af4)                     */
 /***********************************************************************************/
 
 #include <pybind11/complex.h>
@@ -34,7 +34,6 @@ void bind_kiss_tnc(py::module& m)
 
 
     py::class_<kiss_tnc,
-               gr::sync_block,
                gr::block,
                gr::basic_block,
                std::shared_ptr<kiss_tnc>>(m, "kiss_tnc", D(kiss_tnc))
@@ -43,6 +42,8 @@ void bind_kiss_tnc(py::module& m)
              py::arg("device"),
              py::arg("baud_rate") = 9600,
              py::arg("hardware_flow_control") = false,
+             py::arg("tcp_port") = 0,
+             py::arg("tcp_bind_address") = "127.0.0.1",
              D(kiss_tnc, make))
 
 
@@ -76,6 +77,12 @@ void bind_kiss_tnc(py::module& m)
              D(kiss_tnc, set_full_duplex))
 
 
+        .def("set_dcd",
+             &kiss_tnc::set_dcd,
+             py::arg("busy"),
+             D(kiss_tnc, set_dcd))
+
+
         .def("set_ptt",
              &kiss_tnc::set_ptt,
              py::arg("ptt_state"),
@@ -98,5 +105,98 @@ void bind_kiss_tnc(py::module& m)
              py::arg("use_dtr"),
              D(kiss_tnc, set_ptt_use_dtr))
 
+
+        .def("actual_baud_rate",
+             &kiss_tnc::actual_baud_rate,
+             D(kiss_tnc, actual_baud_rate))
+
+
+        .def("set_low_latency",
+             &kiss_tnc::set_low_latency,
+             py::arg("low_latency"),
+             D(kiss_tnc, set_low_latency))
+
+
+        .def("set_read_thresholds",
+             &kiss_tnc::set_read_thresholds,
+             py::arg("vmin"),
+             py::arg("vtime"),
+             D(kiss_tnc, set_read_thresholds))
+
+
+        .def("set_num_ports",
+             &kiss_tnc::set_num_ports,
+             py::arg("num_ports"),
+             D(kiss_tnc, set_num_ports))
+
+
+        .def("num_ports",
+             &kiss_tnc::num_ports,
+             D(kiss_tnc, num_ports))
+
+
+        .def("rx_frames",
+             &kiss_tnc::rx_frames,
+             D(kiss_tnc, rx_frames))
+
+
+        .def("rx_overruns",
+             &kiss_tnc::rx_overruns,
+             D(kiss_tnc, rx_overruns))
+
+
+        .def("rx_overrun_bytes",
+             &kiss_tnc::rx_overrun_bytes,
+             D(kiss_tnc, rx_overrun_bytes))
+
+
+        .def("rx_latency_histogram",
+             &kiss_tnc::rx_latency_histogram,
+             D(kiss_tnc, rx_latency_histogram))
+
+
+        .def("tx_bytes_in_flight",
+             &kiss_tnc::tx_bytes_in_flight,
+             D(kiss_tnc, tx_bytes_in_flight))
+
+
+        .def("tx_frames_dropped",
+             &kiss_tnc::tx_frames_dropped,
+             D(kiss_tnc, tx_frames_dropped))
+
+
+        .def("pty_path",
+             &kiss_tnc::pty_path,
+             D(kiss_tnc, pty_path))
+
+
+        .def("ptt_key_count",
+             &kiss_tnc::ptt_key_count,
+             D(kiss_tnc, ptt_key_count))
+
+
+        .def("ptt_unkey_count",
+             &kiss_tnc::ptt_unkey_count,
+             D(kiss_tnc, ptt_unkey_count))
+
+
+        .def("set_tx_queue_limits",
+             &kiss_tnc::set_tx_queue_limits,
+             py::arg("max_frames"),
+             py::arg("max_bytes"),
+             D(kiss_tnc, set_tx_queue_limits))
+
+
+        .def("set_tx_drop_oldest",
+             &kiss_tnc::set_tx_drop_oldest,
+             py::arg("drop_oldest"),
+             D(kiss_tnc, set_tx_drop_oldest))
+
+
+        .def("set_tx_stats_interval",
+             &kiss_tnc::set_tx_stats_interval,
+             py::arg("interval_ms"),
+             D(kiss_tnc, set_tx_stats_interval))
+
         ;
 }
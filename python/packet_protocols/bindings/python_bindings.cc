@@ -31,6 +31,7 @@ namespace py = pybind11;
     void bind_link_quality_monitor(py::module& m);
     void bind_adaptive_rate_control(py::module& m);
     void bind_modulation_negotiation(py::module& m);
+    void bind_ax25_segmenter(py::module& m);
 // ) END BINDING_FUNCTION_PROTOTYPES
 
 
@@ -69,5 +70,6 @@ PYBIND11_MODULE(packet_protocols_python, m)
     bind_link_quality_monitor(m);
     bind_adaptive_rate_control(m);
     bind_modulation_negotiation(m);
+    bind_ax25_segmenter(m);
     // ) END BINDING_FUNCTION_CALLS
 }
\ No newline at end of file
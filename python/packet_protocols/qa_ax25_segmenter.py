@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+# Copyright 2025 gr-packet-protocols.
+#
+# SPDX-License-Identifier: GPL-3.0-or-later
+#
+
+import time
+
+from qa_gr_test_env import ensure_build_packet_protocols_first
+
+ensure_build_packet_protocols_first()
+
+from gnuradio import gr, gr_unittest
+from gnuradio import blocks
+import pmt
+
+try:
+    from gnuradio.packet_protocols import ax25_segmenter
+    _has_bindings = True
+except ImportError:
+    _has_bindings = False
+    ax25_segmenter = None
+
+
+def pdu(payload, **meta):
+    d = pmt.make_dict()
+    for key, value in meta.items():
+        d = pmt.dict_add(d, pmt.intern(key), value)
+    return pmt.cons(d, pmt.init_u8vector(len(payload), list(payload)))
+
+
+class qa_ax25_segmenter(gr_unittest.TestCase):
+
+    def setUp(self):
+        self.tb = gr.top_block()
+
+    def tearDown(self):
+        self.tb = None
+
+    def run_messages(self, block, port, messages, out_port, expected):
+        """Post messages to a block and collect what leaves out_port"""
+        debug = blocks.message_debug()
+        self.tb.msg_connect((block, out_port), (debug, "store"))
+        self.tb.start()
+        for msg in messages:
+            block._post(pmt.intern(port), msg)
+        deadline = time.monotonic() + 5
+        while debug.num_messages() < expected and time.monotonic() < deadline:
+            time.sleep(0.01)
+        time.sleep(0.05)
+        self.tb.stop()
+        self.tb.wait()
+        return [debug.get_message(i) for i in range(debug.num_messages())]
+
+    def test_instance(self):
+        """Test creating an instance"""
+        if not _has_bindings:
+            self.skipTest("ax25_segmenter bindings not available")
+        instance = ax25_segmenter(max_info=256, max_messages=8, timeout_ms=60000)
+        self.assertIsNotNone(instance)
+        self.assertEqual(instance.messages_reassembled(), 0)
+        self.assertEqual(instance.messages_dropped(), 0)
+
+    def test_segment(self):
+        """A PDU longer than N1 is split into full segments with PID 0x08"""
+        if not _has_bindings:
+            self.skipTest("ax25_segmenter bindings not available")
+        segmenter = ax25_segmenter(max_info=256)
+        payload = bytes(i % 251 for i in range(1000))
+        out = self.run_messages(segmenter, "pdus_in", [pdu(payload), pdu(b"short")],
+                                "segments_out", 5)
+
+        # 254 + 255 + 255 + 236 data bytes, then the short PDU unchanged
+        self.assertEqual(len(out), 5)
+        fields = [bytes(pmt.u8vector_elements(pmt.cdr(m))) for m in out]
+        self.assertEqual([len(f) for f in fields[:4]], [256, 256, 256, 237])
+        self.assertEqual(fields[0][:2], bytes([0x83, 0xF0]))
+        self.assertEqual([f[0] for f in fields[1:4]], [2, 1, 0])
+        for m in out[:4]:
+            self.assertEqual(pmt.to_long(pmt.dict_ref(pmt.car(m), pmt.intern("pid"),
+                                                      pmt.PMT_NIL)), 0x08)
+        self.assertEqual(fields[0][2:] + b"".join(f[1:] for f in fields[1:4]), payload)
+        self.assertEqual(fields[4], b"short")
+
+    def test_reassemble(self):
+        """Segments from two sources are reassembled independently"""
+        if not _has_bindings:
+            self.skipTest("ax25_segmenter bindings not available")
+        reassembler = ax25_segmenter(max_info=64)
+        a = bytes(range(100))
+        b = bytes(reversed(range(150)))
+        segment = pmt.from_long(0x08)
+        a_src = pmt.intern("N0CALL-1")
+        b_src = pmt.intern("N0CALL-2")
+        messages = [
+            pdu(bytes([0x81, 0xCC]) + a[:62], pid=segment, src=a_src),
+            pdu(bytes([0x82, 0xF0]) + b[:62], pid=segment, src=b_src),
+            pdu(bytes([0x00]) + a[62:], pid=segment, src=a_src),
+            pdu(bytes([0x01]) + b[62:125], pid=segment, src=b_src),
+            pdu(bytes([0x00]) + b[125:], pid=segment, src=b_src),
+        ]
+        out = self.run_messages(reassembler, "segments_in", messages, "pdus_out", 2)
+
+        self.assertEqual(len(out), 2)
+        self.assertEqual(bytes(pmt.u8vector_elements(pmt.cdr(out[0]))), a)
+        self.assertEqual(bytes(pmt.u8vector_elements(pmt.cdr(out[1]))), b)
+        self.assertEqual(pmt.to_long(pmt.dict_ref(pmt.car(out[0]), pmt.intern("pid"),
+                                                  pmt.PMT_NIL)), 0xCC)
+        self.assertEqual(reassembler.messages_reassembled(), 2)
+        self.assertEqual(reassembler.messages_dropped(), 0)
+
+    def test_out_of_order(self):
+        """A missing segment drops the message"""
+        if not _has_bindings:
+            self.skipTest("ax25_segmenter bindings not available")
+        reassembler = ax25_segmenter(max_info=64)
+        segment = pmt.from_long(0x08)
+        messages = [
+            pdu(bytes([0x82, 0xF0]) + bytes(62), pid=segment),
+            pdu(bytes([0x00, 1, 2, 3]), pid=segment),
+            pdu(b"plain", pid=pmt.from_long(0xF0)),
+        ]
+        out = self.run_messages(reassembler, "segments_in", messages, "pdus_out", 1)
+
+        self.assertEqual(len(out), 1)
+        self.assertEqual(bytes(pmt.u8vector_elements(pmt.cdr(out[0]))), b"plain")
+        self.assertEqual(reassembler.messages_reassembled(), 0)
+        self.assertEqual(reassembler.messages_dropped(), 1)
+
+
+if __name__ == '__main__':
+    gr_unittest.run(qa_ax25_segmenter)
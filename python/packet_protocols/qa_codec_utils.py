@@ -12,6 +12,29 @@ def ax25_ui_payload(pdu: bytes) -> bytes:
     return pdu[16:-2]
 
 
+def ax25_address(callsign: str, ssid: int, c_bit: bool, last: bool) -> bytes:
+    """One shifted AX.25 address field."""
+    field = bytes(ord(c) << 1 for c in callsign.ljust(6))
+    return field + bytes([(0x80 if c_bit else 0) | 0x60 | (ssid << 1) | (1 if last else 0)])
+
+
+def ax25_ui_frame(info: bytes, dest: str = "N0CALL", src: str = "N1CALL") -> bytes:
+    """AX.25 UI command frame without FCS (dest+src+ctl+pid+info), as KISS carries it."""
+    return ax25_address(dest, 0, True, False) + ax25_address(src, 0, False, True) + \
+        bytes([0x03, 0xF0]) + info
+
+
+def kiss_frame(content: bytes) -> bytes:
+    """KISS frame of the type byte and data in content, escaped and FEND-delimited"""
+    escaped = content.replace(b"\xdb", b"\xdb\xdd").replace(b"\xc0", b"\xdb\xdc")
+    return b"\xc0" + escaped + b"\xc0"
+
+
+def kiss_data_frame(frame: bytes) -> bytes:
+    """KISS data frame for port 0"""
+    return kiss_frame(b"\x00" + frame)
+
+
 def fx25_first_payload_byte(decoded_block: bytes) -> int:
     """FX.25 decoder emits one full RS data block per frame; payload is zero-padded to k."""
     if not decoded_block:
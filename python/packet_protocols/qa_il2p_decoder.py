@@ -15,6 +15,8 @@ from gnuradio import blocks, gr, gr_unittest
 
 from gnuradio.packet_protocols import il2p_decoder, il2p_encoder
 
+from qa_codec_utils import ax25_ui_frame, ax25_ui_payload, kiss_data_frame
+
 
 class qa_il2p_decoder(gr_unittest.TestCase):
     def setUp(self):
@@ -33,11 +35,26 @@ class qa_il2p_decoder(gr_unittest.TestCase):
         self.tb.run()
         self.assertIsNotNone(sink.data())
 
+    def test_spec_header_example(self):
+        # IL2P specification example 1: RR command KK4HEJ-7 > KA2DEW-2, N(R)=5, P set
+        ax25 = bytes.fromhex("968264888aaee4969668908a946fb1")
+        encoded = bytes.fromhex("26574d57f196cc8542e724f72e8a97")
+        octets = bytes([0x55, 0xF1, 0x5E, 0x48]) + encoded + bytes(4)
+        bits = [(b >> (7 - i)) & 1 for b in octets for i in range(8)]
+        dec = il2p_decoder(False)
+        src = blocks.vector_source_b(bits, False)
+        sink = blocks.vector_sink_b()
+        self.tb.connect(src, dec)
+        self.tb.connect(dec, sink)
+        self.tb.run()
+        raw = bytes([x & 0xFF for x in sink.data()])
+        self.assertEqual(raw[:-2], ax25)
+
     def test_roundtrip_encoder_decoder(self):
-        val = 0x3C
+        frame = ax25_ui_frame(bytes(range(200)) * 3)
         tb = gr.top_block()
         enc = il2p_encoder("N0CALL", "0", "N1CALL", "0", fec_type=1, add_checksum=True)
-        src = blocks.vector_source_b([val], False)
+        src = blocks.vector_source_b(list(kiss_data_frame(frame)), False)
         sink_enc = blocks.vector_sink_b()
         tb.connect(src, enc)
         tb.connect(enc, sink_enc)
@@ -51,9 +68,35 @@ class qa_il2p_decoder(gr_unittest.TestCase):
         tb2.connect(src2, dec)
         tb2.connect(dec, sink2)
         tb2.run()
+        # The AX.25 frame is rebuilt from the IL2P header, with its FCS
         raw = bytes([x & 0xFF for x in sink2.data()])
-        self.assertGreater(len(raw), 0)
-        self.assertEqual(raw[0], val)
+        self.assertEqual(len(raw), len(frame) + 2)
+        self.assertEqual(raw[:-2], frame)
+        self.assertEqual(ax25_ui_payload(raw), bytes(range(200)) * 3)
+
+    def test_crc_trailer_checked(self):
+        frame = ax25_ui_frame(b"IL2P+CRC")
+        enc = il2p_encoder("N0CALL", "0", "N1CALL", "0", fec_type=1, add_checksum=True)
+        src = blocks.vector_source_b(list(kiss_data_frame(frame)), False)
+        sink_enc = blocks.vector_sink_b()
+        self.tb.connect(src, enc)
+        self.tb.connect(enc, sink_enc)
+        self.tb.run()
+        bits = [int(x) & 1 for x in sink_enc.data()]
+        # Two bit errors in one trailer byte are beyond its Hamming code
+        bits[-31] ^= 1
+        bits[-30] ^= 1
+
+        for check_crc, expected in ((True, b""), (False, frame)):
+            tb = gr.top_block()
+            dec = il2p_decoder(check_crc)
+            src2 = blocks.vector_source_b(bits + [0] * 64, False)
+            sink2 = blocks.vector_sink_b()
+            tb.connect(src2, dec)
+            tb.connect(dec, sink2)
+            tb.run()
+            raw = bytes([x & 0xFF for x in sink2.data()])
+            self.assertEqual(raw[:-2], expected)
 
 
 if __name__ == "__main__":
@@ -17,26 +17,51 @@ from gnuradio import blocks, gr, gr_unittest
 
 from gnuradio.packet_protocols import il2p_encoder
 
+from qa_codec_utils import ax25_address, ax25_ui_frame, kiss_data_frame
+
 
 class qa_il2p_encoder(gr_unittest.TestCase):
-    """IL2P encoder emits HDLC flags with stuffed interior; first interior byte is IL2P preamble 0x55."""
+    """IL2P encoder emits an unstuffed bitstream: preamble 0x55, sync F1 5E 48, then header."""
 
-    def test_flag_wrapped_preamble_and_sync(self):
+    def _encode(self, kiss):
         tb = gr.top_block()
-        enc = il2p_encoder("N0CALL", "0", "N1CALL", "0", fec_type=1, add_checksum=True)
-        src = blocks.vector_source_b([0x77], False)
+        enc = il2p_encoder("N0CALL", "0", "N1CALL", "0", fec_type=1, add_checksum=False)
+        src = blocks.vector_source_b(list(kiss), False)
         sink = blocks.vector_sink_b()
         tb.connect(src, enc)
         tb.connect(enc, sink)
         tb.run()
         bits = np.array([int(x) & 1 for x in sink.data()], dtype=np.uint8)
-        self.assertGreater(len(bits), 0)
-        packed = np.packbits(bits).tobytes()
-        self.assertGreaterEqual(len(packed), 6)
-        self.assertEqual(packed[0], 0x7E)
-        self.assertEqual(packed[1], 0x55)
-        # Raw IL2P sync bytes (F1 5E 48) live in the unstuffed interior; bit stuffing
-        # breaks byte alignment vs ``numpy.packbits``, so do not assert them here.
+        return np.packbits(bits).tobytes()
+
+    def test_preamble_and_sync_without_flags(self):
+        packed = self._encode(kiss_data_frame(ax25_ui_frame(b"\x77")))
+        self.assertGreaterEqual(len(packed), 4)
+        self.assertEqual(packed[0], 0x55)
+        self.assertEqual(packed[1:4], bytes([0xF1, 0x5E, 0x48]))
+        self.assertNotEqual(packed[0], 0x7E)
+
+    def test_frame_length(self):
+        # The AX.25 header travels in the IL2P header: preamble + sync + 13-byte header +
+        # 2 header parity + 1 information byte + 16 parity (max FEC)
+        packed = self._encode(kiss_data_frame(ax25_ui_frame(b"\x77")))
+        self.assertEqual(len(packed), 1 + 3 + 13 + 2 + 1 + 16)
+
+    def test_one_frame_per_ax25_frame(self):
+        frames = kiss_data_frame(ax25_ui_frame(b"first")) + \
+            kiss_data_frame(ax25_ui_frame(b"second"))
+        packed = self._encode(frames)
+        self.assertEqual(len(packed), 2 * (1 + 3 + 13 + 2 + 16) + len(b"first") + len(b"second"))
+
+    def test_digipeated_frame_sent_whole(self):
+        # A digipeater path does not fit the type 1 header: the frame is the payload
+        frame = ax25_address("APRS", 0, True, False) + ax25_address("N0CALL", 1, False, False) + \
+            ax25_address("WIDE1", 1, False, True) + bytes([0x03, 0xF0]) + b"x"
+        packed = self._encode(kiss_data_frame(frame))
+        self.assertEqual(len(packed), 1 + 3 + 13 + 2 + len(frame) + 16)
+
+    def test_non_ax25_input_ignored(self):
+        self.assertEqual(self._encode(bytes([0x77]) + kiss_data_frame(b"short")), b"")
 
 
 if __name__ == "__main__":
@@ -6,34 +6,117 @@
 # SPDX-License-Identifier: GPL-3.0-or-later
 #
 
+import time
+
 from qa_gr_test_env import ensure_build_packet_protocols_first
 
 ensure_build_packet_protocols_first()
 
 from gnuradio import gr, gr_unittest
-from gnuradio.packet_protocols import kiss_tnc
+from gnuradio import blocks
+import pmt
+
+from qa_codec_utils import kiss_frame
+
+try:
+    from gnuradio.packet_protocols import kiss_tnc
+    _has_bindings = True
+except ImportError:
+    _has_bindings = False
+    kiss_tnc = None
+
+
+def pdu(payload, **meta):
+    d = pmt.make_dict()
+    for key, value in meta.items():
+        d = pmt.dict_add(d, pmt.intern(key), value)
+    return pmt.cons(d, pmt.init_u8vector(len(payload), list(payload)))
+
 
 class qa_kiss_tnc(gr_unittest.TestCase):
+    """The TNC runs on a pseudo-terminal ("pty"), so no serial device is needed"""
 
     def setUp(self):
+        if not _has_bindings:
+            self.skipTest("kiss_tnc bindings not available")
         self.tb = gr.top_block()
 
     def tearDown(self):
         self.tb = None
 
+    def run_tnc(self, tnc, host_bytes, ports, expected, posts=()):
+        """Feed host bytes to the TNC, post messages, and collect messages and output"""
+        source = blocks.vector_source_b(list(host_bytes), False)
+        sink = blocks.vector_sink_b()
+        self.tb.connect(source, tnc, sink)
+        debug = {}
+        for port in ports:
+            debug[port] = blocks.message_debug()
+            self.tb.msg_connect((tnc, port), (debug[port], "store"))
+        self.tb.start()
+        for port, msg in posts:
+            tnc._post(pmt.intern(port), msg)
+        deadline = time.monotonic() + 5
+        while (sum(d.num_messages() for d in debug.values()) < expected and
+               time.monotonic() < deadline):
+            time.sleep(0.01)
+        time.sleep(0.1)
+        self.tb.stop()
+        self.tb.wait()
+        messages = {port: [d.get_message(i) for i in range(d.num_messages())]
+                    for port, d in debug.items()}
+        return messages, bytes(sink.data())
+
     def test_instance(self):
-        # Test will fail until you pass sensible arguments to the constructor
-        # Use /dev/null for testing since we don't have a real serial port
-        try:
-            instance = kiss_tnc('/dev/null', 9600, False)
-        except RuntimeError:
-            # Expected if /dev/null can't be opened as serial port
-            pass
-
-    def test_001_descriptive_test_name(self):
-        # set up fg
-        self.tb.run()
-        # check data
+        """A virtual TNC opens its pseudo-terminal"""
+        tnc = kiss_tnc("pty", 9600, False)
+        self.assertTrue(tnc.pty_path().startswith("/dev/"))
+        self.assertEqual(tnc.num_ports(), 1)
+        tnc.set_num_ports(16)
+        self.assertEqual(tnc.num_ports(), 16)
+        with self.assertRaises(ValueError):
+            tnc.set_num_ports(17)
+
+    def test_port_routing(self):
+        """Data and parameters go to the port in the type byte's high nibble"""
+        tnc = kiss_tnc("pty", 9600, False)
+        tnc.set_num_ports(3)
+        host = (kiss_frame(b"\x20hello") + kiss_frame(b"\x21\x1e") +
+                kiss_frame(b"\x12\x80") + kiss_frame(b"\x30dropped"))
+        messages, _ = self.run_tnc(tnc, host, ["port1", "port2"], 3)
+
+        port2 = messages["port2"]
+        self.assertEqual(len(port2), 2)
+        meta, data = pmt.car(port2[0]), pmt.cdr(port2[0])
+        self.assertEqual(pmt.to_long(pmt.dict_ref(meta, pmt.intern("port"), pmt.PMT_NIL)), 2)
+        self.assertEqual(bytes(pmt.u8vector_elements(data)), b"hello")
+        update = port2[1]
+        self.assertEqual(pmt.to_long(pmt.dict_ref(update, pmt.intern("port"), pmt.PMT_NIL)), 2)
+        self.assertEqual(
+            pmt.to_long(pmt.dict_ref(update, pmt.intern("tx_delay"), pmt.PMT_NIL)), 30)
+
+        port1 = messages["port1"]
+        self.assertEqual(len(port1), 1)
+        self.assertEqual(
+            pmt.to_long(pmt.dict_ref(port1[0], pmt.intern("persistence"), pmt.PMT_NIL)), 128)
+
+    def test_port_in(self):
+        """PDUs on port_in are KISS-framed for the host with their port nibble"""
+        tnc = kiss_tnc("pty", 9600, False)
+        tnc.set_num_ports(2)
+        posts = [("port_in", pdu(b"A\xc0", port=pmt.from_long(1))),
+                 ("port_in", pdu(b"unrouted", port=pmt.from_long(5)))]
+        _, out = self.run_tnc(tnc, b"", [], 0, posts)
+        self.assertEqual(out, kiss_frame(b"\x10A\xc0"))
+
+    def test_negotiation(self):
+        """0x10-0x14 are negotiation frames while port 1 is not routed"""
+        tnc = kiss_tnc("pty", 9600, False)
+        host = kiss_frame(b"\x10abc") + kiss_frame(b"\x14q") + kiss_frame(b"\x15x")
+        messages, _ = self.run_tnc(tnc, host, ["negotiation_out"], 2)
+        out = messages["negotiation_out"]
+        self.assertEqual([pmt.to_long(pmt.car(m)) for m in out], [0x10, 0x14])
+        self.assertEqual(bytes(pmt.u8vector_elements(pmt.cdr(out[0]))), b"abc")
 
 
 if __name__ == '__main__':
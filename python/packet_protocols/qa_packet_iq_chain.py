@@ -33,7 +33,12 @@ from gnuradio.packet_protocols import (
     il2p_encoder,
 )
 
-from qa_codec_utils import ax25_ui_payload, fx25_first_payload_byte
+from qa_codec_utils import (
+    ax25_ui_frame,
+    ax25_ui_payload,
+    fx25_first_payload_byte,
+    kiss_data_frame,
+)
 
 PRE_BURST_BITS = 48000
 POST_BURST_BITS = 32000
@@ -70,7 +75,7 @@ class qa_packet_iq_chain(gr_unittest.TestCase):
         elif mode == "il2p":
             encoder = il2p_encoder("N0CALL", "0", "N1CALL", "0", fec_type=1, add_checksum=True)
             decoder = il2p_decoder()
-            frame_bits = _encoder_bits_vector(encoder, payload)
+            frame_bits = _encoder_bits_vector(encoder, kiss_data_frame(ax25_ui_frame(payload)))
         else:
             raise ValueError(mode)
 
@@ -130,7 +135,7 @@ class qa_packet_iq_chain(gr_unittest.TestCase):
             self.skipTest(
                 "GFSK modem did not deliver an IL2P frame (timing-sensitive; see qa_packet_iq_chain docs)"
             )
-        self.assertEqual(out[0], 0x61)
+        self.assertEqual(ax25_ui_payload(out), bytes([0x61]))
 
 
 if __name__ == "__main__":